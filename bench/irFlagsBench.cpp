@@ -0,0 +1,184 @@
+/* Test every word of real .ll text for each IRFlags category, against the per-category sets
+ * it replaced
+ *
+ * The parsers ask for one category at a time, e.g. is_linkage_flag(), so each category is
+ * timed on its own: one set lookup for the old schemes, and the classify() mask test that the
+ * is_*() helpers are for IRFlags.
+ *
+ * usage: irflags-bench [-r repeats] file.ll...
+ */
+
+#include <fstream>
+#include <set>
+#include <unordered_set>
+#include <asmParser/instFlags.h>
+#include <peripheral/timer.h>
+#include <utilities/symbol.h>
+
+namespace {
+
+/* Categories in the order of IRFlags::Category */
+const char* category_names[11] = {
+    "fastmath", "linkage", "cconv", "visibility", "dll_storage_class", "param_attr",
+    "tail", "terminator_inst", "binary_opcode", "bitwise_binary_opcode", "const_expr_opcode"
+};
+
+const std::vector<std::vector<const char*>>& category_words() {
+    static std::vector<std::vector<const char*>> words(11);
+    if (words[0].empty()) {
+#define IR_KEYWORD_ADD(name, category) words[__builtin_ctz(IRFlags::category)].push_back(name);
+        IR_KEYWORDS_DO(IR_KEYWORD_ADD)
+#undef IR_KEYWORD_ADD
+    }
+    return words;
+}
+
+/* One std::set<string> per category, as IRFlags used to be */
+struct StringSets {
+    std::vector<std::set<string>> sets;
+
+    StringSets() {
+        for (auto& words: category_words()) {
+            sets.push_back(std::set<string>(words.begin(), words.end()));
+        }
+    }
+
+    bool is_in(size_t c, const string& w) const {
+        return sets[c].find(w) != sets[c].end();
+    }
+
+    unsigned classify(const string& w) const {
+        unsigned mask = 0;
+        for (size_t c = 0; c < sets.size(); ++c) {
+            if (is_in(c, w)) {
+                mask |= 1u << c;
+            }
+        }
+        return mask;
+    }
+};
+
+/* One unordered_set<Symbol> per category, looked up through Symbol::find() */
+struct SymbolSets {
+    std::vector<std::unordered_set<Symbol>> sets;
+
+    SymbolSets() {
+        for (auto& words: category_words()) {
+            std::unordered_set<Symbol> s;
+            for (auto w: words) {
+                s.insert(Symbol(w));
+            }
+            sets.push_back(s);
+        }
+    }
+
+    bool is_in(size_t c, const string& w) const {
+        Symbol s = Symbol::find(w);
+        return !s.empty() && sets[c].find(s) != sets[c].end();
+    }
+
+    unsigned classify(const string& w) const {
+        unsigned mask = 0;
+        for (size_t c = 0; c < sets.size(); ++c) {
+            if (is_in(c, w)) {
+                mask |= 1u << c;
+            }
+        }
+        return mask;
+    }
+};
+
+/* Split a line the way the parsers do, at whitespace and punctuation */
+void split_words(const string& line, std::vector<string>& words) {
+    const char* delims = " \t,()[]{}<>*=";
+    size_t i = 0;
+    while (i < line.size()) {
+        size_t j = line.find_first_of(delims, i);
+        if (j == string::npos) {
+            j = line.size();
+        }
+        if (j > i) {
+            words.push_back(line.substr(i, j-i));
+        }
+        i = j + 1;
+    }
+}
+
+template <typename F>
+double time_ns_per_word(const std::vector<string>& words, int repeats, F classify, unsigned long long& checksum) {
+    Timer t;
+    t.start();
+    for (int r = 0; r < repeats; ++r) {
+        for (auto& w: words) {
+            checksum += classify(w);
+        }
+    }
+    t.stop();
+    return t.seconds() * 1e9 / ((double)words.size() * repeats);
+}
+
+}
+
+int main(int argc, char** argv) {
+    int repeats = 5;
+    std::vector<string> words;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-r" && i + 1 < argc) {
+            repeats = atoi(argv[++i]);
+            continue;
+        }
+        std::ifstream ifs(arg);
+        if (!ifs.good()) {
+            fprintf(stderr, "cannot open %s\n", arg.c_str());
+            return 1;
+        }
+        string line;
+        while (std::getline(ifs, line)) {
+            split_words(line, words);
+        }
+    }
+    if (words.empty()) {
+        fprintf(stderr, "usage: %s [-r repeats] file.ll...\n", argv[0]);
+        return 1;
+    }
+
+    IRFlags::init();
+    StringSets string_sets;
+    SymbolSets symbol_sets;
+
+    size_t keywords = 0;
+    for (auto& w: words) {
+        unsigned mask = IRFlags::classify(w);
+        if (mask != string_sets.classify(w) || mask != symbol_sets.classify(w)) {
+            fprintf(stderr, "mismatch on '%s'\n", w.c_str());
+            return 1;
+        }
+        keywords += mask != 0;
+    }
+
+    unsigned long long checksum = 0;
+    double string_total = 0;
+    double symbol_total = 0;
+    double classify_total = 0;
+    printf("%-22s %16s %16s %16s  (ns/word)\n", "category", "std::set<string>", "Symbol set", "IRFlags");
+    for (size_t c = 0; c < category_words().size(); ++c) {
+        unsigned bit = 1u << c;
+        double string_ns = time_ns_per_word(words, repeats,
+            [&](const string& w) { return string_sets.is_in(c, w); }, checksum);
+        double symbol_ns = time_ns_per_word(words, repeats,
+            [&](const string& w) { return symbol_sets.is_in(c, w); }, checksum);
+        double classify_ns = time_ns_per_word(words, repeats,
+            [=](const string& w) { return (IRFlags::classify(w) & bit) != 0; }, checksum);
+        printf("%-22s %16.2f %16.2f %16.2f\n", category_names[c], string_ns, symbol_ns, classify_ns);
+        string_total += string_ns;
+        symbol_total += symbol_ns;
+        classify_total += classify_ns;
+    }
+
+    size_t n = category_words().size();
+    printf("%-22s %16.2f %16.2f %16.2f  (%.1fx, %.1fx)\n", "mean", string_total / n, symbol_total / n,
+           classify_total / n, string_total / classify_total, symbol_total / classify_total);
+    printf("words: %zu, keywords: %zu, repeats: %d, checksum: %llu\n", words.size(), keywords, repeats, checksum);
+    return 0;
+}
@@ -0,0 +1,243 @@
+#include <cstdarg>
+#include <vector>
+#include "llGenerator.h"
+
+/* The fixed metadata at the top of the metadata section, see write() */
+enum {
+    MDCompileUnit = 0,
+    MDFile,
+    MDEmpty,
+    MDDwarfVersion,
+    MDDebugInfoVersion,
+    MDIdent,
+    MDSubroutineType,
+    MDTypes,
+    MDInt,
+    MDFirstFree
+};
+
+#define FUNCTION_TYPE "i32 (i32, i32*)"
+
+LLGenerator::Options::Options() {
+    functions = 2000;
+    blocks = 8;
+    insts = 10;
+    call_density = 0.2;
+    indirect_calls = 0.1;
+    debug_locations = 1.0;
+    seed = 1;
+}
+
+std::string LLGenerator::Options::to_string() const {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "functions=%d,blocks=%d,insts=%d,calls=%g,indirect=%g,debug=%g,seed=%llu",
+             functions, blocks, insts, call_density, indirect_calls, debug_locations,
+             (unsigned long long)seed);
+    return buf;
+}
+
+LLGenerator::LLGenerator(const Options& options): _options(options) {
+    _stats = Stats{0, 0};
+    _rng = options.seed * 0x9E3779B97F4A7C15ull + 1;
+    _next_metadata = MDFirstFree;
+    _out = NULL;
+    _metadata = NULL;
+}
+
+/* xorshift64*, so that the output only depends on the seed */
+uint64_t LLGenerator::next() {
+    _rng ^= _rng >> 12;
+    _rng ^= _rng << 25;
+    _rng ^= _rng >> 27;
+    return _rng * 0x2545F4914F6CDD1Dull;
+}
+
+bool LLGenerator::chance(double p) {
+    return (next() >> 11) * (1.0 / 9007199254740992.0) < p;
+}
+
+int LLGenerator::below(int n) {
+    return (int)(next() % (uint64_t)n);
+}
+
+/* Every line goes through here, so that bytes and lines are counted */
+void LLGenerator::emit(FILE* fp, const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vfprintf(fp, fmt, ap);
+    va_end(ap);
+    _stats.bytes += n;
+    _stats.lines++;
+}
+
+/**@brief A new DILocation in @param subprogram, as ", !dbg !N", or "" if the instruction
+ * has none
+ */
+std::string LLGenerator::debug_location(int subprogram, int line) {
+    if (subprogram < 0 || !chance(_options.debug_locations)) {
+        return "";
+    }
+    int id = _next_metadata++;
+    emit(_metadata, "!%d = !DILocation(line: %d, column: %d, scope: !%d)\n",
+         id, line, 3 + below(40), subprogram);
+    char buf[32];
+    snprintf(buf, sizeof(buf), ", !dbg !%d", id);
+    return buf;
+}
+
+void LLGenerator::write_function(int id) {
+    int sp = -1;
+    int line = 10 + id * 100;
+    if (_options.debug_locations > 0) {
+        sp = _next_metadata++;
+        emit(_metadata, "!%d = distinct !DISubprogram(name: \"f%d\", scope: !%d, file: !%d, line: %d, "
+                        "type: !%d, isLocal: false, isDefinition: true, scopeLine: %d, isOptimized: false, "
+                        "unit: !%d, variables: !%d)\n",
+             sp, id, MDFile, MDFile, line, MDSubroutineType, line, MDCompileUnit, MDEmpty);
+        emit(_out, "define i32 @f%d(i32 %%a, i32* %%p) #0 !dbg !%d {\n", id, sp);
+    }
+    else {
+        emit(_out, "define i32 @f%d(i32 %%a, i32* %%p) #0 {\n", id);
+    }
+
+    emit(_out, "entry:\n");
+    emit(_out, "  %%slot = alloca i32, align 4\n");
+    emit(_out, "  store i32 %%a, i32* %%slot, align 4%s\n", debug_location(sp, ++line).c_str());
+    emit(_out, "  br label %%bb0\n");
+
+    int t = 0;                  // the last %t defined
+    std::vector<int> ints;      // the i32 values of the block
+    for (int b = 0; b < _options.blocks; ++b) {
+        emit(_out, "\n");
+        emit(_out, "bb%d:\n", b);
+        int first = ++t;
+        ints.assign(1, first);
+        emit(_out, "  %%t%d = load i32, i32* %%slot, align 4%s\n", t, debug_location(sp, ++line).c_str());
+        for (int i = 1; i < _options.insts; ++i) {
+            int x = ints[below((int)ints.size())];
+            std::string dbg = debug_location(sp, ++line);
+            bool defines = true;
+            if (chance(_options.call_density)) {
+                if (chance(_options.indirect_calls)) {
+                    int fp = ++t;
+                    emit(_out, "  %%t%d = load " FUNCTION_TYPE "*, " FUNCTION_TYPE "** @fptr%d, align 8\n",
+                         fp, below(8));
+                    ++t;
+                    emit(_out, "  %%t%d = call i32 %%t%d(i32 %%t%d, i32* %%p)%s\n", t, fp, x, dbg.c_str());
+                }
+                else {
+                    ++t;
+                    emit(_out, "  %%t%d = call i32 @f%d(i32 %%t%d, i32* %%p)%s\n",
+                         t, below(_options.functions), x, dbg.c_str());
+                }
+            }
+            else {
+                switch (below(5)) {
+                    case 0:
+                        ++t;
+                        emit(_out, "  %%t%d = add nsw i32 %%t%d, %d%s\n", t, x, below(1000), dbg.c_str());
+                        break;
+                    case 1:
+                        ++t;
+                        emit(_out, "  %%t%d = mul nsw i32 %%t%d, %%t%d%s\n", t, x, first, dbg.c_str());
+                        break;
+                    case 2:
+                        ++t;
+                        emit(_out, "  %%t%d = getelementptr inbounds i32, i32* %%p, i64 %d%s\n",
+                             t, below(64), dbg.c_str());
+                        ++t;
+                        emit(_out, "  %%t%d = load i32, i32* %%t%d, align 4\n", t, t - 1);
+                        break;
+                    case 3:
+                        emit(_out, "  store i32 %%t%d, i32* %%slot, align 4%s\n", x, dbg.c_str());
+                        defines = false;
+                        break;
+                    default:
+                        ++t;
+                        emit(_out, "  %%t%d = sub i32 %%t%d, %%a%s\n", t, x, dbg.c_str());
+                        break;
+                }
+            }
+            if (defines) {
+                ints.push_back(t);
+            }
+        }
+
+        int cond = ++t;
+        emit(_out, "  %%t%d = icmp slt i32 %%t%d, %d\n", cond, ints.back(), below(1000));
+        if (b + 1 < _options.blocks) {
+            emit(_out, "  br i1 %%t%d, label %%bb%d, label %%exit%s\n", cond, b + 1,
+                 debug_location(sp, ++line).c_str());
+        }
+        else {
+            emit(_out, "  br label %%exit%s\n", debug_location(sp, ++line).c_str());
+        }
+    }
+
+    emit(_out, "\n");
+    emit(_out, "exit:\n");
+    emit(_out, "  %%r = load i32, i32* %%slot, align 4\n");
+    emit(_out, "  ret i32 %%r%s\n", debug_location(sp, ++line).c_str());
+    emit(_out, "}\n");
+    emit(_out, "\n");
+}
+
+/**@brief Write the module to @param file, false if it can't be written */
+bool LLGenerator::write(const std::string& file) {
+    _out = fopen(file.c_str(), "w");
+    if (!_out) {
+        return false;
+    }
+    /* metadata is numbered while the functions are written, and goes after them */
+    _metadata = tmpfile();
+    if (!_metadata) {
+        fclose(_out);
+        return false;
+    }
+
+    emit(_out, "; ModuleID = 'synthetic.c'\n");
+    emit(_out, "source_filename = \"synthetic.c\"\n");
+    emit(_out, "target datalayout = \"e-m:e-i64:64-f80:128-n8:16:32:64-S128\"\n");
+    emit(_out, "target triple = \"x86_64-unknown-linux-gnu\"\n");
+    emit(_out, "\n");
+    for (int i = 0; i < 8; ++i) {
+        emit(_out, "@fptr%d = global " FUNCTION_TYPE "* @f%d, align 8\n", i, i % _options.functions);
+    }
+    emit(_out, "\n");
+
+    for (int f = 0; f < _options.functions; ++f) {
+        write_function(f);
+    }
+
+    emit(_out, "attributes #0 = { noinline nounwind uwtable \"no-frame-pointer-elim\"=\"true\" }\n");
+    emit(_out, "\n");
+    if (_options.debug_locations > 0) {
+        emit(_out, "!llvm.dbg.cu = !{!%d}\n", MDCompileUnit);
+        emit(_out, "!llvm.ident = !{!%d}\n", MDIdent);
+        emit(_out, "!llvm.module.flags = !{!%d, !%d}\n", MDDwarfVersion, MDDebugInfoVersion);
+        emit(_out, "\n");
+        emit(_out, "!%d = distinct !DICompileUnit(language: DW_LANG_C99, file: !%d, producer: \"sopt-bench\", "
+                   "isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, enums: !%d)\n",
+             MDCompileUnit, MDFile, MDEmpty);
+        emit(_out, "!%d = !DIFile(filename: \"synthetic.c\", directory: \"/tmp\")\n", MDFile);
+        emit(_out, "!%d = !{}\n", MDEmpty);
+        emit(_out, "!%d = !{i32 2, !\"Dwarf Version\", i32 4}\n", MDDwarfVersion);
+        emit(_out, "!%d = !{i32 2, !\"Debug Info Version\", i32 3}\n", MDDebugInfoVersion);
+        emit(_out, "!%d = !{!\"sopt-bench\"}\n", MDIdent);
+        emit(_out, "!%d = !DISubroutineType(types: !%d)\n", MDSubroutineType, MDTypes);
+        emit(_out, "!%d = !{!%d}\n", MDTypes, MDInt);
+        emit(_out, "!%d = !DIBasicType(name: \"int\", size: 32, encoding: DW_ATE_signed)\n", MDInt);
+
+        rewind(_metadata);
+        char buf[1 << 16];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), _metadata)) > 0) {
+            fwrite(buf, 1, n, _out);
+        }
+    }
+    fclose(_metadata);
+    _metadata = NULL;
+
+    bool ok = !ferror(_out);
+    return fclose(_out) == 0 && ok;
+}
@@ -0,0 +1,57 @@
+#ifndef LLPARSER_LLGENERATOR_H
+#define LLPARSER_LLGENERATOR_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**@brief Writes a synthetic .ll module, the same bytes for the same options
+ *
+ * Every function has the signature i32 (i32, i32*). Its blocks are filled with loads,
+ * stores, arithmetic, compares, GEPs and calls, and each block branches to the next
+ * one or to the exit. Indirect calls go through function pointers loaded from globals.
+ * With debug info, each function gets a DISubprogram and the chosen instructions a
+ * DILocation of their own.
+ */
+class LLGenerator {
+public:
+    struct Options {
+        int functions;              // defined functions
+        int blocks;                 // blocks per function, besides entry and exit
+        int insts;                  // instructions per block, besides its terminator
+        double call_density;        // fraction of the instructions that are calls
+        double indirect_calls;      // fraction of the calls that are indirect
+        double debug_locations;     // fraction of the instructions with a !dbg location
+        uint64_t seed;
+
+        Options();
+        std::string to_string() const;
+    };
+
+    struct Stats {
+        uint64_t bytes;
+        uint64_t lines;
+    };
+private:
+    Options _options;
+    Stats _stats;
+    uint64_t _rng;
+    int _next_metadata;
+    FILE* _out;
+    FILE* _metadata;
+
+    uint64_t next();
+    bool chance(double p);
+    int below(int n);
+
+    void emit(FILE* fp, const char* fmt, ...);
+    std::string debug_location(int subprogram, int line);
+    void write_function(int id);
+public:
+    explicit LLGenerator(const Options& options);
+
+    bool write(const std::string& file);
+    const Stats& stats()                                     { return _stats; }
+};
+
+#endif //LLPARSER_LLGENERATOR_H
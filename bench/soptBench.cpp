@@ -0,0 +1,277 @@
+/* Time the parser on a synthetic (or given) module under the standard scenarios
+ *
+ * usage: sopt-bench [-functions n] [-blocks n] [-insts n] [-calls p] [-indirect p] [-debug p]
+ *                   [-seed n] [-runs n] [-scenarios parse,resolve,instcount,print]
+ *                   [-input file.ll] [-keep file.ll] [-passes dir] [-lazy]
+ *
+ * Each run is a forked child, so its peak RSS is its own. Each scenario is one JSON object
+ * on a line of stdout, with the best time of its runs and the largest peak RSS.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <fstream>
+#include <iostream>
+#include <asmParser/llParser.h>
+#include <asmParser/sysDict.h>
+#include <ir/module.h>
+#include <passes/passManager.h>
+#include <peripheral/sysArgs.h>
+#include <peripheral/timer.h>
+#include <utilities/flags.h>
+#include <utilities/internalError.h>
+#include <utilities/strings.h>
+#include "llGenerator.h"
+
+namespace {
+
+struct Scenario {
+    const char* name;
+    const char* pass;           // loaded from the pass directory, or NULL
+    bool resolve;
+    bool print;
+};
+
+const Scenario scenarios[] = {
+    {"parse",     NULL,          false, false},
+    {"resolve",   NULL,          true,  false},
+    {"instcount", "Instcount",   true,  false},
+    {"print",     NULL,          true,  true},
+};
+
+struct Config {
+    string input;
+    string description;         // of the input in the report
+    string pass_dir;
+    int runs;
+    bool lazy;
+};
+
+/* The passes are built next to the bin directory, see CMakeLists.txt */
+string default_pass_dir() {
+    char buf[4096];
+    ssize_t n = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+    if (n <= 0) {
+        return "../passes/";
+    }
+    string exe(buf, n);
+    return exe.substr(0, exe.rfind('/') + 1) + "../passes/";
+}
+
+/* Parse the input in this process as sopt would, and return the seconds it took */
+double run_scenario(const Scenario& s, const Config& c) {
+    std::vector<string> args = {"sopt-bench"};
+    args.push_back(c.lazy ? "-XX:+LazyParsing" : "-XX:-LazyParsing");
+    if (!s.resolve) {
+        args.push_back("-XX:-ResolveAfterParse");
+    }
+    if (s.pass) {
+        args.push_back("-load");
+        args.push_back(c.pass_dir + "lib" + s.pass + ".so");
+    }
+    args.push_back(c.input);
+    std::vector<char*> argv;
+    for (auto& a: args) {
+        argv.push_back(&a[0]);
+    }
+    argv.push_back(NULL);
+
+    /* what the passes print is not part of the report */
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, 1);
+
+    Timer t;
+    t.start();
+    Flags::init();
+    SysDict::init();
+    Errors::init();
+    SoptInitArgs init_args;
+    init_args.argc = (int)args.size();
+    init_args.argv = argv.data();
+    SysArgs::init(&init_args);
+    PassManager::init();
+
+    Module* m = SysDict::parser->parse(c.input);
+    if (!m) {
+        _exit(2);
+    }
+    if (s.print) {
+        string out = c.input + ".bench.ll";
+        m->print_to_file(out.c_str());
+        unlink(out.c_str());
+    }
+    t.stop();
+    return t.seconds();
+}
+
+struct Result {
+    double seconds;
+    long peak_rss_kb;
+};
+
+/* Run the scenario in a child, false if the child failed */
+bool measure(const Scenario& s, const Config& c, Result& r) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        double seconds = run_scenario(s, c);
+        ssize_t n = write(fds[1], &seconds, sizeof(seconds));
+        /* the teardown isn't measured, skip it */
+        _exit(n == sizeof(seconds) ? 0 : 3);
+    }
+
+    close(fds[1]);
+    double seconds = -1;
+    ssize_t n = read(fds[0], &seconds, sizeof(seconds));
+    close(fds[0]);
+
+    int status;
+    rusage usage;
+    wait4(pid, &status, 0, &usage);
+    if (n != sizeof(seconds) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return false;
+    }
+    r.seconds = seconds;
+    r.peak_rss_kb = usage.ru_maxrss;
+    return true;
+}
+
+bool count_input(const string& file, uint64_t& bytes, uint64_t& lines) {
+    std::ifstream ifs(file, std::ios::binary);
+    if (!ifs.good()) {
+        return false;
+    }
+    bytes = 0;
+    lines = 0;
+    char buf[1 << 16];
+    while (ifs.read(buf, sizeof(buf)) || ifs.gcount() > 0) {
+        std::streamsize n = ifs.gcount();
+        bytes += n;
+        for (std::streamsize i = 0; i < n; ++i) {
+            lines += buf[i] == '\n';
+        }
+    }
+    return true;
+}
+
+void usage(const char* exe) {
+    fprintf(stderr, "usage: %s [-functions n] [-blocks n] [-insts n] [-calls p] [-indirect p] [-debug p]\n"
+                    "       [-seed n] [-runs n] [-scenarios parse,resolve,instcount,print]\n"
+                    "       [-input file.ll] [-keep file.ll] [-passes dir] [-lazy]\n", exe);
+}
+
+}
+
+int main(int argc, char** argv) {
+    LLGenerator::Options options;
+    Config config;
+    config.runs = 3;
+    config.lazy = false;
+    config.pass_dir = default_pass_dir();
+    string keep;
+    std::vector<string> wanted = {"parse", "resolve", "instcount", "print"};
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc && arg != "-lazy") {
+            usage(argv[0]);
+            return 1;
+        }
+        if (arg == "-functions")        options.functions = atoi(argv[++i]);
+        else if (arg == "-blocks")      options.blocks = atoi(argv[++i]);
+        else if (arg == "-insts")       options.insts = atoi(argv[++i]);
+        else if (arg == "-calls")       options.call_density = atof(argv[++i]);
+        else if (arg == "-indirect")    options.indirect_calls = atof(argv[++i]);
+        else if (arg == "-debug")       options.debug_locations = atof(argv[++i]);
+        else if (arg == "-seed")        options.seed = strtoull(argv[++i], NULL, 10);
+        else if (arg == "-runs")        config.runs = atoi(argv[++i]);
+        else if (arg == "-scenarios")   wanted = Strings::split(argv[++i], ',');
+        else if (arg == "-input")       config.input = argv[++i];
+        else if (arg == "-keep")        keep = argv[++i];
+        else if (arg == "-passes")      config.pass_dir = string(argv[++i]) + "/";
+        else if (arg == "-lazy")        config.lazy = true;
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.functions < 1 || options.blocks < 1 || options.insts < 1 || config.runs < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    uint64_t bytes = 0;
+    uint64_t lines = 0;
+    bool generated = config.input.empty();
+    if (generated) {
+        config.input = keep.empty() ? "/tmp/sopt-bench-" + std::to_string(getpid()) + ".ll" : keep;
+        config.description = "synthetic:" + options.to_string();
+        LLGenerator generator(options);
+        if (!generator.write(config.input)) {
+            fprintf(stderr, "cannot write %s\n", config.input.c_str());
+            return 1;
+        }
+        bytes = generator.stats().bytes;
+        lines = generator.stats().lines;
+    }
+    else {
+        config.description = config.input;
+        if (!count_input(config.input, bytes, lines)) {
+            fprintf(stderr, "cannot open %s\n", config.input.c_str());
+            return 1;
+        }
+    }
+
+    int failed = 0;
+    for (auto& name: wanted) {
+        const Scenario* s = NULL;
+        for (auto& candidate: scenarios) {
+            if (name == candidate.name) {
+                s = &candidate;
+            }
+        }
+        if (!s) {
+            fprintf(stderr, "unknown scenario %s\n", name.c_str());
+            failed++;
+            continue;
+        }
+
+        Result best = {0, 0};
+        bool ok = true;
+        for (int r = 0; r < config.runs && ok; ++r) {
+            Result run;
+            ok = measure(*s, config, run);
+            if (ok) {
+                best.seconds = r == 0 ? run.seconds : std::min(best.seconds, run.seconds);
+                best.peak_rss_kb = std::max(best.peak_rss_kb, run.peak_rss_kb);
+            }
+        }
+        if (!ok) {
+            fprintf(stderr, "scenario %s failed\n", s->name);
+            failed++;
+            continue;
+        }
+
+        printf("{\"scenario\": \"%s\", \"input\": %s, \"lazy\": %s, \"bytes\": %llu, \"lines\": %llu, "
+               "\"runs\": %d, \"seconds\": %.6f, \"mb_per_s\": %.3f, \"lines_per_s\": %.0f, \"peak_rss_kb\": %ld}\n",
+               s->name, Strings::json_quote(config.description).c_str(), config.lazy ? "true" : "false",
+               (unsigned long long)bytes, (unsigned long long)lines, config.runs, best.seconds,
+               bytes / 1e6 / best.seconds, lines / best.seconds, best.peak_rss_kb);
+        fflush(stdout);
+    }
+
+    if (generated && keep.empty()) {
+        unlink(config.input.c_str());
+    }
+    return failed ? 1 : 0;
+}
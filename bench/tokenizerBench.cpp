@@ -0,0 +1,453 @@
+/* Replay instruction lines through each tokenizing primitive of StringParser and IRParser
+ *
+ * usage: tokenizer-bench [-r repeats] [file.ll...]
+ *
+ * The instruction lines of the files, joined the way LLParser joins switch and invoke, are
+ * split into corpora by what they contain. Without files, a built-in corpus of typical lines
+ * is used. For each corpus and primitive, it reports the time and the allocations per line
+ * that has something for the primitive to parse.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <asmParser/instFlags.h>
+#include <asmParser/irParser.h>
+#include <peripheral/timer.h>
+#include <utilities/charScan.h>
+#include <utilities/profiler.h>
+#include <utilities/strings.h>
+
+namespace {
+
+const char* builtin_lines[] = {
+    "  %15 = call i64 (i8*, i8*, ...) bitcast (i64 (...)* @f90_auto_alloc04 to i64 (i8*, i8*, ...)*)"
+        "(i8* nonnull %14, i8* bitcast (i32* @.C323_shell_ to i8*)), !dbg !29",
+    "  tail call void bitcast (void (%struct.bContext*, %struct.uiBlock.22475* (%struct.bContext*, "
+        "%struct.ARegion*, i8*)*, i8*)* @uiPupBlock to void (%struct.bContext*, i8*, i8*)*)"
+        "(%struct.bContext* %C, i8* bitcast (%struct.uiBlock* (%struct.bContext*, %struct.ARegion*, i8*)* "
+        "@wm_block_create to i8*), i8* %op) #7, !dbg !4125",
+    "  call void bitcast (void (i8*, i64)* @f90_dealloc03 to void (i8*, i8*, ...)*)(i8* null, i8* %23), !dbg !88",
+    "  %call.i4.i93 = invoke i8* @ben_malloc(i32 2, i64 20) #12\n"
+        "          to label %invoke.cont unwind label %lpad, !dbg !557",
+    "  %call5 = invoke dereferenceable(272) %\"class.std::basic_ostream\"* "
+        "@_ZStlsISt11char_traitsIcEERSt13basic_ostreamIcT_ES5_PKc(%\"class.std::basic_ostream\"* "
+        "dereferenceable(272) @_ZSt4cout, i8* getelementptr inbounds ([7 x i8], [7 x i8]* @.str.1, i32 0, i32 0))\n"
+        "          to label %invoke.cont4 unwind label %lpad, !dbg !1043",
+    "  %call = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([4 x i8], [4 x i8]* @.str, i32 0, i32 0), "
+        "i32 %5), !dbg !31",
+    "  store i32* getelementptr inbounds (%struct.S, %struct.S* @s, i64 0, i32 1), i32** %p, align 8, !tbaa !12",
+    "  %0 = load i32, i32* getelementptr inbounds ([16 x i32], [16 x i32]* @table, i64 0, i64 3), align 4, !dbg !40",
+    "  %cmp = icmp eq i8* %s, getelementptr inbounds ([1 x i8], [1 x i8]* @.str.2, i64 0, i64 0), !dbg !52",
+    "  %arrayidx = getelementptr inbounds [100 x %struct.node], [100 x %struct.node]* %nodes, i64 0, i64 %idxprom, !dbg !61",
+    "  %7 = load %struct.node*, %struct.node** %next, align 8, !dbg !62, !tbaa !63",
+    "  %add = add nsw i32 %6, 1, !dbg !64",
+    "  %call2 = call noalias i8* @malloc(i64 %mul) #5, !dbg !70",
+    "  br i1 %cmp3, label %for.body, label %for.end, !dbg !71, !llvm.loop !72",
+    "  %vecext = extractelement <4 x float> %v, i32 2, !dbg !80",
+    "  %fp = load void (i8*, i32)*, void (i8*, i32)** %handler, align 8, !dbg !81",
+};
+
+/* A switch with @param cases cases, as set_line_to_full_instruction() joins it */
+string builtin_switch(int cases) {
+    string s = "  switch i32 %op, label %sw.default [";
+    for (int i = 0; i < cases; ++i) {
+        s += "\n    i32 " + std::to_string(i * 3) + ", label %sw.bb" + std::to_string(i);
+    }
+    return s + "\n  ]";
+}
+
+struct Corpus {
+    const char* name;
+    std::vector<string> lines;
+};
+
+enum {
+    AllLines,
+    CallBitcast,
+    Invoke,
+    GepConstantExpr,
+    Switch,
+    NumCorpora
+};
+
+void add_line(std::vector<Corpus>& corpora, const string& line) {
+    corpora[AllLines].lines.push_back(line);
+    if (Strings::startswith(line, "switch")) {
+        corpora[Switch].lines.push_back(line);
+    }
+    if (Strings::contains(line, " invoke ")) {
+        corpora[Invoke].lines.push_back(line);
+    }
+    if (Strings::contains(line, "call ") && Strings::contains(line, "bitcast (")) {
+        corpora[CallBitcast].lines.push_back(line);
+    }
+    if (Strings::contains(line, "getelementptr inbounds (") || Strings::contains(line, "getelementptr (")) {
+        corpora[GepConstantExpr].lines.push_back(line);
+    }
+}
+
+bool is_instruction(const string& line) {
+    return line.size() > 2 && line[0] == ' ' && line[1] == ' ' && Strings::first_nonws_char(line) != ';';
+}
+
+/* The instruction lines of @param file, with switch and invoke joined as LLParser does */
+bool read_corpora(const string& file, std::vector<Corpus>& corpora) {
+    std::ifstream ifs(file);
+    if (!ifs.good()) {
+        return false;
+    }
+    string line;
+    while (std::getline(ifs, line)) {
+        if (!is_instruction(line)) {
+            continue;
+        }
+        string full = line;
+        if (Strings::endswith(line, "[") && Strings::startswith(line, "switch")) {
+            while (std::getline(ifs, line)) {
+                full += '\n' + line;
+                if (Strings::startswith(line, "]")) {
+                    break;
+                }
+            }
+        }
+        else if (Strings::contains(line, " invoke ") && std::getline(ifs, line)) {
+            full += '\n' + line;
+        }
+        add_line(corpora, full);
+    }
+    return true;
+}
+
+/* Where a primitive starts parsing in a line */
+struct LineSites {
+    const string* line;
+    std::vector<int> positions;
+};
+
+char scope_end_mark(char c) {
+    switch (c) {
+        case '(': return ')';
+        case '[': return ']';
+        case '{': return '}';
+        case '<': return '>';
+        default:  return 0;
+    }
+}
+
+/* The length of the scope that starts at @param p, or 0 if it isn't closed */
+size_t scope_length(const string& line, size_t p) {
+    char right = scope_end_mark(line[p]);
+    if (!right) {
+        return 0;
+    }
+    size_t n = line.size() - p;
+    size_t len = CharScan::find_scope_end(line.data() + p, n, line[p], right);
+    return len < n ? len + 1 : 0;
+}
+
+/* The outermost brackets */
+std::vector<int> scope_sites(const string& line) {
+    std::vector<int> sites;
+    size_t i = 0;
+    while (i < line.size()) {
+        if (line[i] == '"') {
+            size_t q = line.find('"', i + 1);
+            i = q == string::npos ? line.size() : q + 1;
+            continue;
+        }
+        size_t len = scope_length(line, i);
+        if (len) {
+            sites.push_back((int)i);
+            i += len;
+        }
+        else {
+            i++;
+        }
+    }
+    return sites;
+}
+
+bool starts_with_at(const string& line, size_t p, const char* s) {
+    return line.compare(p, strlen(s), s) == 0;
+}
+
+/* The end of the word at @param p, which ends like a type does */
+size_t type_word_end(const string& line, size_t p) {
+    size_t end = line.find_first_of(" *,)", p);
+    return end == string::npos ? line.size() : end;
+}
+
+/* The end of the basic type at @param p, or 0 if parse_basic_type() would not take it */
+size_t basic_type_end(const string& line, size_t p) {
+    size_t n = line.size();
+    size_t end = 0;
+    string word = line.substr(p, type_word_end(line, p) - p);
+    if (line[p] == 'i' && p + 1 < n && isdigit(line[p + 1])) {
+        end = p + 1;
+        while (end < n && isdigit(line[end])) {
+            end++;
+        }
+    }
+    else if (word == "void" || word == "float" || word == "double") {
+        end = p + word.size();
+    }
+    else if ((line[p] == '[' || line[p] == '<') && p + 1 < n && isdigit(line[p + 1])) {
+        size_t len = scope_length(line, p);
+        end = len ? p + len : 0;
+    }
+    else if (line[p] == '{') {
+        size_t len = scope_length(line, p);
+        end = len ? p + len : 0;
+    }
+    else if (starts_with_at(line, p, "%struct.") || starts_with_at(line, p, "%class.")
+             || starts_with_at(line, p, "%union.")) {
+        end = p + word.size();
+    }
+    if (end && end < n && !strchr(" *,)", line[end])) {
+        return 0;
+    }
+    return end;
+}
+
+/* Types that follow a blank, a '(' or a ',' and whose parameter list, if any, is closed */
+std::vector<int> type_sites(const string& line) {
+    std::vector<int> sites;
+    for (size_t i = 0; i < line.size(); ++i) {
+        if (i > 0 && !strchr(" (", line[i - 1])) {
+            continue;
+        }
+        size_t end = basic_type_end(line, i);
+        if (!end) {
+            continue;
+        }
+        while (end < line.size() && line[end] == '*') {
+            end++;
+        }
+        while (end < line.size() && line[end] == ' ') {
+            end++;
+        }
+        if (end < line.size() && line[end] == '(' && !scope_length(line, end)) {
+            continue;
+        }
+        sites.push_back((int)i);
+    }
+    return sites;
+}
+
+/* Constant expressions like "bitcast (...)" or "getelementptr inbounds (...)" */
+std::vector<int> constant_expr_sites(const string& line) {
+    std::vector<int> sites;
+    for (size_t i = 0; i < line.size(); ++i) {
+        if (!isalpha(line[i]) || (i > 0 && !strchr(" (", line[i - 1]))) {
+            continue;
+        }
+        size_t end = line.find(' ', i);
+        if (end == string::npos) {
+            break;
+        }
+        string op = line.substr(i, end - i);
+        if (!IRFlags::is_const_expr_opcode(op)) {
+            continue;
+        }
+        size_t p = end + 1;
+        if (op == "getelementptr" && starts_with_at(line, p, "inbounds ")) {
+            p += strlen("inbounds ");
+        }
+        if (op == "icmp" || op == "fcmp") {
+            p = line.find(' ', p);
+            p = p == string::npos ? line.size() : p + 1;
+        }
+        if (p < line.size() && line[p] == '(' && scope_length(line, p)) {
+            sites.push_back((int)i);
+        }
+    }
+    return sites;
+}
+
+/* Gives the benchmark the parser state the primitives work on */
+class Replayer: public IRParser {
+public:
+    size_t get_words(const string& line) {
+        size_t n = 0;
+        set_text(line);
+        while (!_eol) {
+            get_word();
+            n += _word.size();
+        }
+        return n;
+    }
+
+    size_t get_words_of(const string& line) {
+        size_t n = 0;
+        set_text(line);
+        while (!_eol) {
+            get_word_of(" ,()[]");
+            n += _word.size();
+        }
+        return n;
+    }
+
+    size_t get_lookaheads(const string& line) {
+        size_t n = 0;
+        set_text(line);
+        while (!_eol) {
+            get_lookahead();
+            jump_ahead();
+            n += _word.size();
+        }
+        return n;
+    }
+
+    size_t jump_scopes(const LineSites& s) {
+        size_t n = 0;
+        set_text(*s.line);
+        for (int p: s.positions) {
+            rewind();
+            set_intext_pos(p);
+            n += jump_to_end_of_scope().size();
+        }
+        return n;
+    }
+
+    size_t parse_types(const LineSites& s) {
+        size_t n = 0;
+        set_text(*s.line);
+        for (int p: s.positions) {
+            rewind();
+            set_intext_pos(p);
+            n += parse_compound_type().size();
+        }
+        return n;
+    }
+
+    size_t match_constant_exprs(const LineSites& s) {
+        size_t n = 0;
+        set_text(*s.line);
+        for (int p: s.positions) {
+            rewind();
+            set_intext_pos(p);
+            n += match_constant_expr().size();
+        }
+        return n;
+    }
+};
+
+struct Measurement {
+    size_t lines;
+    size_t sites;
+    double ns_per_line;
+    double allocations_per_line;
+};
+
+template <typename F>
+Measurement measure(const std::vector<LineSites>& lines, int repeats, F replay, unsigned long long& checksum) {
+    Measurement m = {lines.size(), 0, 0, 0};
+    for (auto& s: lines) {
+        m.sites += s.positions.size();
+    }
+    if (lines.empty()) {
+        return m;
+    }
+
+    uint64_t allocations = Profiler::allocations();
+    Timer t;
+    t.start();
+    for (int r = 0; r < repeats; ++r) {
+        for (auto& s: lines) {
+            checksum += replay(s);
+        }
+    }
+    t.stop();
+    double n = (double)lines.size() * repeats;
+    m.ns_per_line = t.seconds() * 1e9 / n;
+    m.allocations_per_line = (Profiler::allocations() - allocations) / n;
+    return m;
+}
+
+/* Every line of @param corpus, at position 0 */
+std::vector<LineSites> whole_lines(const Corpus& corpus) {
+    std::vector<LineSites> lines;
+    for (auto& l: corpus.lines) {
+        lines.push_back(LineSites{&l, std::vector<int>(1, 0)});
+    }
+    return lines;
+}
+
+template <typename F>
+std::vector<LineSites> sites_of(const Corpus& corpus, F find) {
+    std::vector<LineSites> lines;
+    for (auto& l: corpus.lines) {
+        std::vector<int> positions = find(l);
+        if (!positions.empty()) {
+            lines.push_back(LineSites{&l, positions});
+        }
+    }
+    return lines;
+}
+
+void report(const Corpus& c, const char* primitive, const Measurement& m) {
+    if (m.lines == 0) {
+        return;
+    }
+    printf("%-16s %-24s %8zu %8zu %10.1f %12.2f\n", c.name, primitive, m.lines, m.sites,
+           m.ns_per_line, m.allocations_per_line);
+}
+
+}
+
+int main(int argc, char** argv) {
+    int repeats = 20;
+    std::vector<Corpus> corpora = {
+        {"all", {}}, {"call-bitcast", {}}, {"invoke", {}}, {"gep-constexpr", {}}, {"switch", {}}
+    };
+
+    bool has_files = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-r" && i + 1 < argc) {
+            repeats = atoi(argv[++i]);
+            continue;
+        }
+        if (!read_corpora(arg, corpora)) {
+            fprintf(stderr, "cannot open %s\n", arg.c_str());
+            fprintf(stderr, "usage: %s [-r repeats] [file.ll...]\n", argv[0]);
+            return 1;
+        }
+        has_files = true;
+    }
+    if (!has_files) {
+        for (auto l: builtin_lines) {
+            add_line(corpora, l);
+        }
+        for (int cases: {8, 64, 512}) {
+            add_line(corpora, builtin_switch(cases));
+        }
+    }
+    if (repeats < 1) {
+        repeats = 1;
+    }
+
+    IRFlags::init();
+    Profiler::set_counting(true);
+    Replayer parser;
+    unsigned long long checksum = 0;
+
+    printf("%-16s %-24s %8s %8s %10s %12s\n", "corpus", "primitive", "lines", "sites", "ns/line", "allocs/line");
+    for (auto& c: corpora) {
+        std::vector<LineSites> lines = whole_lines(c);
+        report(c, "get_word", measure(lines, repeats,
+            [&](const LineSites& s) { return parser.get_words(*s.line); }, checksum));
+        report(c, "get_word_of", measure(lines, repeats,
+            [&](const LineSites& s) { return parser.get_words_of(*s.line); }, checksum));
+        report(c, "get_lookahead", measure(lines, repeats,
+            [&](const LineSites& s) { return parser.get_lookaheads(*s.line); }, checksum));
+        report(c, "jump_to_end_of_scope", measure(sites_of(c, scope_sites), repeats,
+            [&](const LineSites& s) { return parser.jump_scopes(s); }, checksum));
+        report(c, "parse_compound_type", measure(sites_of(c, type_sites), repeats,
+            [&](const LineSites& s) { return parser.parse_types(s); }, checksum));
+        report(c, "match_constant_expr", measure(sites_of(c, constant_expr_sites), repeats,
+            [&](const LineSites& s) { return parser.match_constant_exprs(s); }, checksum));
+    }
+    printf("repeats: %d, checksum: %llu\n", repeats, checksum);
+    return 0;
+}
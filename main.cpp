@@ -6,6 +6,7 @@
 #include "peripheral/optParser.h"
 #include "peripheral/sysArgs.h"
 #include "peripheral/timer.h"
+#include "utilities/profiler.h"
 
 void* llparser_start(string* filename) {
     Timer t;
@@ -18,12 +19,25 @@ void* llparser_start(string* filename) {
         llparser = SysDict::parser;
     }
 
-    Module* m = llparser->parse(*filename);
+    Module* m = NULL;
+    {
+        ScopedPhase phase("process_file", filename->c_str());
+        if (ParallelModule) {
+            Tracer::set_thread_name("parse " + *filename);
+        }
+        m = llparser->parse(*filename);
+    }
     if (!m) {
         exit(1);
     }
     t.stop();
     zpl("file: %s; time: %.3f seconds, line: %lld", (*filename).c_str(), t.seconds(), llparser->line_number());
+
+    /* nothing looks at the module after its passes, give back its memory before the next input */
+    if (ReleaseModules && !UseSplitModule && !PassManager::pass_manager->has_global_passes()) {
+        SysDict::remove_module(m);
+    }
+    return NULL;
 }
 
 
@@ -38,6 +52,10 @@ int main(int argc, char** argv) {
     sopt_args.argc = argc;
     sopt_args.argv = argv;
     SysArgs::init(&sopt_args);
+    Profiler::set_counting(ProfilePhases);
+    if (!TraceFile.empty()) {
+        Tracer::start(TraceFile);
+    }
     PassManager::init();
 
     /* todo:
@@ -92,6 +110,13 @@ int main(int argc, char** argv) {
     SysDict::destroy();
     PassManager::destroy();
 
+    if (ProfilePhases) {
+        Profiler::report(stdout);
+        if (!ProfileFile.empty() && !Profiler::write_json(ProfileFile)) {
+            fprintf(stderr, "cannot write the phase profile to %s\n", ProfileFile.c_str());
+        }
+    }
+
     gtimer.stop();
     zpl("global time: %.3f seconds", gtimer.seconds());
     return 0;
@@ -6,43 +6,69 @@
 #include <cstring>
 #include "instFlags.h"
 
+namespace {
 
-std::set<string> IRFlags::_fastmaths;
-std::set<string> IRFlags::_linkages;
-std::set<string> IRFlags::_cconvs;
-std::set<string> IRFlags::_visibilities;
-std::set<string> IRFlags::_dll_storage_classes;
-std::set<string> IRFlags::_param_attrs;
-std::set<string> IRFlags::_tails;
-std::set<string> IRFlags::_terminator_insts;
+struct Keyword {
+    const char* name;
+    unsigned categories;
+};
 
-std::set<string> IRFlags::_binary_opcodes;
-std::set<string> IRFlags::_bitwise_binary_opcodes;  // todo: to add
-std::set<string> IRFlags::_const_expr_opcodes;
+constexpr Keyword keywords[] = {
+#define IR_KEYWORD_ENTRY(name, categories) { name, IRFlags::categories },
+    IR_KEYWORDS_DO(IR_KEYWORD_ENTRY)
+#undef IR_KEYWORD_ENTRY
+};
+
+constexpr size_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+
+/* Same as IRFlags::hash(), usable in constant expressions */
+constexpr uint32_t const_hash(const char* s, uint32_t h) {
+    return *s ? const_hash(s+1, (h ^ (uint8_t)*s) * 16777619u) : h;
+}
+
+constexpr uint32_t slot_of(size_t i) {
+    return const_hash(keywords[i].name, IRFlags::HASH_SEED) >> (32 - IRFlags::SLOT_BITS);
+}
+
+constexpr bool differs_from_rest(size_t i, size_t j) {
+    return j >= keyword_count || (slot_of(i) != slot_of(j) && differs_from_rest(i, j+1));
+}
+
+constexpr bool is_perfect(size_t i) {
+    return i >= keyword_count || (differs_from_rest(i, i+1) && is_perfect(i+1));
+}
+
+static_assert(keyword_count < 255, "IRFlags: too many keywords for the slot table");
+static_assert(is_perfect(0), "IRFlags: two keywords share a slot, pick another HASH_SEED");
+
+}
+
+uint8_t IRFlags::_slots[1 << SLOT_BITS];
 
 void IRFlags::init() {
-    _fastmaths = { "nnan", "ninf", "nsz", "arcp", "contract", "fast"};
-    _linkages = { "private", "internal", "available_externally", "weak", "linkonce", "common",
-                  "appending", "extern_weak", "linkonce_odr", "weak_odr", "external" };
-    _cconvs = { "ccc", "fastcc", "coldcc", "cc 10", "cc 11", "webkit_jscc", "anyregcc", "preserve_mostcc", "preserve_allcc", "cxx_fast_tlscc", "swiftcc" };
-    _visibilities = { "default", "hidden", "protected" };  // A symbol with internal or private linkage must have default visibility.
-    _dll_storage_classes = { "dllimport", "dllexport" };
-    _param_attrs = { "zeroext", "signext", "inreg", "byval", "inalloca", "sret", "align", "noalias",
-                     "nocapture", "nest", "returned", "nonnull", "dereferenceable", "dereferenceable_or_null" }; // more to go
-    _tails = { "tail", "musttail", "notail" };
-    _terminator_insts = { "ret", "br", "switch", "indirectbr", "invoke", "resume", "catchswitch", "catchret", "cleanupret", "unreachable" };
-    _binary_opcodes = { "add", "fadd", "sub", "fsub", "mul",
-                        "fmul", "udiv", "sdiv", "fdiv", "urem",
-                        "srem", "frem"};
-    _const_expr_opcodes = { "trunc", "zext", "sext", "fptrunc", "fpext",
-                            "fptoui", "fptosi", "uitofp", "sitofp", "ptrtoint",
-                            "inttoptr", "bitcast", "addrspacecast", "getelementptr", "select",
-                            "icmp", "fcmp", "extractelement", "insertelement", "shufflevector",
-                            "extractvalue", "insertvalue" };
+    memset(_slots, 0, sizeof(_slots));
+    for (size_t i = 0; i < keyword_count; ++i) {
+        const char* name = keywords[i].name;
+        uint32_t slot = hash(name, strlen(name)) >> (32 - SLOT_BITS);
+        guarantee(_slots[slot] == 0, "IRFlags: %s collides with %s", name, keywords[_slots[slot]-1].name);
+        _slots[slot] = (uint8_t)(i + 1);
+    }
+}
+
+unsigned IRFlags::classify(const char* s, size_t n) {
+    uint8_t k = _slots[hash(s, n) >> (32 - SLOT_BITS)];
+    if (k == 0) {
+        return 0;
+    }
+    const char* name = keywords[k-1].name;
+    if (strncmp(name, s, n) != 0 || name[n] != '\0') {
+        return 0;
+    }
+    return keywords[k-1].categories;
 }
 
 bool IRFlags::is_cconv_flag(const string& key) {
-    if (_cconvs.find(key) != _cconvs.end()) {
+    if (classify(key) & CConvFlag) {
         return true;
     }
 
@@ -55,37 +81,33 @@ bool IRFlags::is_cconv_flag(const string& key) {
 
 
 bool IRFlags::is_param_attr_flag(const string& key) {
-    const char* p1 = "align%d";
-    int dummy;
-    int matched1 = sscanf(key.c_str(), p1, &dummy);
-    if (matched1 == 1) {
+    if (classify(key) & ParamAttrFlag) {
         return true;
     }
 
-    /* dereferenceable_or_null never seemed to be used */
-    const char* prefixes[2] = { "dereferenceable", "dereferenceable_or_null" };
-    for (auto prefix: prefixes) {
-        if (Strings::startswith(key, prefix)) {
-            int start_pos = strlen(prefix) + 1;
-            guarantee(key[start_pos-1] == '(', "char: %c, key: %s", key[start_pos-1], key.c_str());
-            int end_pos = key.find(')', start_pos);
-            string number = key.substr(start_pos, end_pos-start_pos);
-            guarantee(Strings::is_number(number), " ");
+    if (key[0] == 'a') {
+        const char* p1 = "align%d";
+        int dummy;
+        int matched1 = sscanf(key.c_str(), p1, &dummy);
+        if (matched1 == 1) {
             return true;
         }
     }
 
-    return _param_attrs.find(key) != _param_attrs.end();
-}
-
-bool IRFlags::is_const_expr_opcode(const string &key) {
-    if (_const_expr_opcodes.find(key) != _const_expr_opcodes.end()) {
-        return true;
-    }
-
-    if (is_binary_opcode(key) || is_bitwise_binary_opcode(key)) {
-        return true;
+    /* dereferenceable_or_null never seemed to be used */
+    if (key[0] == 'd') {
+        const char* prefixes[2] = { "dereferenceable_or_null", "dereferenceable" };
+        for (auto prefix: prefixes) {
+            if (Strings::startswith(key, prefix)) {
+                int start_pos = strlen(prefix) + 1;
+                guarantee(key[start_pos-1] == '(', "char: %c, key: %s", key[start_pos-1], key.c_str());
+                int end_pos = key.find(')', start_pos);
+                string number = key.substr(start_pos, end_pos-start_pos);
+                guarantee(Strings::is_number(number), " ");
+                return true;
+            }
+        }
     }
 
     return false;
-}
\ No newline at end of file
+}
@@ -5,51 +5,174 @@
 #ifndef LLPARSER_INSTFLAG_H
 #define LLPARSER_INSTFLAG_H
 
-#include <set>
-#include <unordered_set>
-#include <bits/unordered_set.h>
+#include <cstdint>
 #include "utilities/macros.h"
+#include "utilities/symbol.h"
 
+/* The keywords IRFlags knows, as (keyword, categories) */
+#define IR_KEYWORDS_DO(f)                                                 \
+  /* fast-math flags */                                                   \
+  f("nnan",                     FastMathFlag)                             \
+  f("ninf",                     FastMathFlag)                             \
+  f("nsz",                      FastMathFlag)                             \
+  f("arcp",                     FastMathFlag)                             \
+  f("contract",                 FastMathFlag)                             \
+  f("fast",                     FastMathFlag)                             \
+  /* linkages */                                                          \
+  f("private",                  LinkageFlag)                              \
+  f("internal",                 LinkageFlag)                              \
+  f("available_externally",     LinkageFlag)                              \
+  f("weak",                     LinkageFlag)                              \
+  f("linkonce",                 LinkageFlag)                              \
+  f("common",                   LinkageFlag)                              \
+  f("appending",                LinkageFlag)                              \
+  f("extern_weak",              LinkageFlag)                              \
+  f("linkonce_odr",             LinkageFlag)                              \
+  f("weak_odr",                 LinkageFlag)                              \
+  f("external",                 LinkageFlag)                              \
+  /* calling conventions */                                               \
+  f("ccc",                      CConvFlag)                                \
+  f("fastcc",                   CConvFlag)                                \
+  f("coldcc",                   CConvFlag)                                \
+  f("cc 10",                    CConvFlag)                                \
+  f("cc 11",                    CConvFlag)                                \
+  f("webkit_jscc",              CConvFlag)                                \
+  f("anyregcc",                 CConvFlag)                                \
+  f("preserve_mostcc",          CConvFlag)                                \
+  f("preserve_allcc",           CConvFlag)                                \
+  f("cxx_fast_tlscc",           CConvFlag)                                \
+  f("swiftcc",                  CConvFlag)                                \
+  /* visibilities and dll storage classes */                              \
+  f("default",                  VisibilityFlag)                           \
+  f("hidden",                   VisibilityFlag)                           \
+  f("protected",                VisibilityFlag)                           \
+  f("dllimport",                DLLStorageClassFlag)                      \
+  f("dllexport",                DLLStorageClassFlag)                      \
+  /* attrs for return type and function parameter type, more to go */     \
+  f("zeroext",                  ParamAttrFlag)                            \
+  f("signext",                  ParamAttrFlag)                            \
+  f("inreg",                    ParamAttrFlag)                            \
+  f("byval",                    ParamAttrFlag)                            \
+  f("inalloca",                 ParamAttrFlag)                            \
+  f("sret",                     ParamAttrFlag)                            \
+  f("align",                    ParamAttrFlag)                            \
+  f("noalias",                  ParamAttrFlag)                            \
+  f("nocapture",                ParamAttrFlag)                            \
+  f("nest",                     ParamAttrFlag)                            \
+  f("returned",                 ParamAttrFlag)                            \
+  f("nonnull",                  ParamAttrFlag)                            \
+  f("dereferenceable",          ParamAttrFlag)                            \
+  f("dereferenceable_or_null",  ParamAttrFlag)                            \
+  /* tail flags */                                                        \
+  f("tail",                     TailFlag)                                 \
+  f("musttail",                 TailFlag)                                 \
+  f("notail",                   TailFlag)                                 \
+  /* terminators */                                                       \
+  f("ret",                      TerminatorInst)                           \
+  f("br",                       TerminatorInst)                           \
+  f("switch",                   TerminatorInst)                           \
+  f("indirectbr",               TerminatorInst)                           \
+  f("invoke",                   TerminatorInst)                           \
+  f("resume",                   TerminatorInst)                           \
+  f("catchswitch",              TerminatorInst)                           \
+  f("catchret",                 TerminatorInst)                           \
+  f("cleanupret",               TerminatorInst)                           \
+  f("unreachable",              TerminatorInst)                           \
+  /* binary opcodes, bitwise binary opcodes are todo */                   \
+  f("add",                      BinaryOpcode)                             \
+  f("fadd",                     BinaryOpcode)                             \
+  f("sub",                      BinaryOpcode)                             \
+  f("fsub",                     BinaryOpcode)                             \
+  f("mul",                      BinaryOpcode)                             \
+  f("fmul",                     BinaryOpcode)                             \
+  f("udiv",                     BinaryOpcode)                             \
+  f("sdiv",                     BinaryOpcode)                             \
+  f("fdiv",                     BinaryOpcode)                             \
+  f("urem",                     BinaryOpcode)                             \
+  f("srem",                     BinaryOpcode)                             \
+  f("frem",                     BinaryOpcode)                             \
+  /* other constant expression opcodes */                                 \
+  f("trunc",                    ConstExprOpcode)                          \
+  f("zext",                     ConstExprOpcode)                          \
+  f("sext",                     ConstExprOpcode)                          \
+  f("fptrunc",                  ConstExprOpcode)                          \
+  f("fpext",                    ConstExprOpcode)                          \
+  f("fptoui",                   ConstExprOpcode)                          \
+  f("fptosi",                   ConstExprOpcode)                          \
+  f("uitofp",                   ConstExprOpcode)                          \
+  f("sitofp",                   ConstExprOpcode)                          \
+  f("ptrtoint",                 ConstExprOpcode)                          \
+  f("inttoptr",                 ConstExprOpcode)                          \
+  f("bitcast",                  ConstExprOpcode)                          \
+  f("addrspacecast",            ConstExprOpcode)                          \
+  f("getelementptr",            ConstExprOpcode)                          \
+  f("select",                   ConstExprOpcode)                          \
+  f("icmp",                     ConstExprOpcode)                          \
+  f("fcmp",                     ConstExprOpcode)                          \
+  f("extractelement",           ConstExprOpcode)                          \
+  f("insertelement",            ConstExprOpcode)                          \
+  f("shufflevector",            ConstExprOpcode)                          \
+  f("extractvalue",             ConstExprOpcode)                          \
+  f("insertvalue",              ConstExprOpcode)                          \
+
+/**@brief Classify the keywords of the IR
+ *
+ * All keywords live in one table that is indexed by a hash of the word. The hash seed
+ * is chosen so that no two keywords share a slot, which is checked at compile time,
+ * so classifying a word takes one hash and at most one string compare, and gives all
+ * the categories of the word at once.
+ */
 class IRFlags {
-    static std::set<string> _fastmaths;
-    static std::set<string> _linkages;
-    static std::set<string> _cconvs;  // calling conventions
-    static std::set<string> _visibilities;
-    static std::set<string> _dll_storage_classes;
-    static std::set<string> _param_attrs;  // attrs for return type and function parameter type
-    static std::set<string> _tails;
-    static std::set<string> _terminator_insts;
-
-    static std::set<string> _binary_opcodes;
-    static std::set<string> _bitwise_binary_opcodes;
-    static std::set<string> _const_expr_opcodes;
+public:
+    enum Category {
+        FastMathFlag        = 1 << 0,
+        LinkageFlag         = 1 << 1,
+        CConvFlag           = 1 << 2,  // calling conventions
+        VisibilityFlag      = 1 << 3,
+        DLLStorageClassFlag = 1 << 4,
+        ParamAttrFlag       = 1 << 5,  // attrs for return type and function parameter type
+        TailFlag            = 1 << 6,
+        TerminatorInst      = 1 << 7,
+        BinaryOpcode        = 1 << 8,
+        BitwiseBinaryOpcode = 1 << 9,
+        ConstExprOpcode     = 1 << 10
+    };
+
+    static const int SLOT_BITS = 9;
+    static const uint32_t HASH_SEED = 13455;
 
+    /* 32-bit FNV-1a from HASH_SEED, the slot of a word is the top SLOT_BITS bits */
+    static uint32_t hash(const char* s, size_t n) {
+        uint32_t h = HASH_SEED;
+        for (size_t i = 0; i < n; ++i) {
+            h = (h ^ (uint8_t)s[i]) * 16777619u;
+        }
+        return h;
+    }
+private:
+    static uint8_t _slots[1 << SLOT_BITS];  // index of the keyword in the slot plus one, 0 if empty
 public:
     static void init();
-    static std::set<string> fastmaths()                                   { return _fastmaths; }
-    static bool is_fastmath_flag(const string& key)                       { return _fastmaths.find(key) != _fastmaths.end(); }
-    //static bool is_fastmath_flag(string key);
 
-    static std::set<string> linkages()                                    { return _linkages; }
-    static bool is_linkage_flag(const string& key)                        { return _linkages.find(key) != _linkages.end(); }
+    /// The categories of a word as a mask of Category, 0 if it is not a keyword
+    static unsigned classify(const char* s, size_t n);
+    static unsigned classify(const string& key)                           { return classify(key.data(), key.size()); }
+    static unsigned classify(Symbol key)                                  { return classify(key.str()); }
 
-    static std::set<string> cconvs()                                      { return _cconvs; }
+    static bool is_fastmath_flag(const string& key)                       { return classify(key) & FastMathFlag; }
+    static bool is_linkage_flag(const string& key)                        { return classify(key) & LinkageFlag; }
     static bool is_cconv_flag(const string& key);
-
-    static std::set<string> visibilities()                                { return _visibilities; }
-    static bool is_visibility_flag(const string& key)                     { return _visibilities.find(key) != _visibilities.end(); }
-
-    static bool is_dll_storage_class_flag(const string& key)              { return _dll_storage_classes.find(key) != _dll_storage_classes.end(); }
-
+    static bool is_visibility_flag(const string& key)                     { return classify(key) & VisibilityFlag; }
+    static bool is_dll_storage_class_flag(const string& key)              { return classify(key) & DLLStorageClassFlag; }
     static bool is_param_attr_flag(const string& key);
-    static bool is_tail_flag(const string& key)                           { return _tails.find(key) != _tails.end(); }
-    //static bool is_tail_flag1(string key);
+    static bool is_tail_flag(const string& key)                           { return classify(key) & TailFlag; }
 
-    static bool is_terminator_inst(const string& key)                     { return _terminator_insts.find(key) != _terminator_insts.end(); }
+    static bool is_terminator_inst(Symbol op)                             { return classify(op) & TerminatorInst; }
+    static bool is_terminator_inst(const string& key)                     { return classify(key) & TerminatorInst; }
 
-    static bool is_binary_opcode(const string& key)                       { return _binary_opcodes.find(key) != _binary_opcodes.end(); }
-    static bool is_bitwise_binary_opcode(const string& key)               { return _bitwise_binary_opcodes.find(key) != _bitwise_binary_opcodes.end(); }
-    static bool is_const_expr_opcode(const string& key);//                   { return _const_expr_opcodes.find(key) != _const_expr_opcodes.end(); }
+    static bool is_binary_opcode(const string& key)                       { return classify(key) & BinaryOpcode; }
+    static bool is_bitwise_binary_opcode(const string& key)               { return classify(key) & BitwiseBinaryOpcode; }
+    static bool is_const_expr_opcode(const string& key)                   { return classify(key) & (ConstExprOpcode|BinaryOpcode|BitwiseBinaryOpcode); }
 };
 
 #endif //LLPARSER_INSTFLAG_H
@@ -5,10 +5,13 @@
 #include <cstring>
 #include <cassert>
 #include <algorithm>
+#include <set>
 #include <utilities/flags.h>
 #include <utilities/strings.h>
+#include <utilities/textArena.h>
 #include <inst/instEssential.h>
 #include <inst/branchInst.h>
+#include <utilities/symbolMap.h>
 #include "instParser.h"
 #include "sysDict.h"
 
@@ -16,9 +19,118 @@
 //int InstParser::MAX_VALUE_LEN = 1024;
 
 
-Instruction* InstParser::create_instruction(string &text) {
+namespace {
+
+template <typename T>
+Instruction* create_inst() {
+    return new T();
+}
+
+/* The opcodes that have their own Instruction class */
+#define TYPED_OPCODES_DO(f)                 \
+  f("alloca",         AllocaInst)           \
+  f("load",           LoadInst)             \
+  f("store",          StoreInst)            \
+  f("getelementptr",  GetElementPtrInst)    \
+  f("bitcast",        BitCastInst)          \
+  f("br",             BranchInst)           \
+  f("call",           CallInst)             \
+  f("invoke",         InvokeInst)           \
+  f("ret",            ReturnInst)           \
+  f("switch",         SwitchInst)           \
+  f("phi",            PhiInst)              \
+  f("icmp",           CmpInst)              \
+  f("fcmp",           CmpInst)              \
+  f("add",            BinaryInst)           \
+  f("fadd",           BinaryInst)           \
+  f("sub",            BinaryInst)           \
+  f("fsub",           BinaryInst)           \
+  f("mul",            BinaryInst)           \
+  f("fmul",           BinaryInst)           \
+  f("udiv",           BinaryInst)           \
+  f("sdiv",           BinaryInst)           \
+  f("fdiv",           BinaryInst)           \
+  f("urem",           BinaryInst)           \
+  f("srem",           BinaryInst)           \
+  f("frem",           BinaryInst)           \
+  f("shl",            BinaryInst)           \
+  f("lshr",           BinaryInst)           \
+  f("ashr",           BinaryInst)           \
+  f("and",            BinaryInst)           \
+  f("or",             BinaryInst)           \
+  f("xor",            BinaryInst)           \
+  f("trunc",          CastInst)             \
+  f("zext",           CastInst)             \
+  f("sext",           CastInst)             \
+  f("fptrunc",        CastInst)             \
+  f("fpext",          CastInst)             \
+  f("fptoui",         CastInst)             \
+  f("fptosi",         CastInst)             \
+  f("uitofp",         CastInst)             \
+  f("sitofp",         CastInst)             \
+  f("ptrtoint",       CastInst)             \
+  f("inttoptr",       CastInst)             \
+  f("addrspacecast",  CastInst)             \
+
+struct OpcodeEntry {
+    Symbol opcode;                 // "call" for the tail flags
+    Instruction* (*create)();
+    bool skip;                     // listed in -XX:SkipInst, create but don't parse
+};
+
+SymbolMap<OpcodeEntry>* build_opcode_table() {
+    std::set<string> skipped;
+    for (auto& op: Strings::split(SkipInst, ',')) {
+        skipped.insert(op);
+    }
+
+    auto table = new SymbolMap<OpcodeEntry>();
+#define OPCODE_ENTRY_ADD(op, cls) table->set(Symbol(op), OpcodeEntry{Symbol(op), &create_inst<cls>, skipped.count(op) != 0});
+    TYPED_OPCODES_DO(OPCODE_ENTRY_ADD)
+#undef OPCODE_ENTRY_ADD
+
+    /* a call starts with its tail flag if it has one */
+    OpcodeEntry call = table->get(Symbol("call"));
+    table->set(Symbol("tail"), call);
+    table->set(Symbol("musttail"), call);
+    table->set(Symbol("notail"), call);
+    return table;
+}
+
+/* Built on first use, after the flags are set */
+const SymbolMap<OpcodeEntry>& opcode_table() {
+    static SymbolMap<OpcodeEntry>* table = build_opcode_table();
+    return *table;
+}
+
+}
+
+/**@brief The opcodes that get an Instruction class of their own, as "op:Class,...",
+ * with the opcodes listed in -XX:SkipInst marked as skipped
+ */
+string InstParser::opcode_classes() {
+    std::set<string> skipped;
+    for (auto& op: Strings::split(SkipInst, ',')) {
+        skipped.insert(op);
+    }
+
+    string s;
+#define OPCODE_CLASS_ADD(op, cls) s += string(op) + ":" + (skipped.count(op) ? "skip" : #cls) + ",";
+    TYPED_OPCODES_DO(OPCODE_CLASS_ADD)
+#undef OPCODE_CLASS_ADD
+    return s;
+}
+
+/**@brief Create an instruction from @param text
+ *
+ * The class of the instruction is looked up by its opcode in a table that is built
+ * once. Instructions whose opcode is listed in -XX:SkipInst keep only their raw text.
+ *
+ * @param raw: @param text as it is stored in the module, e.g. in the mapped input file.
+ * If not given, @param text is copied into the current TextArena.
+ */
+Instruction* InstParser::create_instruction(const string& text, StringRef raw) {
     set_text(text);
-    string op;
     string name;
     bool has_assignment = false;
 
@@ -30,66 +142,16 @@ Instruction* InstParser::create_instruction(string &text) {
     }
 
     get_word_of(" ,");
-    op = _word;
+    Symbol op(_word);
     Instruction* inst = NULL;
-    //void (InstParser::*parse_routine) (Instruction*) = NULL;
+    bool parse_it = false;
 
-    if (op == "tail" || op == "musttail" || op == "notail") {
-        op = "call";
+    if (const OpcodeEntry* entry = opcode_table().find(op)) {
+        inst = entry->create();
+        op = entry->opcode;
+        parse_it = !entry->skip;
     }
-
-    /* unaware of the instruction type at this point */
-    switch (op[0]) {
-        case 'a': {
-            if (op == "alloca") {
-                //inst = new AllocaInst();
-            }
-            break;
-        }
-        case 'b': {
-            if (op == "bitcast") {
-                inst = new BitCastInst();
-                //parse_routine = &InstParser::do_bitcast;
-            }
-            else if (op == "br") {
-                inst = new BranchInst();
-                //parse_routine = &InstParser::do_branch;
-            }
-            break;
-        }
-        case 'c': {
-            if (op == "call") {
-                inst = new CallInst();
-                //parse_routine = &InstParser::do_call_family;
-            }
-            break;
-        }
-        case 'i': {
-            if (op == "invoke") {
-                inst = new InvokeInst();
-                //parse_routine = &InstParser::do_call_family;
-            }
-            break;
-        }
-        case 'l': {
-            if (op == "load") {
-                inst = new LoadInst();
-                //parse_routine = &InstParser::do_load;
-            }
-            break;
-        }
-        case 's': {
-            if (op == "store") {
-                inst = new StoreInst();
-            }
-            break;
-        }
-        default: {
-            break;
-        }
-    }
-
-    if (!inst) {
+    else {
         inst = new Instruction();
     }
 
@@ -98,18 +160,11 @@ Instruction* InstParser::create_instruction(string &text) {
     if (has_assignment) {
         inst->set_name(name);
     }
-    inst->set_raw_text(text);
+    inst->set_raw_text(raw.is_null() ? TextArena::current()->copy(text) : raw);
 
-    if (inst->type() != Instruction::UnknownInstType
-        && !Strings::contains(SkipInst, op+",")
-        // && inst->type() != Instruction::BranchInstType
-        // && inst->type() != Instruction::LoadInstType
-        // && inst->type() != Instruction::StoreInstType
-        ) {
+    if (parse_it) {
         parse(inst);
-        //(this->*parse_routine)(inst);
         parse_metadata(inst);
-        //
     }
     return inst;
 
@@ -144,6 +199,27 @@ void InstParser::parse(Instruction *inst) {
         case Instruction::BitCastInstType :
             do_bitcast(inst);
             break;
+        case Instruction::GetElementPtrInstType:
+            do_getelementptr(inst);
+            break;
+        case Instruction::PhiInstType:
+            do_phi(inst);
+            break;
+        case Instruction::CmpInstType:
+            do_cmp(inst);
+            break;
+        case Instruction::BinaryInstType:
+            do_binary(inst);
+            break;
+        case Instruction::CastInstType:
+            do_cast(inst);
+            break;
+        case Instruction::ReturnInstType:
+            do_return(inst);
+            break;
+        case Instruction::SwitchInstType:
+            do_switch(inst);
+            break;
         default:
             guarantee(0, "sanity");
     }
@@ -203,7 +279,7 @@ void InstParser::do_call_family(Instruction* inst) {
 
     // _word here contains the opcode, which could be either call, invoke or a tail flag
     if (IRFlags::is_tail_flag(_word)) {
-        ci->set_raw_field("tail", _word);
+        ci->set_raw_field(RawField::Tail, _word);
         get_word();
     }
 
@@ -239,7 +315,7 @@ void InstParser::do_call_family(Instruction* inst) {
         else {
             ci->set_is_varargs();
             parser_assert(Strings::endswith(args_sig, "...)"), "vararg signature should end with '...)'");
-            ci->set_raw_field("fnty", args_sig);
+            ci->set_raw_field(RawField::Fnty, args_sig);
         }
         inc_intext_pos();
     }
@@ -290,7 +366,7 @@ void InstParser::do_call_family(Instruction* inst) {
             fn_name = _word;
         }
 
-        ci->set_raw_field("fnptrval", fn_name);
+        ci->set_raw_field(RawField::Fnptrval, fn_name);
     }
     else if (_char == '%') {
         // todo: indirect calls
@@ -299,7 +375,7 @@ void InstParser::do_call_family(Instruction* inst) {
         string label = _word;
         ci->set_is_indirect_call();
         ci->set_called_label(label);
-        ci->set_raw_field("fnptrval", label);
+        ci->set_raw_field(RawField::Fnptrval, label);
         parser_assert(!ci->has_bitcast(), "just check");
     }
     else if (_char == 'a') {
@@ -313,14 +389,14 @@ void InstParser::do_call_family(Instruction* inst) {
 
     /* do args */
     string args = jump_to_end_of_scope();
-    ci->set_raw_field("args", args.substr(1, args.size()-2)); // strip the ()
+    ci->set_raw_field(RawField::Args, args.substr(1, args.size()-2)); // strip the ()
 
     /* The optional function attributes list */
     while (!_eol) {
         get_lookahead_of(", ");
         if (_lookahead[0] == '#') {
             jump_ahead();
-            ci->set_raw_field("fn-attrs", _word);
+            ci->set_raw_field(RawField::FnAttrs, _word);
         }
         else {
             break;
@@ -330,10 +406,10 @@ void InstParser::do_call_family(Instruction* inst) {
     if (inst->type() == Instruction::InvokeInstType) {
         match("to label ", true);
         get_word();
-        inst->set_raw_field("normal-label", _word);
+        inst->set_raw_field(RawField::NormalLabel, _word);
         match("unwind label ");
         get_word(',');
-        inst->set_raw_field("exception-label", _word);
+        inst->set_raw_field(RawField::ExceptionLabel, _word);
     }
 }
 
@@ -357,8 +433,8 @@ void InstParser::do_load(Instruction *inst) {
      */
     LoadInst* li = dynamic_cast<LoadInst*>(inst);
 
-    set_optional_field(inst, "atomic");
-    set_optional_field(inst, "volatile");
+    set_optional_field(inst, RawField::Atomic);
+    set_optional_field(inst, RawField::Volatile);
 
 
     string ty = parse_compound_type();
@@ -368,31 +444,31 @@ void InstParser::do_load(Instruction *inst) {
     inc_intext_pos(2);
     string ty_p = parse_compound_type();
     syntax_check(ty_p == ty + '*');
-    li->set_raw_field("ty", ty);
+    li->set_raw_field(RawField::Ty, ty);
 
     get_word_of(" ,");
 
     if (_word == "getelementptr") {
         GetElementPtrInst* gepi = new GetElementPtrInst();
         do_getelementptr(gepi, true);
-        li->set_raw_field("pointer", gepi->raw_text());
+        li->set_raw_field(RawField::Pointer, gepi->raw_text());
         match(',');
     }
     else if (_word == "bitcast") {
         BitCastInst* bci = new BitCastInst();
         do_bitcast(bci, true);
-        //li->set_raw_field("pointer", bci->get_raw_field("value"));
-        li->set_raw_field("pointer", bci->raw_text());
-        li->set_raw_field("final-pointer", bci->get_raw_field("value"));
-        syntax_check(bci->get_raw_field("ty2") == ty_p);
+        //li->set_raw_field(RawField::Pointer, bci->get_raw_field(RawField::Value));
+        li->set_raw_field(RawField::Pointer, bci->raw_text());
+        li->set_raw_field(RawField::FinalPointer, bci->get_raw_field(RawField::Value));
+        syntax_check(bci->get_raw_field(RawField::Ty2) == ty_p);
         match(',');
     }
     else {
-        li->set_raw_field("pointer", _word);  // might do some syntax check on pointer
+        li->set_raw_field(RawField::Pointer, _word);  // might do some syntax check on pointer
     }
 
     //zps(li->raw_text())
-    //zpl("load from %s", li->get_raw_field("pointer").c_str())
+    //zpl("load from %s", li->get_raw_field(RawField::Pointer).c_str())
 
     if (_eol) {
         return;
@@ -400,7 +476,7 @@ void InstParser::do_load(Instruction *inst) {
 
     match(" align ");
     get_word(',');
-    li->set_raw_field("alignment", _word);
+    li->set_raw_field(RawField::Alignment, _word);
     if (_eol) {
         return;
     }
@@ -418,13 +494,13 @@ void InstParser::do_load(Instruction *inst) {
  */
 void InstParser::do_store(Instruction *ins) {
     StoreInst* di = dynamic_cast<StoreInst*>(ins);
-    set_optional_field(ins, "atomic");
-    set_optional_field(ins, "volatile");
+    set_optional_field(ins, RawField::Atomic);
+    set_optional_field(ins, RawField::Volatile);
 
     string ty = parse_compound_type();
     string value = match_value();
     parser_assert(!value.empty(), "expect a value after %s", ty.c_str());
-    di->set_raw_field("value", value);
+    di->set_raw_field(RawField::Value, value);
 
     /* the match_value() may or may not skip the ',' */
     if (_char == ',') {
@@ -436,13 +512,13 @@ void InstParser::do_store(Instruction *ins) {
         syntax_check(ty_p == ty + '*');
     }
 
-    di->set_raw_field("ty", ty);
+    di->set_raw_field(RawField::Ty, ty);
 
     //get_word_of(" ,");
 
     value = match_value();
     parser_assert(!value.empty(), "expect a pointer after %s*", ty.c_str());
-    di->set_raw_field("pointer", value);
+    di->set_raw_field(RawField::Pointer, value);
     /* the match_value() may or may not skip the ',' */
     if (_char == ',') {
         inc_intext_pos();
@@ -452,24 +528,24 @@ void InstParser::do_store(Instruction *ins) {
 //    if (_word == "getelementptr") {
 //        GetElementPtrInst* gepi = new GetElementPtrInst();
 //        do_getelementptr(gepi, true);
-//        di->set_raw_field("pointer", gepi->raw_text());
+//        di->set_raw_field(RawField::Pointer, gepi->raw_text());
 //        match(',');
 //    }
 //    else if (_word == "bitcast") {
 //        BitCastInst* bci = new BitCastInst();
 //        do_bitcast(bci, true);
-//        //di->set_raw_field("pointer", bci->get_raw_field("value"));
-//        di->set_raw_field("pointer", bci->raw_text());
-//        di->set_raw_field("final-pointer", bci->get_raw_field("value"));
-//        syntax_check(bci->get_raw_field("ty2") == ty_p);
+//        //di->set_raw_field(RawField::Pointer, bci->get_raw_field(RawField::Value));
+//        di->set_raw_field(RawField::Pointer, bci->raw_text());
+//        di->set_raw_field(RawField::FinalPointer, bci->get_raw_field(RawField::Value));
+//        syntax_check(bci->get_raw_field(RawField::Ty2) == ty_p);
 //        match(',');
 //    }
 //    else {
-//        di->set_raw_field("pointer", _word);  // might do some syntax check on pointer
+//        di->set_raw_field(RawField::Pointer, _word);  // might do some syntax check on pointer
 //    }
 
     //zps(li->raw_text())
-    //zpl("load from %s", li->get_raw_field("pointer").c_str())
+    //zpl("load from %s", li->get_raw_field(RawField::Pointer).c_str())
 
     if (_eol) {
         return;
@@ -477,7 +553,7 @@ void InstParser::do_store(Instruction *ins) {
 
     match(" align ");
     get_word(',');
-    di->set_raw_field("alignment", _word);
+    di->set_raw_field(RawField::Alignment, _word);
     if (_eol) {
         return;
     }
@@ -526,32 +602,32 @@ void InstParser::do_bitcast(Instruction *inst, bool is_embedded) {
     }
 
     string old_ty = parse_compound_type();
-    I->set_raw_field("ty", old_ty);
+    I->set_raw_field(RawField::Ty, old_ty);
     get_word();
 
     if (_word == "bitcast") {
         BitCastInst* embedded_bci = new BitCastInst();
         do_bitcast(embedded_bci, true);
-        //I->set_raw_field("value", embedded_bci->get_raw_field("value"));
-        I->set_raw_field("value", embedded_bci->raw_text());
-        I->set_raw_field("final-value", embedded_bci->get_raw_field("value"));
-        syntax_check(old_ty == embedded_bci->get_raw_field("ty2"));
+        //I->set_raw_field(RawField::Value, embedded_bci->get_raw_field(RawField::Value));
+        I->set_raw_field(RawField::Value, embedded_bci->raw_text());
+        I->set_raw_field(RawField::FinalValue, embedded_bci->get_raw_field(RawField::Value));
+        syntax_check(old_ty == embedded_bci->get_raw_field(RawField::Ty2));
     }
     else if (_word == "getelementptr") {
         GetElementPtrInst* gepi = new GetElementPtrInst();
         do_getelementptr(gepi, true);
-        I->set_raw_field("value", gepi->raw_text());
+        I->set_raw_field(RawField::Value, gepi->raw_text());
     }
     else {
-        I->set_raw_field("value", _word);
+        I->set_raw_field(RawField::Value, _word);
     }
 
     match("to", true);
     string new_ty = parse_compound_type();
-    I->set_raw_field("ty2", new_ty);
+    I->set_raw_field(RawField::Ty2, new_ty);
     if (is_embedded) {
         match(')');
-        I->set_raw_text("bitcast (" + I->get_raw_field("ty") + ' ' + I->get_raw_field("value") + " to " + I->get_raw_field("ty2") + ')');
+        I->set_raw_text("bitcast (" + I->get_raw_field(RawField::Ty) + ' ' + I->get_raw_field(RawField::Value) + " to " + I->get_raw_field(RawField::Ty2) + ')');
     }
 }
 
@@ -572,55 +648,249 @@ void InstParser::do_branch(Instruction *inst) {
     // conditional
     if (_word == "i1") {
         get_word(", label ");
-        inst->set_raw_field("cond", _word);
+        inst->set_raw_field(RawField::Cond, _word);
         get_word(", label ");
-        inst->set_raw_field("true-label", _word);
+        inst->set_raw_field(RawField::TrueLabel, _word);
         get_word_of(" ,");  // may have debug info after ','
-        inst->set_raw_field("false-label", _word);
+        inst->set_raw_field(RawField::FalseLabel, _word);
         
         // get_word(',');
-        // inst->set_raw_field("cond", _word);
+        // inst->set_raw_field(RawField::Cond, _word);
         // match(" label ");
         // get_word(',');
-        // inst->set_raw_field("true-label", _word);
+        // inst->set_raw_field(RawField::TrueLabel, _word);
         // match(" label ");
         // get_word_of(" ,");
-        // inst->set_raw_field("false-label", _word);
+        // inst->set_raw_field(RawField::FalseLabel, _word);
     } // unconditional
     else if (_word == "label") {
         get_word_of(" ,");
-        inst->set_raw_field("true-label", _word);  // unconditional branches only use 'true-label'
+        inst->set_raw_field(RawField::TrueLabel, _word);  // unconditional branches only use 'true-label'
     }
     else {
         syntax_check(0);
     }
 }
 
-void InstParser::do_alloca(Instruction *ins) {
-    get_lookahead();
-    if (_lookahead == "inalloca") {
-        ins->set_raw_field("inalloca", "");
-        jump_ahead();
+/**@brief The text from @param begin to @param end as a reference into the raw text of @param ins
+ *
+ * The text being parsed is a copy of the raw text, so the operands don't need to be
+ * copied again. If the raw text has been changed in the meantime the part is copied.
+ */
+StringRef InstParser::text_ref(Instruction* ins, int begin, int end) {
+    StringRef raw = ins->raw_view();
+    if (!ins->raw_text_is_owned() && raw.size() == _text.size()) {
+        return StringRef(raw.data() + begin, end - begin);
     }
+    return TextArena::current()->copy(_text.data() + begin, end - begin);
+}
 
-    string type = parse_compound_type();
-    match(',');
-    get_lookahead();
-    if (_lookahead != "align") {
-        string type2 = parse_compound_type(); // todo: need more parsing; don't understand type2
-        get_word_of(" ,");
+StringRef InstParser::match_operand_ref(Instruction* ins) {
+    std::pair<int, int> r = skip_operand();
+    return text_ref(ins, r.first, r.second);
+}
+
+StringRef InstParser::parse_type_ref(Instruction* ins) {
+    skip_ws();
+    int begin = _intext_pos;
+    parse_compound_type();
+    int end = std::min(_intext_pos, (int)_text.size());
+    while (end > begin && (_text[end-1] == ' ' || _text[end-1] == '\n')) {
+        end--;
     }
-    match(" align ");
-    get_word_of(" ,");
-    ins->set_raw_field("alignment", _word);
+    return text_ref(ins, begin, end);
 }
 
+/*
+ * <result> = alloca [inalloca] <type> [, <ty> <NumElements>] [, align <alignment>] [, addrspace(<num>)]
+ */
+void InstParser::do_alloca(Instruction *ins) {
+    set_optional_field(ins, RawField::Inalloca);
+    ins->set_raw_field(RawField::Ty, parse_type_ref(ins));
+
+    while (match_operand_separator()) {
+        if (try_match("align ")) {
+            ins->set_raw_field(RawField::Alignment, match_operand_ref(ins));
+        }
+        else if (_char == 'a') {
+            match_operand();  // addrspace(<num>)
+        }
+        else {
+            parse_compound_type();
+            ins->set_raw_field(RawField::NumElements, match_operand_ref(ins));
+        }
+    }
+}
+
+/*
+ * <result> = getelementptr [inbounds] <ty>, <ty>* <ptrval>{, [inrange] <ty> <idx>}*
+ * <result> = getelementptr <ty>, <ptr vector> <ptrval>, <vector index type> <idx>
+ */
 void InstParser::do_getelementptr(Instruction *inst, bool is_embedded) {
-    set_optional_field(inst, "inbounds");
+    set_optional_field(inst, RawField::Inbounds);
     skip_ws();
     if (is_embedded) {
         syntax_check(_char == '(');
         string args = jump_to_end_of_scope();
-        inst->set_raw_text("getelementptr " + inst->get_raw_field("inbounds") + " " + args);
+        inst->set_raw_text("getelementptr " + inst->get_raw_field(RawField::Inbounds) + " " + args);
+        return;
+    }
+
+    GetElementPtrInst* gep = static_cast<GetElementPtrInst*>(inst);
+    gep->set_raw_field(RawField::Ty, parse_type_ref(gep));
+    syntax_check(match_operand_separator());
+    gep->set_raw_field(RawField::Ty2, parse_type_ref(gep));
+    gep->set_raw_field(RawField::Pointer, match_operand_ref(gep));
+
+    while (match_operand_separator()) {
+        try_match("inrange ");
+        StringRef ty = parse_type_ref(gep);
+        gep->append_index(ty, match_operand_ref(gep));
+    }
+}
+
+/*
+ * <result> = phi <ty> [ <val0>, <label0>], ...
+ */
+void InstParser::do_phi(Instruction *ins) {
+    PhiInst* phi = static_cast<PhiInst*>(ins);
+    phi->set_raw_field(RawField::Ty, parse_type_ref(phi));
+
+    do {
+        skip_ws();
+        syntax_check(_char == '[');
+        int begin = _intext_pos;
+        jump_to_end_of_scope();
+        int end = std::min(_intext_pos, (int)_text.size()) - 1;  // the ']'
+        int comma = (int)_text.rfind(',', end);  // the value may be a constant expression with ','s, the label has none
+        parser_assert(comma > begin, "expect [ <value>, <label> ] in phi");
+
+        int vb = (int)_text.find_first_not_of(' ', begin + 1);
+        int ve = (int)_text.find_last_not_of(' ', comma - 1) + 1;
+        int lb = (int)_text.find_first_not_of(' ', comma + 1);
+        int le = (int)_text.find_last_not_of(' ', end - 1) + 1;
+        phi->append_incoming(text_ref(phi, vb, ve), text_ref(phi, lb, le));
+    } while (match_operand_separator());
+}
+
+/*
+ * <result> = icmp <cond> <ty> <op1>, <op2>
+ * <result> = fcmp [fast-math flags]* <cond> <ty> <op1>, <op2>
+ */
+void InstParser::do_cmp(Instruction *ins) {
+    CmpInst* ci = static_cast<CmpInst*>(ins);
+    set_fastmath(ci);
+    std::pair<int, int> pred = skip_word();
+    ci->set_raw_field(RawField::Predicate, text_ref(ci, pred.first, pred.second));
+    ci->set_raw_field(RawField::Ty, parse_type_ref(ci));
+    ci->set_raw_field(RawField::Lhs, match_operand_ref(ci));
+    syntax_check(match_operand_separator());
+    ci->set_raw_field(RawField::Rhs, match_operand_ref(ci));
+}
+
+/*
+ * <result> = add [nuw] [nsw] <ty> <op1>, <op2>
+ * <result> = fadd [fast-math flags]* <ty> <op1>, <op2>
+ * <result> = udiv [exact] <ty> <op1>, <op2>
+ */
+void InstParser::do_binary(Instruction *ins) {
+    BinaryInst* bi = static_cast<BinaryInst*>(ins);
+    while (true) {
+        get_lookahead();
+        if (_lookahead == "nuw") {
+            bi->set_raw_field(RawField::Nuw, _lookahead);
+        }
+        else if (_lookahead == "nsw") {
+            bi->set_raw_field(RawField::Nsw, _lookahead);
+        }
+        else if (_lookahead == "exact") {
+            bi->set_raw_field(RawField::Exact, _lookahead);
+        }
+        else if (IRFlags::is_fastmath_flag(_lookahead)) {
+            bi->set_raw_field(RawField::FastMath, _lookahead);
+        }
+        else {
+            break;
+        }
+        jump_ahead();
+    }
+
+    bi->set_raw_field(RawField::Ty, parse_type_ref(bi));
+    bi->set_raw_field(RawField::Lhs, match_operand_ref(bi));
+    syntax_check(match_operand_separator());
+    bi->set_raw_field(RawField::Rhs, match_operand_ref(bi));
+}
+
+/*
+ * <result> = sext <ty> <value> to <ty2>
+ */
+void InstParser::do_cast(Instruction *ins) {
+    CastInst* ci = static_cast<CastInst*>(ins);
+    ci->set_raw_field(RawField::Ty, parse_type_ref(ci));
+
+    /* the value may be a constant expression, the " to " we want is not nested */
+    int begin = _intext_pos;
+    int end = begin;
+    while (!_eol && _text.compare(_intext_pos, 4, " to ") != 0) {
+        if (_char == '(' || _char == '[' || _char == '{' || _char == '<') {
+            jump_to_end_of_scope();
+        }
+        else {
+            inc_intext_pos();
+        }
+        end = _intext_pos;
+    }
+    parser_assert(!_eol, "expect ' to ' in a cast");
+    ci->set_raw_field(RawField::Value, text_ref(ci, begin, end));
+    inc_intext_pos(4);
+    ci->set_raw_field(RawField::Ty2, parse_type_ref(ci));
+}
+
+/*
+ * ret <type> <value>
+ * ret void
+ */
+void InstParser::do_return(Instruction *ins) {
+    ReturnInst* ri = static_cast<ReturnInst*>(ins);
+    StringRef ty = parse_type_ref(ri);
+    ri->set_raw_field(RawField::Ty, ty);
+    if (!ty.equals("void", 4)) {
+        ri->set_raw_field(RawField::Value, match_operand_ref(ri));
+    }
+}
+
+/*
+ * switch <intty> <value>, label <defaultdest> [ <intty> <val>, label <dest> ... ]
+ */
+void InstParser::do_switch(Instruction *ins) {
+    SwitchInst* si = static_cast<SwitchInst*>(ins);
+    si->set_raw_field(RawField::Ty, parse_type_ref(si));
+    si->set_raw_field(RawField::Value, match_operand_ref(si));
+    syntax_check(match_operand_separator());
+    match("label ");
+    std::pair<int, int> dest = skip_word();
+    si->set_raw_field(RawField::DefaultLabel, text_ref(si, dest.first, dest.second));
+
+    skip_ws();
+    if (_eol || _char != '[') {
+        return;
+    }
+    inc_intext_pos();
+
+    /* the cases are "<intty> <val>, label <dest>", separated by whitespace */
+    while (true) {
+        skip_ws();
+        if (_eol || _char == ']') {
+            break;
+        }
+        parse_compound_type();
+        std::pair<int, int> val = skip_operand();
+        match(',');
+        match("label", true);
+        std::pair<int, int> label = skip_word();
+        si->append_case(text_ref(si, val.first, val.second), text_ref(si, label.first, label.second));
+    }
+    if (!_eol) {
+        inc_intext_pos();
     }
 }
@@ -24,7 +24,8 @@ public:
 
 
     void parse_function_pointer_type();
-    Instruction* create_instruction(string &text);
+    Instruction* create_instruction(const string& text, StringRef raw=StringRef());
+    static string opcode_classes();
     void parse_metadata(Instruction* ins);
     void skip_to_metadata();
 
@@ -36,6 +37,18 @@ public:
     void do_store(Instruction* ins);
     void do_bitcast(Instruction* ins, bool is_embedded=false);
     void do_getelementptr(Instruction* ins, bool is_embedded=false);
+    void do_phi(Instruction* ins);
+    void do_cmp(Instruction* ins);
+    void do_binary(Instruction* ins);
+    void do_cast(Instruction* ins);
+    void do_return(Instruction* ins);
+    void do_switch(Instruction* ins);
+
+    /* operands as references into the raw text of the instruction being parsed, which may be
+     * the mapped input; Shadow says why that stays valid */
+    StringRef text_ref(Instruction* ins, int begin, int end);
+    StringRef match_operand_ref(Instruction* ins);
+    StringRef parse_type_ref(Instruction* ins);
 
 
     //static void parse_instruction(Instruction** ip);
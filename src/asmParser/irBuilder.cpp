@@ -179,7 +179,7 @@ GlobalVariable* IRBuilder::add_global_string(Module *m, const string& s) {
 
     auto gv = new GlobalVariable();
     gv->set_name(name);
-    gv->set_raw_field("type", type);
+    gv->set_raw_field(RawField::Type, type);
     gv->set_raw_text(text);
     m->add_global_variable(gv);
     return gv;
@@ -192,7 +192,7 @@ GlobalVariable* IRBuilder::add_global_string(Module *m, const string& s) {
  * %4 = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([6 x i8], [6 x i8]* @.sopt.0, i32 0, i32 0))
  */
 CallInst* IRBuilder::create_printf_callinst(Module* m, GlobalVariable* gv, string args) {
-    string ty = gv->get_raw_field("type");
+    string ty = gv->get_raw_field(RawField::Type);
     string text = get_new_local_varname() + " = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ("
         + ty + ", " + ty + "* " + gv->name() + ", i32 0, i32 0)";
     if (!args.empty()) {
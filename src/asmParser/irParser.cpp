@@ -2,6 +2,8 @@
 // Created by tzhou on 9/17/17.
 //
 
+#include <algorithm>
+#include <cstring>
 #include <asmParser/instFlags.h>
 #include <ir/instruction.h>
 #include "irParser.h"
@@ -404,10 +406,81 @@ string IRParser::parse_complex_structs() {
     return '%' + name;
 }
 
-void IRParser::set_optional_field(Value *v, string field) {
+/**@brief Skip a word, which ends at whitespace, ',' or a bracket
+ *
+ * @return The begin and end position of the word
+ */
+std::pair<int, int> IRParser::skip_word() {
+    skip_ws();
+    int begin = std::min(_intext_pos, (int)_text.size());
+    while (!_eol && !strchr(" \t\n,[]()", _char)) {
+        inc_intext_pos();
+    }
+    return std::make_pair(begin, std::min(_intext_pos, (int)_text.size()));
+}
+
+/**@brief Skip one operand, which is everything up to the next ',' that is not nested in
+ * brackets or quotes, or up to the end of the text. The ',' itself is not skipped.
+ *
+ * @return The begin and end position of the operand, without the whitespace around it
+ */
+std::pair<int, int> IRParser::skip_operand() {
+    skip_ws();
+    int begin = std::min(_intext_pos, (int)_text.size());
+    int end = begin;
+    while (!_eol && _char != ',') {
+        if (_char == '(' || _char == '[' || _char == '{' || _char == '<') {
+            jump_to_end_of_scope();
+        }
+        else if (_char == '"') {
+            inc_intext_pos();
+            while (!_eol && _char != '"') {
+                inc_intext_pos();
+            }
+            if (!_eol) {
+                inc_intext_pos();
+            }
+        }
+        else {
+            bool ws = _char == ' ' || _char == '\t' || _char == '\n';
+            inc_intext_pos();
+            if (ws) {
+                continue;
+            }
+        }
+        end = std::min(_intext_pos, (int)_text.size());
+    }
+    return std::make_pair(begin, end);
+}
+
+string IRParser::match_operand() {
+    std::pair<int, int> r = skip_operand();
+    return _text.substr(r.first, r.second - r.first);
+}
+
+/**@brief Skip the ',' in front of the next operand if there is one
+ *
+ * A ',' followed by metadata (", !dbg !12") is left for the metadata parser.
+ *
+ * @return Whether another operand follows
+ */
+bool IRParser::match_operand_separator() {
+    if (_eol || _char != ',') {
+        return false;
+    }
+    size_t next = _text.find_first_not_of(" \t\n", _intext_pos + 1);
+    if (next == string::npos || _text[next] == '!') {
+        return false;
+    }
+    inc_intext_pos();
+    skip_ws();
+    return true;
+}
+
+void IRParser::set_optional_field(Value *v, RawField::Key field) {
     get_lookahead();
-    if (_lookahead == field) {
-        v->set_raw_field(field, field);
+    if (_lookahead == RawField::name(field)) {
+        v->set_raw_field(field, _lookahead);
         jump_ahead();
     }
 }
@@ -419,7 +492,7 @@ void IRParser::set_optional_field(Value *v, string field) {
 void IRParser::set_cconv(Value *v) {
     get_lookahead();
     if (IRFlags::is_cconv_flag(_lookahead)) {
-        v->set_raw_field("cconv", _lookahead);
+        v->set_raw_field(RawField::Cconv, _lookahead);
         jump_ahead();
     }
 }
@@ -427,7 +500,7 @@ void IRParser::set_cconv(Value *v) {
 void IRParser::set_tail(Value *v) {
     get_lookahead();
     if (IRFlags::is_tail_flag(_lookahead)) {
-        v->set_raw_field("tail", _lookahead);
+        v->set_raw_field(RawField::Tail, _lookahead);
         jump_ahead();
     }
 }
@@ -435,7 +508,7 @@ void IRParser::set_tail(Value *v) {
 void IRParser::set_fastmath(Value *v) {
     get_lookahead();
     if (IRFlags::is_fastmath_flag(_lookahead)) {
-        v->set_raw_field("fast-math", _lookahead);
+        v->set_raw_field(RawField::FastMath, _lookahead);
         jump_ahead();
     }
 }
@@ -443,7 +516,7 @@ void IRParser::set_fastmath(Value *v) {
 void IRParser::set_linkage(Value *v) {
     get_lookahead();
     if (IRFlags::is_linkage_flag(_lookahead)) {
-        v->set_raw_field("linkage", _lookahead);
+        v->set_raw_field(RawField::Linkage, _lookahead);
         jump_ahead();
     }
 }
@@ -451,7 +524,7 @@ void IRParser::set_linkage(Value *v) {
 void IRParser::set_visibility(Value *v) {
     get_lookahead();
     if (IRFlags::is_visibility_flag(_lookahead)) {
-        v->set_raw_field("visibility", _lookahead);
+        v->set_raw_field(RawField::Visibility, _lookahead);
         jump_ahead();
     }
 }
@@ -459,14 +532,14 @@ void IRParser::set_visibility(Value *v) {
 void IRParser::set_dll_storage_class(Value *v) {
     get_lookahead();
     if (IRFlags::is_dll_storage_class_flag(_lookahead)) {
-        v->set_raw_field("visibility", _lookahead);
+        v->set_raw_field(RawField::Visibility, _lookahead);
         jump_ahead();
     }
 }
 
 void IRParser::set_param_attrs(Value *v) {
     get_lookahead();
-    string flag = "param-attrs";
+    RawField::Key flag = RawField::ParamAttrs;
     while (IRFlags::is_param_attr_flag(_lookahead)) {
         if (!v->has_raw_field(flag)) {
             v->set_raw_field(flag, _lookahead);
@@ -486,7 +559,7 @@ void IRParser::set_ret_attrs(Value *v) {
     //          "Only ‘zeroext‘, ‘signext‘, and ‘inreg‘ attributes are valid here for return type");
 
     get_lookahead();
-    string flag = "ret-attrs";
+    RawField::Key flag = RawField::RetAttrs;
     while (IRFlags::is_param_attr_flag(_lookahead)) {
         if (!v->has_raw_field(flag)) {
             v->set_raw_field(flag, _lookahead);
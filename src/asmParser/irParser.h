@@ -6,6 +6,7 @@
 #define LLPARSER_LLASMPARSER_H
 
 #include <peripheral/stringParser.h>
+#include <ir/rawField.h>
 
 class Value;
 
@@ -30,7 +31,12 @@ public:
     string parse_compound_type();
     string parse_complex_structs();
 
-    void set_optional_field(Value* v, string field);  // fields that have no value
+    std::pair<int, int> skip_word();
+    std::pair<int, int> skip_operand();
+    string match_operand();
+    bool match_operand_separator();
+
+    void set_optional_field(Value* v, RawField::Key field);  // fields that have no value
     //void set_optional_field(Value* v, string field, string value);
     void set_fastmath(Value* v);
     void set_tail(Value* v);
@@ -14,10 +14,14 @@
 #include <inst/instEssential.h>
 #include <passes/passManager.h>
 #include <utilities/flags.h>
+#include <utilities/textArena.h>
+#include <utilities/workerPool.h>
+#include <utilities/profiler.h>
 #include "irBuilder.h"
 #include "llParser.h"
 #include "instParser.h"
 #include "sysDict.h"
+#include "snapshot.h"
 
 
 // class InstStats
@@ -69,7 +73,7 @@ void LLParser::initialize() {
 }
 
 void LLParser::parse_header(Module* module) {
-    assert(_ifs.is_open() && "file not open, can't parse");
+    assert(is_open() && "file not open, can't parse");
 
     MAX_LINE_LEN = 4096;
     MAX_VALUE_LEN = 1024;
@@ -115,7 +119,7 @@ void LLParser::parse_header(Module* module) {
 void LLParser::parse_module_level_asms() {
     while (true) {
         if (Strings::startswith(line(), "module asm")) {
-            SysDict::module()->add_module_level_asm(line());
+            module()->add_module_level_asm(line());
         }
         else {
             break;
@@ -129,7 +133,7 @@ void LLParser::parse_structs(Module* module) {
     while (true) {
         if (line()[0] == '%') {
             StructType* st = new StructType();
-            st->set_raw_text(line());
+            st->set_raw_text(raw_line());
             module->add_struct_type(st);
 
             /* get name */
@@ -147,11 +151,11 @@ void LLParser::parse_structs(Module* module) {
 }
 
 void LLParser::parse_comdats() {
-    Module* module = SysDict::module();
+    Module* module = this->module();
     while (_char == '$') {
         module->set_language(Module::Language::cpp); //todo: not sure if this is a good way to do it
         Comdat* value = new Comdat();
-        value->set_raw_text(line());
+        value->set_raw_text(raw_line());
         module->add_comdat(value);
         get_real_line();
     }
@@ -179,7 +183,7 @@ GlobalVariable* LLParser::parse_global(Module * module) {
     if (_word == "alias") {
         return NULL;
     }
-    gv->set_raw_text(line());
+    gv->set_raw_text(raw_line());
     module->add_global_variable(gv);
     return gv;
 }
@@ -207,7 +211,7 @@ void LLParser::parse_aliases() {
         guarantee(_word == "=", " ");
         get_word();
         if (IRFlags::is_linkage_flag(_word)) {
-            alias->set_raw_field("linkage", _word);
+            alias->set_raw_field(RawField::Linkage, _word);
             get_word();
         }
 
@@ -230,7 +234,7 @@ void LLParser::parse_aliases() {
 
         match('@');
         get_word();
-        alias->set_raw_field("aliasee", _word);
+        alias->set_raw_field(RawField::Aliasee, _word);
         if (has_bitcast) {
             match("to");
             parse_compound_type();
@@ -239,15 +243,15 @@ void LLParser::parse_aliases() {
 
         parser_assert(_eol, "should be end of line");
 
-        alias->set_raw_text(line());
-        SysDict::module()->add_alias(alias->name(), alias);
+        alias->set_raw_text(raw_line());
+        module()->add_alias(alias->name(), alias);
         get_real_line();
     }
 }
 
 void LLParser::parse_functions() {
     while (true) {
-        if (!_ifs) {
+        if (!good()) {
             if (!NoParserWarning) {
                 fprintf(stderr, "WARNING: Reached end-of-file during function parsing\n");
             }
@@ -256,10 +260,10 @@ void LLParser::parse_functions() {
         // should either start with 'declare' or 'define'
         guarantee(!line().empty(), "");
         if (line()[2] == 'f') {
-            parse_function_definition();
+            module()->append_new_function(parse_function_definition());
         }
         else if (line()[2] == 'c') {
-            parse_function_declaration();
+            module()->append_new_function(parse_function_declaration());
         }
         else {
             break;
@@ -269,6 +273,243 @@ void LLParser::parse_functions() {
     }
 }
 
+/**@brief Parse, transform and print the functions one at a time, then the rest of the module
+ *
+ * Each function is parsed, handed to the function and basic block passes, written
+ * to @param output and freed before the next one is parsed, so memory use is bounded
+ * by the largest function rather than the whole module. Calls are not resolved,
+ * which is fine for function-local passes. The raw text created for a function goes
+ * to a scratch arena that is reset after the function is freed.
+ */
+void LLParser::stream_functions(PassManager* pm, const string& output) {
+    ScopedPhase phase("stream_functions");
+    module()->begin_streaming(output);
+    /* passes may create functions through SysDict::parser, which overwrites the current line */
+    string first = line();
+    pm->begin_streaming(module());
+    set_text(first);
+
+    TextArena scratch;
+    while (good()) {
+        guarantee(!line().empty(), "");
+        const char* begin = line_begin();
+        Function* func = NULL;
+        TextArena::set_current(&scratch);
+        {
+            TextArena::ObjectScope objects(&scratch);
+            if (line()[2] == 'f') {
+                func = parse_function_header();
+                parse_function_body(func);
+            }
+            else if (line()[2] == 'c') {
+                func = parse_function_declaration();
+            }
+            else {
+                break;
+            }
+        }
+
+        /* what the passes create may outlive the function, it goes to the module */
+        TextArena::set_current(&module()->text_arena());
+        TextArena::ObjectScope objects(NULL);
+        module()->append_new_function(func);
+        pm->apply_passes(func);
+        module()->stream_function(func);
+        scratch.reset();
+        if (is_mapped()) {
+            _mapped->release(begin, _map_pos);
+        }
+
+        get_real_line();
+    }
+    TextArena::set_current(&module()->text_arena());
+
+    parse_attributes(module());
+    parse_metadatas(module());
+    module()->resolve_debug_info();
+
+    pm->end_streaming(module());
+    /* in case no pass printed the module */
+    module()->end_streaming();
+}
+
+/**@brief A run of whole lines of the mapped input that is parsed by a worker
+ *
+ * A slice contains either whole functions or metadata lines. What the worker
+ * parses is kept in the slice and added to the module by the main parser in
+ * the original order.
+ */
+struct ParseSlice {
+    const char* begin;
+    const char* end;
+    long long line_before;  // line number of the line before begin
+    TextArena arena;
+    std::vector<Function*> functions;
+    std::vector<std::pair<string, MetaData*> > metadata;
+};
+
+static const char* end_of_line(const char* p, const char* end) {
+    const char* nl = (const char*)memchr(p, '\n', end - p);
+    return nl ? nl : end;
+}
+
+static bool line_startswith(const char* p, const char* eol, const char* prefix) {
+    size_t n = strlen(prefix);
+    return (size_t)(eol - p) >= n && memcmp(p, prefix, n) == 0;
+}
+
+/**@brief Split the section that starts at the current line into slices
+ *
+ * With @param functions the section is a run of function declarations and
+ * definitions, slices are cut between functions. Otherwise it is a run of
+ * metadata lines. Comment and empty lines are included. Slices are cut to be
+ * about the same size in bytes.
+ *
+ * The parser is moved to the first line after the section.
+ */
+void LLParser::scan_slices(std::vector<ParseSlice*>& slices, bool functions, int nslices) {
+    const char* end = _map_end;
+    const char* p = line_begin();
+    long long line = _line_number - 1;
+
+    /* find the first line of each entity, and the end of the section */
+    std::vector<const char*> starts;
+    std::vector<long long> lines;
+    while (p < end) {
+        const char* eol = end_of_line(p, end);
+        if (eol == p || *p == ';') {
+            p = eol + 1;
+            line++;
+            continue;
+        }
+
+        bool is_define = functions && line_startswith(p, eol, "define");
+        bool is_declare = functions && line_startswith(p, eol, "declare");
+        if (functions ? !(is_define || is_declare) : *p != '!') {
+            break;
+        }
+
+        starts.push_back(p);
+        lines.push_back(line);
+        p = eol + 1;
+        line++;
+
+        /* a function body ends with a line that starts with '}' */
+        if (is_define) {
+            while (p < end && *p != '}') {
+                p = end_of_line(p, end) + 1;
+                line++;
+            }
+            if (p < end) {
+                p = end_of_line(p, end) + 1;
+                line++;
+            }
+        }
+    }
+    if (p > end) {
+        p = end;
+    }
+
+    if (!starts.empty()) {
+        size_t target = (p - starts[0]) / nslices + 1;
+        size_t first = 0;
+        for (size_t i = 1; i <= starts.size(); ++i) {
+            const char* next = i < starts.size() ? starts[i] : p;
+            if ((size_t)(next - starts[first]) >= target || i == starts.size()) {
+                ParseSlice* slice = new ParseSlice();
+                slice->begin = starts[first];
+                slice->end = next;
+                slice->line_before = lines[first];
+                slices.push_back(slice);
+                first = i;
+            }
+        }
+    }
+
+    seek_mapped(p, line);
+    get_real_line();
+}
+
+/**@brief Parse a slice found by scan_slices(), this runs on a worker thread
+ *
+ * Uses a fresh LLParser on the same mapping and the arena of the slice,
+ * nothing is added to @param module.
+ */
+void LLParser::parse_slice(Module* module, ParseSlice* slice) {
+    ScopedPhase phase("parse_slice");
+    ModuleContext context(module);
+    TextArena::set_current(&slice->arena);
+    TextArena::ObjectScope objects(&slice->arena);
+
+    LLParser worker;
+    worker._module = module;
+    worker.open_slice(_mapped, slice->begin, slice->end, slice->line_before);
+    worker.get_real_line();
+
+    string name;
+    while (worker.good()) {
+        const string& l = worker.line();
+        if (l[0] == '!') {
+            MetaData* data = worker.parse_metadata(name);
+            slice->metadata.push_back(std::make_pair(name, data));
+        }
+        else if (l[2] == 'f') {
+            slice->functions.push_back(worker.parse_function_definition());
+        }
+        else {
+            slice->functions.push_back(worker.parse_function_declaration());
+        }
+        worker.get_real_line();
+    }
+
+    TextArena::set_current(NULL);
+}
+
+/**@brief Parse the functions, attributes and metadata of the input, using a pool of threads
+ *
+ * The main parser scans the function section and the metadata section for slice
+ * boundaries without parsing them and hands the slices to the workers. Attributes
+ * are parsed here in the meantime. The results are added to @param module in the
+ * original order, so the module is the same as if it was parsed serially.
+ */
+void LLParser::parse_sections_in_parallel(Module* module) {
+    WorkerPool pool(ParsingThreads);
+    int nslices = pool.size() * 4;
+    std::vector<ParseSlice*> slices;
+
+    if (good()) {
+        scan_slices(slices, true, nslices);
+    }
+    size_t function_slices = slices.size();
+    for (auto slice: slices) {
+        pool.submit(std::bind(&LLParser::parse_slice, this, module, slice));
+    }
+
+    parse_attributes(module);
+
+    if (good() && line()[0] == '!') {
+        scan_slices(slices, false, nslices);
+    }
+    for (size_t i = function_slices; i < slices.size(); ++i) {
+        pool.submit(std::bind(&LLParser::parse_slice, this, module, slices[i]));
+    }
+
+    pool.wait();
+
+    for (auto slice: slices) {
+        for (auto F: slice->functions) {
+            module->append_new_function(F);
+        }
+        for (auto& md: slice->metadata) {
+            add_metadata(module, md.second, md.first);
+        }
+        module->text_arena().adopt(&slice->arena);
+        delete slice;
+    }
+
+    guarantee(eof(), "should be end of file, line: %d", line_number());
+}
+
 /*
  * Function Syntax
  * define [linkage] [visibility] [DLLStorageClass]
@@ -365,7 +606,7 @@ Function* LLParser::create_function(string &text) {
         len--;
     }
     Function* func = new Function();
-    set_line(text.substr(0, len));
+    set_text(text.data(), len);
     get_word();
     if (_word == "declare") {
         func->set_is_external();
@@ -423,13 +664,31 @@ Function* LLParser::create_function(string &text) {
                name.c_str(), params.c_str());
     }
 
-    func->set_raw_text(line());
+    func->set_raw_text(raw_line());
     return func;
 }
 
-void LLParser::parse_function_definition() {
+/**@brief Parse a function definition starting from the current line
+ *
+ * The function is not added to the module.
+ */
+Function* LLParser::parse_function_definition() {
     Function* func = parse_function_header();
-    SysDict::module()->append_new_function(func);
+    /* the body can only be parsed later if the mapping stays around */
+    if (LazyParsing && mapping_is_shared()) {
+        skip_function_body(func);
+    }
+    else {
+        parse_function_body(func);
+    }
+    return func;
+}
+
+/**@brief Parse the basic blocks of @param func, the current line is the function header
+ *
+ * Stops at the closing '}', which becomes the current line.
+ */
+void LLParser::parse_function_body(Function* func) {
     get_real_line();
     /* parse basic blocks */
     while (1) {
@@ -454,8 +713,44 @@ void LLParser::parse_function_definition() {
     }
 }
 
+/**@brief Record where the body of @param func is instead of parsing it
+ *
+ * Only the line boundaries are looked at. The body is parsed by Function::materialize()
+ * when it is first accessed. The closing '}' becomes the current line, as with
+ * parse_function_body().
+ */
+void LLParser::skip_function_body(Function* func) {
+    const char* begin = _map_pos;
+    const char* p = begin;
+    long long line = _line_number;
+    while (p < _map_end && *p != '}') {
+        const char* nl = (const char*)memchr(p, '\n', _map_end - p);
+        parser_assert(nl, "function body is not closed");
+        p = nl + 1;
+        line++;
+    }
+    parser_assert(p < _map_end, "function body is not closed");
+
+    const char* nl = (const char*)memchr(p, '\n', _map_end - p);
+    const char* end = nl ? nl + 1 : _map_end;
+    func->set_lazy_body(new LazyBody{_mapped, begin, end, _line_number});
+
+    seek_mapped(p, line);
+    getline();
+}
+
+/**@brief Parse the body recorded by skip_function_body() into @param func
+ *
+ * This parser must be fresh, it reads the body directly from the mapping.
+ */
+void LLParser::parse_lazy_body(Function* func, LazyBody* body) {
+    open_slice(body->file, body->begin, body->end, body->line_before);
+    parse_function_body(func);
+    close();
+}
+
 void LLParser::parse_basic_block_header(BasicBlock *bb, bool use_comment) {
-    bb->set_raw_text(line());
+    bb->set_raw_text(raw_line());
 
     // get label
     const string label_start = "; <label>:";
@@ -485,8 +780,11 @@ void LLParser::parse_basic_block_header(BasicBlock *bb, bool use_comment) {
 }
 
 void LLParser::remove_tail_comments() {
-    int pos = line().find(';');
-    set_line(line().substr(0, pos));
+    size_t pos = line().find(';');
+    if (pos != string::npos) {
+        line().resize(pos);
+    }
+    rewind();
 }
 
 void LLParser::parse_basic_block(BasicBlock* bb) {
@@ -550,10 +848,8 @@ void LLParser::parse_basic_block(BasicBlock* bb) {
 //            inst->append_raw_text(dbg_text);
 //        }
 
-        string opcode = inst->opcode();
-
-        //zpl("opcode: %s", opcode.c_str())
-        if (IRFlags::is_terminator_inst(opcode)) {
+        //zpl("opcode: %s", inst->opcode().c_str())
+        if (IRFlags::is_terminator_inst(inst->opcode_symbol())) {
             break;
         }
 
@@ -561,27 +857,46 @@ void LLParser::parse_basic_block(BasicBlock* bb) {
     }
 }
 
+/**@brief The current line as raw text for a Shadow
+ *
+ * Refers to the mapped input file when possible, otherwise the line is copied
+ * into the arena of the module being parsed.
+ */
+StringRef LLParser::raw_line() {
+    StringRef ref = line_ref();
+    if (ref.is_null()) {
+        ref = TextArena::current()->copy(line());
+    }
+    return ref;
+}
+
 /* some instruction takes more than one line */
 void LLParser::set_line_to_full_instruction() {
 //    if (line().find("switch i8 %phitmp") != line().npos) {
 //        zpl("%s", line().c_str());
 //        exit(0);
 //    }
-    string full = line();
+    /* most instructions take one line, which is already the current text */
     if (Strings::endswith(line(), "[") && Strings::startswith(line(), "switch")) {
+        string full = line();
         do {
             full += '\n';
             get_real_line();
             full += line();
         } while (!Strings::startswith(line(), "]"));
+        set_line(full);
     }
     else if (Strings::contains(line(), " invoke ")) {
+        string full = line();
         full += '\n';
         get_real_line();
         parser_assert(Strings::startswith(line(), "to"), "invalid invoke inst");
         full += line();
+        set_line(full);
+    }
+    else {
+        rewind();
     }
-    set_line(full);
 }
 
 void LLParser::parse_debug_info(Instruction* inst) {
@@ -597,9 +912,9 @@ void LLParser::parse_debug_info(Instruction* inst) {
 
 Instruction* LLParser::parse_instruction_line(BasicBlock *bb) {
     // inst will be appended to bb
-    Instruction* inst = IRBuilder::create_instruction(line(), this);
+    Instruction* inst = inst_parser()->create_instruction(line(), raw_line());
     bb->append_instruction(inst);  // now parsing the instruction shouldn't need bb's info (data flow)
-    inst->set_owner(bb->parent()->name());  // todo: only for debug use, this _owner will not change when the owner's name changes
+    inst->set_owner(bb->parent()->name_symbol());  // todo: only for debug use, this _owner will not change when the owner's name changes
 
 #ifdef LLDEBUG
     //_stats.collect_inst_stats(inst);
@@ -623,9 +938,8 @@ Instruction* LLParser::parse_instruction_line(BasicBlock *bb) {
 //}
 
 
-void LLParser::parse_function_declaration() {
-    Function* func = parse_function_header();
-    SysDict::module()->append_new_function(func);
+Function* LLParser::parse_function_declaration() {
+    return parse_function_header();
 }
 
 void LLParser::parse_attributes(Module *module) {
@@ -633,10 +947,10 @@ void LLParser::parse_attributes(Module *module) {
         module->unnamed_metadata_list().reserve(4096);
     }
 
-    while (_ifs && Strings::startswith(line(), "attributes")) {
+    while (good() && Strings::startswith(line(), "attributes")) {
         Attribute* attr = new Attribute();
         module->append_attribute(attr);
-        attr->set_raw_text(line());
+        attr->set_raw_text(raw_line());
 
         get_real_line();
     }
@@ -644,67 +958,95 @@ void LLParser::parse_attributes(Module *module) {
 }
 
 void LLParser::parse_metadatas(Module *module) {
-    while (_ifs && line()[0] == '!') {
-        inc_inline_pos();
-        get_word();
-        MetaData* data;
-        if (!Strings::is_number(_word)) {
+    string name;
+    while (good() && line()[0] == '!') {
+        MetaData* data = parse_metadata(name);
+        add_metadata(module, data, name);
+        get_real_line();
+    }
+
+    guarantee(eof(), "should be end of file, line: %d", line_number());
+    //zpl("Module %s: end of file, total: %d", module->name_as_c_str(), _line_number);
+}
+
+/**@brief Parse the metadata on the current line without adding it to a module
+ *
+ * @param name: set to the name of a named metadata, cleared for an unnamed one,
+ * whose number is set to the id in the text
+ */
+MetaData* LLParser::parse_metadata(string& name) {
+    inc_inline_pos();
+    get_word();
+    MetaData* data;
+    if (!Strings::is_number(_word)) {
+        data = new MetaData();
+        name = _word;
+    }
+    else {
+        name.clear();
+        int id = std::stoi(_word);
+
+        get_word('!');
+        if (_char == '{') {
             data = new MetaData();
-            module->set_named_metadata(_word, data);
         }
         else {
-            if (!UseSplitModule) {
-                guarantee(std::stoi(_word) == module->unnamed_metadata_list().size(), "bad dbg id numbering");
+            get_word('(');
+            if (_word == "DIFile") {
+                data = new DIFile();
+                parse_di_fields(data);
+                //data = parse_difile();
             }
-
-            get_word('!');
-            if (_char == '{') {
-                data = new MetaData();
+            else if (_word == "DISubprogram") {
+                //data = parse_disubprogram();
+                data = new DISubprogram();
+                parse_di_fields(data);
+            }
+            else if (_word == "DILexicalBlock") {
+                //data = parse_dilexicalblock();
+                data = new DILexicalBlock();
+                parse_di_fields(data);
+            }
+            else if (_word == "DILexicalBlockFile") {
+                //data = parse_dilexicalblockfile();
+                data = new DILexicalBlockFile();
+                parse_di_fields(data);
+            }
+            else if (_word == "DILocation") {
+                //data = parse_dilocation();
+                data = new DILocation();
+                parse_di_fields(data);
             }
             else {
-                get_word('(');
-                if (_word == "DIFile") {
-                    data = new DIFile();
-                    parse_di_fields(data);
-                    //data = parse_difile();
-                }
-                else if (_word == "DISubprogram") {
-                    //data = parse_disubprogram();
-                    data = new DISubprogram();
-                    parse_di_fields(data);
-                }
-                else if (_word == "DILexicalBlock") {
-                    //data = parse_dilexicalblock();
-                    data = new DILexicalBlock();
-                    parse_di_fields(data);
-                }
-                else if (_word == "DILexicalBlockFile") {
-                    //data = parse_dilexicalblockfile();
-                    data = new DILexicalBlockFile();
-                    parse_di_fields(data);
-                }
-                else if (_word == "DILocation") {
-                    //data = parse_dilocation();
-                    data = new DILocation();
-                    parse_di_fields(data);
-                }
-                else {
-                    data = new MetaData();
-                }
+                data = new MetaData();
             }
-
-            data->set_number(module->unnamed_metadata_list().size());
-            module->append_unnamed_metadata(data);
         }
 
-        data->set_raw_text(line());
-        data->set_parent(module);
-        data->resolve_non_refs();
-        get_real_line();
+        data->set_number(id);
     }
 
-    guarantee(_ifs.eof(), "should be end of file, line: %d", line_number());
-    //zpl("Module %s: end of file, total: %d", module->name_as_c_str(), _line_number);
+    data->set_raw_text(raw_line());
+    data->resolve_non_refs();
+    return data;
+}
+
+/**@brief Add a metadata returned by parse_metadata() to @param module
+ *
+ * Unnamed metadata must be added in the order of their ids.
+ */
+void LLParser::add_metadata(Module* module, MetaData* data, const string& name) {
+    if (!name.empty()) {
+        module->set_named_metadata(name, data);
+    }
+    else {
+        if (!UseSplitModule) {
+            guarantee(data->number() == module->unnamed_metadata_list().size(), "bad dbg id numbering");
+        }
+
+        data->set_number(module->unnamed_metadata_list().size());
+        module->append_unnamed_metadata(data);
+    }
+    data->set_parent(module);
 }
 
 void LLParser::parse_di_fields(MetaData* data)  {
@@ -736,8 +1078,7 @@ Module* LLParser::parse() {
  *    the next parsing phase will start from _line
  * 2. empty line is always skipped since they should not have meaning
  */
-    _ifs.open(_file_name.c_str());
-    if (!_ifs.is_open()) {
+    if (!open(_file_name)) {
       if (!Strings::contains(_file_name, "/include/c++/")) {
         fprintf(stderr, "open file %s failed.\n", _file_name.c_str());
       }
@@ -749,17 +1090,65 @@ Module* LLParser::parse() {
     _module->set_input_file(filename());
     SysDict::add_module(module());
 
+    /* raw text of this module goes to its arena, or stays in the mapped file */
+    TextArena::set_current(&_module->text_arena());
+    TextArena::ObjectScope objects(&_module->text_arena());
+
+    /* a snapshot that matches the input replaces parsing it */
+    uint64_t input_hash = 0;
+    size_t input_size = 0;
+    bool from_snapshot = false;
+    if (UseSnapshots && is_mapped()) {
+        input_size = _mapped->size();
+        input_hash = Snapshot::hash(_mapped->data(), input_size);
+        from_snapshot = Snapshot::load(_module, filename(), input_hash, input_size, _line_number);
+    }
 
-    getline_nonempty();
-    parse_header(module());
-    parse_module_level_asms();
-    parse_structs(module());
-    parse_comdats();
-    parse_globals(module());
-    parse_aliases();
-    parse_functions();
-    parse_attributes(module());
-    parse_metadatas(module());
+    PassManager* pm = PassManager::pass_manager;
+    if (from_snapshot) {
+        close();
+    }
+    else {
+        if (is_mapped()) {
+            _module->text_arena().adopt_file(share_mapping());
+            _module->set_has_lazy_functions(LazyParsing);
+        }
+
+        {
+            ScopedPhase phase("parse_header");
+            getline_nonempty();
+            parse_header(module());
+            parse_module_level_asms();
+            parse_structs(module());
+            parse_comdats();
+            parse_globals(module());
+            parse_aliases();
+        }
+
+        if (StreamFunctions && !UseSplitModule && pm->is_function_local() && SysArgs::has_property("output")) {
+            stream_functions(pm, SysArgs::get_property("output"));
+            return module();
+        }
+
+        if (ParallelFunctionParsing && is_mapped()) {
+            ScopedPhase phase("parse_sections_in_parallel");
+            parse_sections_in_parallel(module());
+        }
+        else {
+            {
+                ScopedPhase phase("parse_functions");
+                parse_functions();
+            }
+            {
+                ScopedPhase phase("parse_attributes");
+                parse_attributes(module());
+            }
+            {
+                ScopedPhase phase("parse_metadatas");
+                parse_metadatas(module());
+            }
+        }
+    }
 
     if (UseSplitModule) {
         return module();
@@ -767,14 +1156,24 @@ Module* LLParser::parse() {
 
     // DILocation is slightly more complicated, so resolve some data in advance
     // Update: now resolve all types of DIXXX
-    module()->resolve_after_parse();
-    module()->check_after_parse();
+    if (ResolveAfterParse) {
+        module()->resolve_after_parse();
+        module()->check_after_parse();
+    }
+
+    /* before the passes change the module */
+    if (UseSnapshots && !from_snapshot && input_size > 0) {
+        if (!Snapshot::write(module(), filename(), input_hash, input_size, _line_number)) {
+            fprintf(stderr, "WARNING: failed to write %s\n", Snapshot::path_for(filename()).c_str());
+        }
+    }
 
 #ifndef PRODUCTION
     /* perform post check */
     //SysDict::module()->check_after_parse();
 #endif
-    PassManager* pm = PassManager::pass_manager;
+    /* what the passes create goes through Module::allocate_object */
+    TextArena::ObjectScope passes(NULL);
     pm->apply_passes(module());
 
     return module();
@@ -10,6 +10,7 @@
 #include "ir/basicBlock.h"
 #include "ir/module.h"
 #include "utilities/symbol.h"
+#include "utilities/strings.h"
 #include "utilities/macros.h"
 #include "instParser.h"
 #include "irBuilder.h"
@@ -21,6 +22,7 @@ class BasicBlock;
 class GlobalVariable;
 
 class DIFile;
+class PassManager;
 class DISubprogram;
 class DILocation;
 class DILexicalBlock;
@@ -28,6 +30,8 @@ class DILexicalBlockFile;
 
 class InstParser;
 class SysDict;
+struct ParseSlice;
+struct LazyBody;
 
 class InstStats {
     size_t _parsed;
@@ -69,7 +73,8 @@ public:
     bool is_done();
 
     void inc_inline_pos(int steps=1)                                        { inc_intext_pos(steps); }
-    void set_line(string l)                                                 { set_text(l); }
+    void set_line(const string& l)                                          { set_text(l); }
+    StringRef raw_line();
 
     void set_llvm_version(string v);
     Module* parse();
@@ -81,9 +86,16 @@ public:
     void parse_globals(Module* );
     GlobalVariable* parse_global(Module* );
     void parse_aliases();
+    void parse_sections_in_parallel(Module* module);
+    void scan_slices(std::vector<ParseSlice*>& slices, bool functions, int nslices);
+    void parse_slice(Module* module, ParseSlice* slice);
     void parse_functions();
-    void parse_function_declaration();
-    void parse_function_definition();
+    void stream_functions(PassManager* pm, const string& output);
+    Function* parse_function_declaration();
+    Function* parse_function_definition();
+    void parse_function_body(Function* func);
+    void skip_function_body(Function* func);
+    void parse_lazy_body(Function* func, LazyBody* body);
     Function* parse_function_header();
     Function* create_function(string& text);
     Function* parse_function_name_and_args();
@@ -93,6 +105,8 @@ public:
     void parse_instruction_table(BasicBlock* bb, string op="");
     void parse_attributes(Module* module);
     void parse_metadatas(Module* module);
+    MetaData* parse_metadata(string& name);
+    void add_metadata(Module* module, MetaData* data, const string& name);
     DIFile* parse_difile();
     DISubprogram* parse_disubprogram();
     DILexicalBlock* parse_dilexicalblock();
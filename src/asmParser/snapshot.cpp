@@ -0,0 +1,677 @@
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <ir/irEssential.h>
+#include <inst/instEssential.h>
+#include <inst/branchInst.h>
+#include <inst/storeInst.h>
+#include <inst/allocaInst.h>
+#include <inst/getelementptrInst.h>
+#include <inst/instEssential.h>
+#include <di/diEssential.h>
+#include <peripheral/mappedFile.h>
+#include <utilities/flags.h>
+#include "instParser.h"
+#include "snapshot.h"
+
+static const char MAGIC[8] = {'S', 'O', 'P', 'T', 'S', 'N', 'A', 'P'};
+
+/* metadata classes, in the order LLParser::parse_metadata() tries them */
+enum SnapshotMetaDataKind {
+    PlainMetaDataKind,
+    DIFileKind,
+    DISubprogramKind,
+    DILexicalBlockKind,
+    DILexicalBlockFileKind,
+    DILocationKind,
+};
+
+/**@brief Hash of the input's content that a snapshot is keyed by
+ *
+ * Reads 8 bytes at a time, so hashing is much faster than reading the
+ * input from disk.
+ */
+uint64_t Snapshot::hash(const char* data, size_t size) {
+    const uint64_t prime = 0x100000001b3ULL;
+    uint64_t h = 0xcbf29ce484222325ULL ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        memcpy(&w, data + i, 8);
+        h = (h ^ w) * prime;
+        h ^= h >> 29;
+    }
+    for (; i < size; ++i) {
+        h = (h ^ (unsigned char)data[i]) * prime;
+    }
+    return h;
+}
+
+/**@brief The directory of the snapshots, -XX:SnapshotDir or the user's cache directory
+ *
+ * Snapshots are never written next to the input, which is often in a source tree.
+ */
+string Snapshot::directory() {
+    if (!SnapshotDir.empty()) {
+        return SnapshotDir;
+    }
+    if (const char* cache = getenv("XDG_CACHE_HOME")) {
+        if (*cache) {
+            return string(cache) + "/sopt";
+        }
+    }
+    if (const char* home = getenv("HOME")) {
+        if (*home) {
+            return string(home) + "/.cache/sopt";
+        }
+    }
+    return "/tmp/sopt-" + std::to_string(getuid());
+}
+
+/**@brief The snapshot of @param input, named after its file name and a hash of its full path
+ * so that inputs with the same name in different directories don't share a snapshot
+ */
+string Snapshot::path_for(const string& input) {
+    char buf[PATH_MAX];
+    string full = realpath(input.c_str(), buf) ? string(buf) : input;
+    string name = full.substr(full.rfind('/') + 1);
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", (unsigned long long)hash(full.data(), full.size()));
+    return directory() + "/" + name + "." + key + ".snap";
+}
+
+/**@brief The parser options that change the parsed module, a snapshot is only used under
+ * the same options it was written with
+ */
+string Snapshot::parser_options() {
+    return "opcodes=" + InstParser::opcode_classes() + ";label_comments=" + (UseLabelComments ? "1" : "0");
+}
+
+/* Create @param dir and its parents, true if it exists afterwards */
+static bool make_directories(const string& dir) {
+    struct stat st;
+    if (stat(dir.c_str(), &st) == 0) {
+        return S_ISDIR(st.st_mode);
+    }
+    size_t slash = dir.rfind('/');
+    if (slash != string::npos && slash > 0 && !make_directories(dir.substr(0, slash))) {
+        return false;
+    }
+    /* another process may have created it in the meantime */
+    return mkdir(dir.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+
+/* writing */
+
+/**@brief Write the snapshot of @param m, which was parsed from @param input, to path_for(@param input)
+ *
+ * Function bodies that are not parsed yet are parsed first. The image is written to a
+ * temporary file that is renamed at the end, so concurrent readers never see a partial image.
+ *
+ * @return false if the snapshot could not be written
+ */
+bool Snapshot::write(Module* m, const string& input, uint64_t hash, uint64_t input_size, long long lines) {
+    m->materialize_all();
+
+    if (!make_directories(directory())) {
+        return false;
+    }
+    string path = path_for(input);
+    string tmp = path + ".tmp" + std::to_string(getpid());
+    Snapshot s;
+    s._fp = fopen(tmp.c_str(), "wb");
+    if (!s._fp) {
+        return false;
+    }
+    setvbuf(s._fp, NULL, _IOFBF, 1 << 20);
+
+    s.write_module(m, hash, input_size, lines);
+
+    bool ok = !ferror(s._fp);
+    ok = fclose(s._fp) == 0 && ok;
+    if (ok) {
+        ok = rename(tmp.c_str(), path.c_str()) == 0;
+    }
+    if (!ok) {
+        unlink(tmp.c_str());
+    }
+    return ok;
+}
+
+void Snapshot::write_bytes(const void* p, size_t n) {
+    fwrite(p, 1, n, _fp);
+}
+
+/* Strings are NUL-terminated in the image, like the text in a TextArena */
+void Snapshot::write_str(StringRef s) {
+    write_u32((uint32_t)s.size());
+    write_bytes(s.data(), s.size());
+    write_u8(0);
+}
+
+/**@brief Write a string that recurs a lot, such as a field name or an opcode
+ *
+ * Each such word is written once, later occurrences only write its index.
+ */
+void Snapshot::write_word(const string& s) {
+    auto it = _word_ids.find(s);
+    if (it != _word_ids.end()) {
+        write_u32(it->second);
+        return;
+    }
+    uint32_t id = (uint32_t)_word_ids.size();
+    _word_ids[s] = id;
+    write_u32(id);
+    write_str(s);
+}
+
+void Snapshot::write_value(Value* v) {
+    write_str(v->name());
+    write_u8((v->has_raw_text() ? 1 : 0) | (v->fully_parsed() ? 2 : 0));
+    write_str(v->raw_view());
+    write_u32((uint32_t)v->raw_fields().size());
+    for (auto& it: v->raw_fields()) {
+        write_word(RawField::name(it.key));
+        write_field_value(v->raw_view(), it.value);
+    }
+}
+
+/**@brief Most field values are a part of the raw text, those are written as a position in the raw text
+ *
+ */
+void Snapshot::write_field_value(StringRef raw, StringRef value) {
+    size_t pos = value.empty() ? string::npos : raw.find(value);
+    if (pos == string::npos) {
+        write_str(value);
+    }
+    else {
+        write_u32((uint32_t)value.size() | IN_RAW_TEXT);
+        write_u32((uint32_t)pos);
+    }
+}
+
+void Snapshot::write_module(Module* m, uint64_t hash, uint64_t input_size, long long lines) {
+    write_bytes(MAGIC, sizeof(MAGIC));
+    write_u32(VERSION);
+    write_u64(hash);
+    write_u64(input_size);
+    write_str(parser_options());
+    write_u64((uint64_t)lines);
+
+    write_str(m->name());
+    write_str(m->module_id());
+    write_u8((uint8_t)m->language());
+    write_u32((uint32_t)m->headers().size());
+    for (auto& it: m->headers()) {
+        write_str(it.first);
+        write_str(it.second);
+    }
+    write_u32((uint32_t)m->module_level_inline_asms().size());
+    for (auto& s: m->module_level_inline_asms()) {
+        write_str(s);
+    }
+
+    write_u32((uint32_t)m->struct_list().size());
+    for (auto st: m->struct_list()) {
+        write_value(st);
+    }
+    write_u32((uint32_t)m->comdat_list().size());
+    for (auto cd: m->comdat_list()) {
+        write_value(cd);
+    }
+    write_u32((uint32_t)m->global_list().size());
+    for (auto gv: m->global_list()) {
+        write_value(gv);
+    }
+    write_u32((uint32_t)m->alias_map().size());
+    for (auto& it: m->alias_map()) {
+        write_value(it.second);
+    }
+
+    write_u32((uint32_t)m->function_list().size());
+    for (auto f: m->function_list()) {
+        write_function(f);
+    }
+
+    write_u32((uint32_t)m->attribute_list().size());
+    for (auto attr: m->attribute_list()) {
+        write_value(attr);
+    }
+
+    write_u32((uint32_t)m->named_metadata_map().size());
+    for (auto& it: m->named_metadata_map()) {
+        write_str(it.first);
+        write_metadata(it.second);
+    }
+    write_u32((uint32_t)m->unnamed_metadata_list().size());
+    for (auto md: m->unnamed_metadata_list()) {
+        write_metadata(md);
+    }
+}
+
+void Snapshot::write_function(Function* f) {
+    write_value(f);
+    write_u8((f->is_external() ? 1 : 0) | (f->is_defined() ? 2 : 0));
+    write_i32(f->dbg_id());
+
+    auto& blocks = f->basic_block_list();
+    write_u32((uint32_t)blocks.size());
+    for (auto bb: blocks) {
+        write_basic_block(bb);
+    }
+}
+
+void Snapshot::write_basic_block(BasicBlock* bb) {
+    write_value(bb);
+    write_u8((bb->is_entry() ? 1 : 0) | (bb->is_exit() ? 2 : 0));
+    write_u32((uint32_t)bb->pred_labels().size());
+    for (auto& label: bb->pred_labels()) {
+        write_str(label);
+    }
+
+    write_u32((uint32_t)bb->instruction_list().size());
+    for (auto I: bb->instruction_list()) {
+        write_instruction(I);
+    }
+}
+
+void Snapshot::write_instruction(Instruction* I) {
+    write_u8((uint8_t)I->type());
+    write_value(I);
+    write_word(I->opcode());
+    write_u8(I->has_assignment());
+    write_i32(I->dbg_id());
+
+    if (CallInstFamily* ci = dynamic_cast<CallInstFamily*>(I)) {
+        write_u8((ci->is_indirect_call() ? 1 : 0) | (ci->is_varargs() ? 2 : 0) | (ci->has_bitcast() ? 4 : 0));
+        write_str(ci->called_label());
+    }
+    else if (PhiInst* phi = dynamic_cast<PhiInst*>(I)) {
+        write_operand_pairs(I, phi->incoming());
+    }
+    else if (SwitchInst* si = dynamic_cast<SwitchInst*>(I)) {
+        write_operand_pairs(I, si->cases());
+    }
+    else if (GetElementPtrInst* gep = dynamic_cast<GetElementPtrInst*>(I)) {
+        write_operand_pairs(I, gep->indices());
+    }
+}
+
+void Snapshot::write_operand_pairs(Instruction* I, const std::vector<OperandPair>& pairs) {
+    write_u32((uint32_t)pairs.size());
+    for (auto& p: pairs) {
+        write_field_value(I->raw_view(), p.first);
+        write_field_value(I->raw_view(), p.second);
+    }
+}
+
+void Snapshot::write_metadata(MetaData* md) {
+    uint8_t kind = PlainMetaDataKind;
+    if (dynamic_cast<DIFile*>(md)) {
+        kind = DIFileKind;
+    }
+    else if (dynamic_cast<DISubprogram*>(md)) {
+        kind = DISubprogramKind;
+    }
+    else if (dynamic_cast<DILexicalBlock*>(md)) {
+        kind = DILexicalBlockKind;
+    }
+    else if (dynamic_cast<DILexicalBlockFile*>(md)) {
+        kind = DILexicalBlockFileKind;
+    }
+    else if (dynamic_cast<DILocation*>(md)) {
+        kind = DILocationKind;
+    }
+
+    write_u8(kind);
+    write_i32(md->number());
+    write_value(md);
+}
+
+
+/* reading */
+
+/**@brief Fill the empty module @param m from the snapshot of @param input
+ *
+ * The mapping of the image is adopted by the module's TextArena.
+ *
+ * @param lines: set to the number of lines of @param input
+ * @return false if there is no snapshot for this content of @param input, @param m is
+ * left untouched in that case
+ */
+bool Snapshot::load(Module* m, const string& input, uint64_t hash, uint64_t input_size, long long& lines) {
+    MappedFile* file = new MappedFile();
+    if (!file->open(path_for(input))) {
+        delete file;
+        return false;
+    }
+
+    Snapshot s;
+    s._pos = file->data();
+    s._end = file->end();
+    bool match = file->size() > sizeof(MAGIC) + 28
+                 && memcmp(s.read_bytes(sizeof(MAGIC)), MAGIC, sizeof(MAGIC)) == 0
+                 && s.read_u32() == VERSION
+                 && s.read_u64() == hash
+                 && s.read_u64() == input_size
+                 && s.read_str() == parser_options();
+    if (!match) {
+        delete file;
+        return false;
+    }
+
+    lines = (long long)s.read_u64();
+    m->text_arena().adopt_file(file);
+    s.read_module(m);
+    guarantee(s._pos == s._end, "snapshot of %s has trailing bytes", input.c_str());
+    return true;
+}
+
+const char* Snapshot::read_bytes(size_t n) {
+    guarantee(n <= (size_t)(_end - _pos), "truncated snapshot");
+    const char* p = _pos;
+    _pos += n;
+    return p;
+}
+
+uint32_t Snapshot::read_u32() {
+    uint32_t v;
+    memcpy(&v, read_bytes(4), 4);
+    return v;
+}
+
+uint64_t Snapshot::read_u64() {
+    uint64_t v;
+    memcpy(&v, read_bytes(8), 8);
+    return v;
+}
+
+StringRef Snapshot::read_ref() {
+    uint32_t n = read_u32();
+    const char* p = read_bytes(n + 1);
+    return StringRef(p, n);
+}
+
+void Snapshot::read_value(Value* v) {
+    StringRef name = read_ref();
+    if (!name.empty()) {
+        v->set_name(name.str());
+    }
+    uint8_t flags = read_u8();
+    StringRef raw = read_ref();
+    v->set_raw_text(raw);
+    v->set_has_raw_text((flags & 1) != 0);
+    v->set_fully_parsed((flags & 2) != 0);
+
+    uint32_t nfields = read_u32();
+    for (uint32_t i = 0; i < nfields; ++i) {
+        RawField::Key key = read_field_key();
+        v->set_raw_field(key, read_field_value(raw));
+    }
+}
+
+uint32_t Snapshot::read_word_id() {
+    uint32_t id = read_u32();
+    if (id == _words.size()) {
+        StringRef w = read_ref();
+        _words.push_back(Symbol(w.data(), w.size()));
+    }
+    guarantee(id < _words.size(), "bad word in snapshot");
+    return id;
+}
+
+/**@brief Read a field name, only looking up its key the first time the name is seen
+ *
+ */
+RawField::Key Snapshot::read_field_key() {
+    uint32_t id = read_word_id();
+    if (id >= _field_keys.size()) {
+        _field_keys.resize(_words.size(), -1);
+    }
+    if (_field_keys[id] < 0) {
+        _field_keys[id] = RawField::key(_words[id].str());
+    }
+    return (RawField::Key)_field_keys[id];
+}
+
+StringRef Snapshot::read_field_value(StringRef raw) {
+    uint32_t n = read_u32();
+    if (n & IN_RAW_TEXT) {
+        n &= ~IN_RAW_TEXT;
+        uint32_t pos = read_u32();
+        guarantee(pos <= raw.size() && n <= raw.size() - pos, "bad field in snapshot");
+        return StringRef(raw.data() + pos, n);
+    }
+    return StringRef(read_bytes(n + 1), n);
+}
+
+void Snapshot::read_module(Module* m) {
+    StringRef name = read_ref();
+    if (!name.empty()) {
+        m->set_name(name.str());
+    }
+    m->set_module_id(read_str());
+    m->set_language((Module::Language)read_u8());
+    uint32_t n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        string key = read_str();
+        m->set_header(key, read_str());
+    }
+    n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        string s = read_str();
+        m->add_module_level_asm(s);
+    }
+
+    n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        StructType* st = new StructType();
+        read_value(st);
+        m->add_struct_type(st);
+    }
+    n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        Comdat* cd = new Comdat();
+        read_value(cd);
+        m->add_comdat(cd);
+    }
+    n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        GlobalVariable* gv = new GlobalVariable();
+        read_value(gv);
+        m->add_global_variable(gv);
+    }
+    n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        Alias* alias = new Alias();
+        read_value(alias);
+        m->add_alias(alias->name(), alias);
+    }
+
+    n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        m->append_new_function(read_function());
+    }
+
+    n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        Attribute* attr = new Attribute();
+        read_value(attr);
+        m->append_attribute(attr);
+    }
+
+    n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        string key = read_str();
+        MetaData* md = read_metadata();
+        m->set_named_metadata(key, md);
+        md->set_parent(m);
+    }
+    n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        MetaData* md = read_metadata();
+        m->append_unnamed_metadata(md);
+        md->set_parent(m);
+    }
+}
+
+Function* Snapshot::read_function() {
+    Function* f = new Function();
+    read_value(f);
+    uint8_t flags = read_u8();
+    if (flags & 1) {
+        f->set_is_external();
+    }
+    if (flags & 2) {
+        f->set_is_defined();
+    }
+    f->set_dbg_id(read_i32());
+
+    uint32_t n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        read_basic_block(f);
+    }
+    return f;
+}
+
+void Snapshot::read_basic_block(Function* f) {
+    BasicBlock* bb = f->create_basic_block();
+    read_value(bb);
+    uint8_t flags = read_u8();
+    if (flags & 1) {
+        bb->set_is_entry();
+        f->set_entry_block(bb);
+    }
+    if (flags & 2) {
+        bb->set_is_exit();
+    }
+    uint32_t n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        bb->append_pred(read_str());
+    }
+
+    n = read_u32();
+    for (uint32_t i = 0; i < n; ++i) {
+        Instruction* I = read_instruction();
+        bb->append_instruction(I);
+        I->set_owner(f->name_symbol());
+    }
+}
+
+Instruction* Snapshot::read_instruction() {
+    Instruction* I;
+    switch ((Instruction::InstType)read_u8()) {
+        case Instruction::AllocaInstType:
+            I = new AllocaInst();
+            break;
+        case Instruction::LoadInstType:
+            I = new LoadInst();
+            break;
+        case Instruction::StoreInstType:
+            I = new StoreInst();
+            break;
+        case Instruction::BranchInstType:
+            I = new BranchInst();
+            break;
+        case Instruction::CallInstType:
+            I = new CallInst();
+            break;
+        case Instruction::InvokeInstType:
+            I = new InvokeInst();
+            break;
+        case Instruction::BitCastInstType:
+            I = new BitCastInst();
+            break;
+        case Instruction::GetElementPtrInstType:
+            I = new GetElementPtrInst();
+            break;
+        case Instruction::PhiInstType:
+            I = new PhiInst();
+            break;
+        case Instruction::CmpInstType:
+            I = new CmpInst();
+            break;
+        case Instruction::BinaryInstType:
+            I = new BinaryInst();
+            break;
+        case Instruction::CastInstType:
+            I = new CastInst();
+            break;
+        case Instruction::ReturnInstType:
+            I = new ReturnInst();
+            break;
+        case Instruction::SwitchInstType:
+            I = new SwitchInst();
+            break;
+        default:
+            I = new Instruction();
+            break;
+    }
+
+    read_value(I);
+    I->set_opcode(read_word_symbol());
+    I->set_has_assignment(read_u8() != 0);
+    I->set_dbg_id(read_i32());
+
+    if (CallInstFamily* ci = dynamic_cast<CallInstFamily*>(I)) {
+        uint8_t flags = read_u8();
+        ci->set_is_indirect_call((flags & 1) != 0);
+        ci->set_is_varargs((flags & 2) != 0);
+        ci->set_has_bitcast((flags & 4) != 0);
+        ci->set_called_label(read_str());
+    }
+    else if (PhiInst* phi = dynamic_cast<PhiInst*>(I)) {
+        uint32_t n = read_u32();
+        for (uint32_t i = 0; i < n; ++i) {
+            StringRef value = read_field_value(I->raw_view());
+            phi->append_incoming(value, read_field_value(I->raw_view()));
+        }
+    }
+    else if (SwitchInst* si = dynamic_cast<SwitchInst*>(I)) {
+        uint32_t n = read_u32();
+        for (uint32_t i = 0; i < n; ++i) {
+            StringRef value = read_field_value(I->raw_view());
+            si->append_case(value, read_field_value(I->raw_view()));
+        }
+    }
+    else if (GetElementPtrInst* gep = dynamic_cast<GetElementPtrInst*>(I)) {
+        uint32_t n = read_u32();
+        for (uint32_t i = 0; i < n; ++i) {
+            StringRef ty = read_field_value(I->raw_view());
+            gep->append_index(ty, read_field_value(I->raw_view()));
+        }
+    }
+    return I;
+}
+
+MetaData* Snapshot::read_metadata() {
+    MetaData* md;
+    switch (read_u8()) {
+        case DIFileKind:
+            md = new DIFile();
+            break;
+        case DISubprogramKind:
+            md = new DISubprogram();
+            break;
+        case DILexicalBlockKind:
+            md = new DILexicalBlock();
+            break;
+        case DILexicalBlockFileKind:
+            md = new DILexicalBlockFile();
+            break;
+        case DILocationKind:
+            md = new DILocation();
+            break;
+        default:
+            md = new MetaData();
+            break;
+    }
+
+    md->set_number(read_i32());
+    read_value(md);
+    md->resolve_non_refs();
+    return md;
+}
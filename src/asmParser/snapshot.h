@@ -0,0 +1,96 @@
+#ifndef LLPARSER_SNAPSHOT_H
+#define LLPARSER_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <vector>
+#include <utilities/macros.h>
+#include <utilities/stringRef.h>
+#include <utilities/symbol.h>
+#include <ir/rawField.h>
+
+class Module;
+class Value;
+class Function;
+class BasicBlock;
+class Instruction;
+struct OperandPair;
+class MetaData;
+class MappedFile;
+
+/**@brief A binary image of a parsed module, stored in the directory given by -XX:SnapshotDir
+ *
+ * The image holds every entity of the module with its raw text, raw fields and the
+ * flags the parser sets, in the order the parser creates them. Loading maps the
+ * image and rebuilds the entities through the same Module/Function/BasicBlock calls
+ * the parser uses; raw text and field values are StringRefs into the mapping, so
+ * nothing is tokenized and text is not copied. References between entities (callees,
+ * debug info scopes, ...) are restored by the usual Module::resolve_after_parse().
+ *
+ * An image is keyed by a hash of the input's content and by the parser options that
+ * change what is parsed, and is simply not used if either has changed since it was written.
+ */
+class Snapshot {
+    /* writing */
+    FILE* _fp;
+    std::map<string, uint32_t> _word_ids;
+
+    void write_bytes(const void* p, size_t n);
+    void write_u8(uint8_t v)                                { write_bytes(&v, 1); }
+    void write_u32(uint32_t v)                              { write_bytes(&v, 4); }
+    void write_i32(int32_t v)                               { write_bytes(&v, 4); }
+    void write_u64(uint64_t v)                              { write_bytes(&v, 8); }
+    void write_str(StringRef s);
+    void write_str(const string& s)                         { write_str(StringRef(s)); }
+    void write_word(const string& s);
+    void write_field_value(StringRef raw, StringRef value);
+    void write_operand_pairs(Instruction* I, const std::vector<OperandPair>& pairs);
+    void write_value(Value* v);
+    void write_function(Function* f);
+    void write_basic_block(BasicBlock* bb);
+    void write_instruction(Instruction* I);
+    void write_metadata(MetaData* md);
+
+    /* reading */
+    const char* _pos;
+    const char* _end;
+    std::vector<Symbol> _words;
+    std::vector<int32_t> _field_keys;  // the RawField::Key of each word, -1 if not looked up yet
+
+    const char* read_bytes(size_t n);
+    uint8_t read_u8()                                       { return *(const uint8_t*)read_bytes(1); }
+    uint32_t read_u32();
+    int32_t read_i32()                                      { return (int32_t)read_u32(); }
+    uint64_t read_u64();
+    StringRef read_ref();
+    string read_str()                                       { return read_ref().str(); }
+    uint32_t read_word_id();
+    const string& read_word()                               { return _words[read_word_id()].str(); }
+    Symbol read_word_symbol()                               { return _words[read_word_id()]; }
+    RawField::Key read_field_key();
+    StringRef read_field_value(StringRef raw);
+    void read_value(Value* v);
+    Function* read_function();
+    void read_basic_block(Function* f);
+    Instruction* read_instruction();
+    MetaData* read_metadata();
+
+    void write_module(Module* m, uint64_t hash, uint64_t input_size, long long lines);
+    void read_module(Module* m);
+
+    Snapshot(): _fp(NULL), _pos(NULL), _end(NULL) {}
+public:
+    static const uint32_t VERSION = 3;
+    static const uint32_t IN_RAW_TEXT = 1u << 31;  // a field value given as a position in the raw text
+
+    static string directory();
+    static string path_for(const string& input);
+    static string parser_options();
+    static uint64_t hash(const char* data, size_t size);
+
+    static bool write(Module* m, const string& input, uint64_t hash, uint64_t input_size, long long lines);
+    static bool load(Module* m, const string& input, uint64_t hash, uint64_t input_size, long long& lines);
+};
+
+#endif //LLPARSER_SNAPSHOT_H
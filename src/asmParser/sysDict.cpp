@@ -4,17 +4,21 @@
 
 #include <libgen.h>
 #include <string.h>
+#include <algorithm>
 #include <utilities/mutex.h>
 #include <utilities/flags.h>
+#include <utilities/tracer.h>
 #include <asmParser/llParserTLS.h>
 #include <asmParser/instFlags.h>
 #include <peripheral/sysArgs.h>
+#include <passes/passManager.h>
 #include "sysDict.h"
 #include "instParser.h"
 #include "llParser.h"
 
-std::map<pthread_t , Module*> SysDict::_thread_module_table;  // use pthread id to index
+thread_local Module* SysDict::_current = NULL;
 std::map<string, Module*> SysDict::_module_table;  // use input file name to index
+std::vector<Module*> SysDict::_modules;
 LLParser* SysDict::parser = NULL;
 std::vector<Instruction*> SysDict::_inst_stack;
 //InstParser* SysDict::instParser = NULL;
@@ -35,9 +39,12 @@ void SysDict::destroy() {
 //    }
 
     if (ParallelModule) {
-        for (auto it: thread_module_table()) {
-            delete it.second;
+        /* every module parsed by a thread is registered, the table only keeps one per input file */
+        for (auto m: _modules) {
+            delete m;
         }
+        _modules.clear();
+        module_table().clear();
     }
     
     Locks::destroy();
@@ -104,9 +111,8 @@ void SysDict::pass_print_to_file(string passname, Module* module) {
     module->print_to_file(out);
 }
 
-/**@brief Register a module.
+/**@brief Register a module and make it current on the calling thread.
  *
- * ThreadLocal data is also initilized here.
  * The lock/unlock is still executed in case of single thread.
  * Note that the name used for module registery/lookup is
  * the input file name corresponding to that module
@@ -114,31 +120,55 @@ void SysDict::pass_print_to_file(string passname, Module* module) {
  * @param module
  */
 void SysDict::add_module(Module* m) {
-    Locks::module_list_lock->lock();
+    Tracer::lock(Locks::module_list_lock, "module_list_lock");
 
     //module_table()[basename(strdup(m->input_file().c_str()))] = m;
     module_table()[m->input_file()] = m;
+    if (std::find(_modules.begin(), _modules.end(), m) == _modules.end()) {
+        _modules.push_back(m);
+    }
     Locks::module_list_lock->unlock();
 
-    Locks::thread_table_lock->lock();
-    thread_module_table()[pthread_self()] = m;
-    Locks::thread_table_lock->unlock();
+    _current = m;
 }
 
-/**@brief Returns the current module.
- * This method uses pthread_self() to do the lookup even if there is just one thread (with SysDict::parser).
+/**@brief Unregister @param m and destroy it
+ *
+ * Used to give back the memory of a module that no pass will look at again.
+ */
+void SysDict::remove_module(Module* m) {
+    Tracer::lock(Locks::module_list_lock, "module_list_lock");
+    auto it = module_table().find(m->input_file());
+    if (it != module_table().end() && it->second == m) {
+        module_table().erase(it);
+    }
+    auto pos = std::find(_modules.begin(), _modules.end(), m);
+    if (pos != _modules.end()) {
+        _modules.erase(pos);
+    }
+    Locks::module_list_lock->unlock();
+
+    /* other threads that worked on m have left it already */
+    if (_current == m) {
+        _current = NULL;
+    }
+
+    if (PassManager::pass_manager) {
+        PassManager::pass_manager->analyses().release(m);
+    }
+    delete m;
+}
+
+/**@brief Returns the module current on the calling thread.
+ *
+ * Kept for the code written before ModuleContext, the lookup is a thread_local load and takes no
+ * lock. The current module is set by add_module(), attach_thread() or a ModuleContext.
  *
  * @return
  */
 Module* SysDict::module() {
-    pthread_t id = pthread_self();
-    Module* m;
-
-    Locks::thread_table_lock->lock();
-    guarantee(thread_module_table().find(id) != thread_module_table().end(), " ");
-    m = thread_module_table()[id];
-    Locks::thread_table_lock->unlock();
-    return m;
+    guarantee(_current, "no module is current on this thread");
+    return _current;
 }
 
 Module* SysDict::get_module(string name) {
@@ -175,7 +205,9 @@ void SysDict::merge_modules() {
                 F->set_parent(head);
             }
             //m.insert(piece->function_map().begin(), piece->function_map().end());
-            m.insert(piece->value_map().begin(), piece->value_map().end());
+            m.merge(piece->value_map());
+            head->text_arena().adopt(&piece->text_arena());
+            piece->drop_contents();
             delete piece;  // won't delete the actual instructions of the deleted module
         }
     }
@@ -192,12 +224,14 @@ void SysDict::merge_modules() {
                 l.push_back(data);
                 data->set_parent(head);
             }
+            head->text_arena().adopt(&piece->text_arena());
+            piece->drop_contents();
             delete piece;
         }
     }
 
     module_table().clear();
-    thread_module_table().clear();
+    _modules.clear();
 
     add_module(head);
 }
\ No newline at end of file
@@ -15,9 +15,9 @@ class SysDict {
 public:
 private:
     static std::vector<Instruction*> _inst_stack;
-    static std::map<pthread_t , Module*> _thread_module_table;
+    static thread_local Module* _current;
     static std::map<string, Module*> _module_table;
-    //static std::vector<Module*> _modules;
+    static std::vector<Module*> _modules;  // all registered modules, some may share an input file
 public:
 
     static void init();
@@ -30,7 +30,12 @@ public:
     static Module* get_module(string name);
     /* thread specific */
     static void add_module(Module*);
-    /* all these functions assume thread_module_table has been constructed */
+    static void remove_module(Module*);
+    /* make module() return m on the calling thread without registering m, for helper threads */
+    static void attach_thread(Module* m)                                       { _current = m; }
+    static void detach_thread()                                                { _current = NULL; }
+    static Module* current_module()                                            { return _current; }
+    /* all these functions assume a module is current on the calling thread */
     static Module* module();
     static const string& filename();
     static const string filedir();
@@ -40,7 +45,6 @@ public:
     /* for UseSplitModule */
     static void merge_modules();
 
-    static std::map<pthread_t , Module*>& thread_module_table()                { return _thread_module_table; }
     static std::map<string, Module*>& module_table()                           { return _module_table; }
 
     static LLParser* parser;
@@ -48,4 +52,24 @@ public:
     //static InstParser* instParser;
 };
 
+/**@brief Makes a module current on the calling thread for the lifetime of the context
+ *
+ * Contexts nest, the module that was current before is current again when the context
+ * is destroyed. Code that already knows its module should carry the context (or the
+ * module) and use module() rather than look the module up through SysDict::module().
+ */
+class ModuleContext {
+    Module* _module;
+    Module* _previous;
+public:
+    explicit ModuleContext(Module* m): _module(m), _previous(SysDict::current_module()) {
+        SysDict::attach_thread(m);
+    }
+    ModuleContext(const ModuleContext&) = delete;
+    ModuleContext& operator=(const ModuleContext&) = delete;
+    ~ModuleContext()                                                           { SysDict::attach_thread(_previous); }
+
+    Module* module() const                                                     { return _module; }
+};
+
 #endif //LLPARSER_SYSDICT_H
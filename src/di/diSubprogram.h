@@ -33,7 +33,7 @@ public:
     void set_line(int line)                           { _line = line; }
 
     const string &linkageName() const {
-        if (has_raw_field("linkageName")) {
+        if (has_raw_field(RawField::LinkageName)) {
             return _linkageName;
         }
         else {
@@ -4,6 +4,9 @@
 
 #include "allocaInst.h"
 
+static const RawFieldLayout alloca_fields{RawField::Inalloca, RawField::Ty, RawField::Alignment, RawField::NumElements};
+
 AllocaInst::AllocaInst() {
     _type = AllocaInstType;
-}
\ No newline at end of file
+    set_raw_field_layout(&alloca_fields);
+}
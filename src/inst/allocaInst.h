@@ -7,9 +7,16 @@
 
 #include <ir/instruction.h>
 
+/**@brief <result> = alloca [inalloca] <type> [, <ty> <NumElements>] [, align <alignment>]
+ *
+ */
 class AllocaInst: public Instruction {
 public:
     AllocaInst();
+
+    StringRef allocated_type() const                    { return raw_field(RawField::Ty); }
+    StringRef num_elements() const                      { return raw_field(RawField::NumElements); }  // empty if not given
+    StringRef alignment() const                         { return raw_field(RawField::Alignment); }
 };
 
 #endif //LLPARSER_ALLOCAINST_H
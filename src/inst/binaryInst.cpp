@@ -0,0 +1,8 @@
+#include "binaryInst.h"
+
+static const RawFieldLayout binary_fields{RawField::Nuw, RawField::Nsw, RawField::Exact, RawField::FastMath, RawField::Ty, RawField::Lhs, RawField::Rhs};
+
+BinaryInst::BinaryInst() {
+    _type = BinaryInstType;
+    set_raw_field_layout(&binary_fields);
+}
@@ -0,0 +1,23 @@
+#ifndef LLPARSER_BINARYINST_H
+#define LLPARSER_BINARYINST_H
+
+#include <ir/instruction.h>
+
+/**@brief The binary and bitwise binary operations, such as
+ * <result> = add [nuw] [nsw] <ty> <op1>, <op2>
+ * <result> = fadd [fast-math flags] <ty> <op1>, <op2>
+ * <result> = udiv [exact] <ty> <op1>, <op2>
+ */
+class BinaryInst: public Instruction {
+public:
+    BinaryInst();
+
+    StringRef ty() const                                { return raw_field(RawField::Ty); }
+    StringRef lhs() const                               { return raw_field(RawField::Lhs); }
+    StringRef rhs() const                               { return raw_field(RawField::Rhs); }
+    bool has_nuw() const                                { return has_raw_field(RawField::Nuw); }
+    bool has_nsw() const                                { return has_raw_field(RawField::Nsw); }
+    bool is_exact() const                               { return has_raw_field(RawField::Exact); }
+};
+
+#endif //LLPARSER_BINARYINST_H
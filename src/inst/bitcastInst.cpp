@@ -4,6 +4,9 @@
 
 #include "bitcastInst.h"
 
+static const RawFieldLayout bitcast_fields{RawField::Ty, RawField::Value, RawField::FinalValue, RawField::Ty2};
+
 BitCastInst::BitCastInst() {
     set_type(Instruction::BitCastInstType);
+    set_raw_field_layout(&bitcast_fields);
 }
\ No newline at end of file
@@ -4,6 +4,9 @@
 
 #include "branchInst.h"
 
+static const RawFieldLayout branch_fields{RawField::Cond, RawField::TrueLabel, RawField::FalseLabel};
+
 BranchInst::BranchInst() {
     _type = BranchInstType;
+    set_raw_field_layout(&branch_fields);
 }
\ No newline at end of file
@@ -10,7 +10,13 @@
 #include "callInst.h"
 #include "bitcastInst.h"
 
+static const RawFieldLayout call_fields{
+    RawField::Tail, RawField::FastMath, RawField::Cconv, RawField::RetAttrs,
+    RawField::Fnty, RawField::Fnptrval, RawField::Args, RawField::FnAttrs
+};
+
 CallInst::CallInst() {
+    set_raw_field_layout(&call_fields);
     set_type(Instruction::CallInstType);
 
     init_raw_field();
@@ -18,8 +24,8 @@ CallInst::CallInst() {
 
 void CallInst::init_raw_field() {
     CallInstFamily::init_raw_field();
-//    set_raw_field("tail", "");
-//    set_raw_field("fast-math", "");
+//    set_raw_field(RawField::Tail, "");
+//    set_raw_field(RawField::FastMath, "");
 }
 //
 //Instruction* CallInst::clone() {
@@ -18,9 +18,9 @@ CallInstFamily::CallInstFamily() {
 }
 
 void CallInstFamily::init_raw_field() {
-//    set_raw_field("cconv", "");
-//    set_raw_field("ret-attrs", "");
-//    set_raw_field("args", "");
+//    set_raw_field(RawField::Cconv, "");
+//    set_raw_field(RawField::RetAttrs, "");
+//    set_raw_field(RawField::Args, "");
 }
 
 Function* CallInstFamily::called_function() {
@@ -49,8 +49,8 @@ void CallInstFamily::replace_callee(string callee) {
     if (new_callee == NULL) {
         throw FunctionNotFoundError(callee);
     }
-    string old = called_function()->name();
-    Strings::ireplace(_raw_text, old, callee);  // todo: this should be fine, but I am not sure
+    Symbol old = called_function()->name_symbol();
+    Strings::ireplace(raw_text(), old.str(), callee);  // todo: this should be fine, but I am not sure
     set_called_function(new_callee);
 
     new_callee->append_user(this);
@@ -58,28 +58,33 @@ void CallInstFamily::replace_callee(string callee) {
     Function* old_callee = module()->get_function(old);
     guarantee(old_callee, "callee %s not found", old.c_str());
     old_callee->remove_user(this);
+
+    if (CallGraph* cg = module()->call_graph_if_built()) {
+        cg->remove_call(function(), old_callee);
+        cg->add_call(function(), new_callee);
+    }
 //    auto& vec = old_callee->user_set();
 //    auto newend = std::remove(vec.begin(), vec.end(), this);
 //    vec.erase(newend, vec.end());
 }
 
 void CallInstFamily::replace_args(string newargs) {
-    string oldargs = get_raw_field("args");
-    Strings::ireplace(_raw_text, oldargs, newargs);
-    set_raw_field("args", newargs);
+    string oldargs = get_raw_field(RawField::Args);
+    Strings::ireplace(raw_text(), oldargs, newargs);
+    set_raw_field(RawField::Args, newargs);
 }
 
 string CallInstFamily::get_nth_arg_by_split(int pos) {
-    string args = get_raw_field("args");
+    string args = get_raw_field(RawField::Args);
     auto items = Strings::split(args, ',');
     return items.at(pos);
 }
 
-void CallInstFamily::resolve_direct_call() {
+void CallInstFamily::resolve_direct_call(std::vector<CallInstFamily*>* deferred) {
     guarantee(!is_indirect_call(), "just check");
-    string fn_name = get_raw_field("fnptrval");
+    string fn_name = get_raw_field(RawField::Fnptrval);
     if (!fn_name.empty()) {
-        resolve_callee_symbol(fn_name);
+        resolve_callee_symbol(fn_name, deferred);
     }
     else {
         // Example:
@@ -88,20 +93,26 @@ void CallInstFamily::resolve_direct_call() {
     }
 }
 
-void CallInstFamily::resolve_callee_symbol(string fn_name) {
-    if (Alias* alias = module()->get_alias(fn_name)) {
-        string aliasee = alias->get_raw_field("aliasee");
-        fn_name = aliasee;
+void CallInstFamily::resolve_callee_symbol(string fn_name, std::vector<CallInstFamily*>* deferred) {
+    Symbol sym = Symbol::find(fn_name);
+    if (Alias* alias = module()->get_alias(sym)) {
+        fn_name = alias->get_raw_field(RawField::Aliasee);
+        sym = Symbol::find(fn_name);
     }
 
-    Function* callee = module()->get_function(fn_name);
+    Function* callee = module()->get_function(sym);
     guarantee(callee, "resolve_callee_symbol: function %s not found", fn_name.c_str());
 //    if (callee == NULL) {
 //        callee = module()->create_child_function_symbol(fn_name);
 //    }
 
     set_called_function(callee);
-    callee->append_user(this);
+    if (deferred) {
+        deferred->push_back(this);
+    }
+    else {
+        callee->append_user(this);
+    }
 
     if (CallInstParsingVerbose) {
         printf( "  name: |%s|\n",
@@ -112,7 +123,7 @@ void CallInstFamily::resolve_callee_symbol(string fn_name) {
 /**@brief Try to infer the caller based on data flow. Success not guaranteed.
  *
  */
-void CallInstFamily::try_resolve_indirect_call() {
+void CallInstFamily::try_resolve_indirect_call(std::vector<CallInstFamily*>* deferred) {
     guarantee(parent() != NULL, "Parent must not be NULL when resolving indirect calls");
 //
 //    for (auto rit = parent()->end(); rit != parent()->begin();) {
@@ -123,7 +134,7 @@ void CallInstFamily::try_resolve_indirect_call() {
 //            set_chain_inst(I);
 //
 //            if (BitCastInst* bi = dynamic_cast<BitCastInst*>(I)) {
-//                string value = bi->get_raw_field("value");
+//                string value = bi->get_raw_field(RawField::Value);
 //                if (value[0] == '@') {
 //                    //zpl("resolved indirect call target to %s (%s)", value.c_str(), raw_c_str());
 //                    resolve_callee_symbol(&value[1]);
@@ -135,10 +146,10 @@ void CallInstFamily::try_resolve_indirect_call() {
 //    }
 
     if (BitCastInst* bi = dynamic_cast<BitCastInst*>(chain_inst())) {
-        string value = bi->get_raw_field("value");
+        string value = bi->get_raw_field(RawField::Value);
         if (value[0] == '@') {
             //zpl("resolved indirect call target to %s (%s)", value.c_str(), raw_c_str());
-            resolve_callee_symbol(&value[1]);
+            resolve_callee_symbol(&value[1], deferred);
         }
     }
 }
@@ -14,7 +14,7 @@ protected:
     bool _has_bitcast;
 
     /* for indirect calls */
-    string _called_label;
+    Symbol _called_label;
     Function* _called;
     Instruction* _chain_inst;  // the reference for indirect call's target
 public:
@@ -49,10 +49,10 @@ public:
     }
 
     const string &called_label() const {
-        return _called_label;
+        return _called_label.str();
     }
 
-    void set_called_label(const string &_called_label) {
+    void set_called_label(Symbol _called_label) {
         CallInstFamily::_called_label = _called_label;
     }
 
@@ -68,9 +68,10 @@ public:
     void replace_args(string newargs);
     string get_nth_arg_by_split(int pos);
 
-    void try_resolve_indirect_call();
-    void resolve_direct_call();
-    void resolve_callee_symbol(string fn_name);
+    /* If @param deferred is given the call is added to it instead of to the callee's users */
+    void try_resolve_indirect_call(std::vector<CallInstFamily*>* deferred=NULL);
+    void resolve_direct_call(std::vector<CallInstFamily*>* deferred=NULL);
+    void resolve_callee_symbol(string fn_name, std::vector<CallInstFamily*>* deferred=NULL);
 };
 
 #endif //LLPARSER_CallInstFamily_H
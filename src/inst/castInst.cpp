@@ -0,0 +1,8 @@
+#include "castInst.h"
+
+static const RawFieldLayout cast_fields{RawField::Ty, RawField::Value, RawField::Ty2};
+
+CastInst::CastInst() {
+    _type = CastInstType;
+    set_raw_field_layout(&cast_fields);
+}
@@ -0,0 +1,20 @@
+#ifndef LLPARSER_CASTINST_H
+#define LLPARSER_CASTINST_H
+
+#include <ir/instruction.h>
+
+/**@brief The conversion operations other than bitcast, such as
+ * <result> = sext <ty> <value> to <ty2>
+ *
+ * Bitcasts have their own BitCastInst because the passes look into them.
+ */
+class CastInst: public Instruction {
+public:
+    CastInst();
+
+    StringRef src_type() const                          { return raw_field(RawField::Ty); }
+    StringRef value() const                             { return raw_field(RawField::Value); }
+    StringRef dest_type() const                         { return raw_field(RawField::Ty2); }
+};
+
+#endif //LLPARSER_CASTINST_H
@@ -0,0 +1,8 @@
+#include "cmpInst.h"
+
+static const RawFieldLayout cmp_fields{RawField::FastMath, RawField::Predicate, RawField::Ty, RawField::Lhs, RawField::Rhs};
+
+CmpInst::CmpInst() {
+    _type = CmpInstType;
+    set_raw_field_layout(&cmp_fields);
+}
@@ -0,0 +1,19 @@
+#ifndef LLPARSER_CMPINST_H
+#define LLPARSER_CMPINST_H
+
+#include <ir/instruction.h>
+
+/**@brief <result> = icmp <cond> <ty> <op1>, <op2>
+ *        <result> = fcmp [fast-math flags] <cond> <ty> <op1>, <op2>
+ */
+class CmpInst: public Instruction {
+public:
+    CmpInst();
+
+    StringRef predicate() const                         { return raw_field(RawField::Predicate); }
+    StringRef ty() const                                { return raw_field(RawField::Ty); }
+    StringRef lhs() const                               { return raw_field(RawField::Lhs); }
+    StringRef rhs() const                               { return raw_field(RawField::Rhs); }
+};
+
+#endif //LLPARSER_CMPINST_H
@@ -4,6 +4,9 @@
 
 #include "getelementptrInst.h"
 
+static const RawFieldLayout gep_fields{RawField::Inbounds, RawField::Ty, RawField::Ty2, RawField::Pointer};
+
 GetElementPtrInst::GetElementPtrInst() {
-    _type == GetElementPtrInstType;
+    _type = GetElementPtrInstType;
+    set_raw_field_layout(&gep_fields);
 }
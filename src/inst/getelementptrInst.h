@@ -7,9 +7,23 @@
 
 #include <ir/instruction.h>
 
+/**@brief <result> = getelementptr [inbounds] <ty>, <ty>* <ptrval>{, [inrange] <ty> <idx>}*
+ *
+ * A getelementptr embedded in another instruction as a constant expression only
+ * keeps its text.
+ */
 class GetElementPtrInst: public Instruction {
+    std::vector<OperandPair> _indices;  // (type, index)
 public:
     GetElementPtrInst();
+
+    bool is_inbounds() const                            { return has_raw_field(RawField::Inbounds); }
+    StringRef source_element_type() const               { return raw_field(RawField::Ty); }
+    StringRef pointer_type() const                      { return raw_field(RawField::Ty2); }
+    StringRef pointer() const                           { return raw_field(RawField::Pointer); }
+
+    const std::vector<OperandPair>& indices() const     { return _indices; }
+    void append_index(StringRef ty, StringRef idx)      { _indices.push_back(OperandPair{ty, idx}); }
 };
 
 #endif //LLPARSER_GETELEMENTPTRINST_H
@@ -14,5 +14,11 @@
 #include "loadInst.h"
 #include "bitcastInst.h"
 #include "getelementptrInst.h"
+#include "phiInst.h"
+#include "cmpInst.h"
+#include "binaryInst.h"
+#include "castInst.h"
+#include "returnInst.h"
+#include "switchInst.h"
 
 #endif //LLPARSER_INSTESSENTIAL_H
@@ -4,7 +4,13 @@
 
 #include "invokeInst.h"
 
+static const RawFieldLayout invoke_fields{
+    RawField::Cconv, RawField::RetAttrs, RawField::Fnty, RawField::Fnptrval,
+    RawField::Args, RawField::FnAttrs, RawField::NormalLabel, RawField::ExceptionLabel
+};
+
 InvokeInst::InvokeInst() {
+    set_raw_field_layout(&invoke_fields);
     set_type(Instruction::InvokeInstType);
 
     init_raw_field();
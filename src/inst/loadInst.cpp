@@ -5,8 +5,11 @@
 #include "loadInst.h"
 #include <asmParser/instParser.h>
 
+static const RawFieldLayout load_fields{RawField::Atomic, RawField::Volatile, RawField::Ty, RawField::Pointer, RawField::FinalPointer, RawField::Alignment};
+
 LoadInst::LoadInst() {
     set_type(Instruction::LoadInstType);
+    set_raw_field_layout(&load_fields);
 }
 
 void LoadInst::parse(Instruction *inst) {
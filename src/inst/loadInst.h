@@ -18,7 +18,7 @@ class LoadInst: public Instruction {
 public:
     LoadInst();
 
-    string pointer_type_str()                           { return get_raw_field("ty") + '*'; }
+    string pointer_type_str()                           { return get_raw_field(RawField::Ty) + '*'; }
 
     static void parse(Instruction* inst);
 };
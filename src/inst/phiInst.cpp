@@ -0,0 +1,8 @@
+#include "phiInst.h"
+
+static const RawFieldLayout phi_fields{RawField::Ty};
+
+PhiInst::PhiInst() {
+    _type = PhiInstType;
+    set_raw_field_layout(&phi_fields);
+}
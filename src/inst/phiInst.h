@@ -0,0 +1,19 @@
+#ifndef LLPARSER_PHIINST_H
+#define LLPARSER_PHIINST_H
+
+#include <ir/instruction.h>
+
+/**@brief <result> = phi <ty> [ <val0>, <label0>], ...
+ *
+ */
+class PhiInst: public Instruction {
+    std::vector<OperandPair> _incoming;  // (value, label)
+public:
+    PhiInst();
+
+    StringRef ty() const                                { return raw_field(RawField::Ty); }
+    const std::vector<OperandPair>& incoming() const    { return _incoming; }
+    void append_incoming(StringRef value, StringRef label)  { _incoming.push_back(OperandPair{value, label}); }
+};
+
+#endif //LLPARSER_PHIINST_H
@@ -0,0 +1,8 @@
+#include "returnInst.h"
+
+static const RawFieldLayout return_fields{RawField::Ty, RawField::Value};
+
+ReturnInst::ReturnInst() {
+    _type = ReturnInstType;
+    set_raw_field_layout(&return_fields);
+}
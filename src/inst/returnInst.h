@@ -0,0 +1,18 @@
+#ifndef LLPARSER_RETURNINST_H
+#define LLPARSER_RETURNINST_H
+
+#include <ir/instruction.h>
+
+/**@brief ret <type> <value>
+ *        ret void
+ */
+class ReturnInst: public Instruction {
+public:
+    ReturnInst();
+
+    StringRef ty() const                                { return raw_field(RawField::Ty); }
+    StringRef value() const                             { return raw_field(RawField::Value); }  // empty for ret void
+    bool is_void() const                                { return !has_raw_field(RawField::Value); }
+};
+
+#endif //LLPARSER_RETURNINST_H
@@ -4,6 +4,9 @@
 
 #include "storeInst.h"
 
+static const RawFieldLayout store_fields{RawField::Atomic, RawField::Volatile, RawField::Value, RawField::Ty, RawField::Pointer, RawField::Alignment};
+
 StoreInst::StoreInst() {
     _type = StoreInstType;
+    set_raw_field_layout(&store_fields);
 }
\ No newline at end of file
@@ -0,0 +1,8 @@
+#include "switchInst.h"
+
+static const RawFieldLayout switch_fields{RawField::Ty, RawField::Value, RawField::DefaultLabel};
+
+SwitchInst::SwitchInst() {
+    _type = SwitchInstType;
+    set_raw_field_layout(&switch_fields);
+}
@@ -0,0 +1,22 @@
+#ifndef LLPARSER_SWITCHINST_H
+#define LLPARSER_SWITCHINST_H
+
+#include <ir/instruction.h>
+
+/**@brief switch <intty> <value>, label <defaultdest> [ <intty> <val>, label <dest> ... ]
+ *
+ */
+class SwitchInst: public Instruction {
+    std::vector<OperandPair> _cases;  // (value, label)
+public:
+    SwitchInst();
+
+    StringRef ty() const                                { return raw_field(RawField::Ty); }
+    StringRef condition() const                         { return raw_field(RawField::Value); }
+    StringRef default_label() const                     { return raw_field(RawField::DefaultLabel); }
+
+    const std::vector<OperandPair>& cases() const       { return _cases; }
+    void append_case(StringRef value, StringRef label)  { _cases.push_back(OperandPair{value, label}); }
+};
+
+#endif //LLPARSER_SWITCHINST_H
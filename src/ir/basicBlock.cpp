@@ -46,13 +46,13 @@ void BasicBlock::insert_instruction(int pos, Instruction *ins) {
     }
 }
 
-void BasicBlock::resolve_callinsts() {
+void BasicBlock::resolve_callinsts(std::vector<CallInstFamily*>* deferred) {
     for (auto I: callinst_list()) {
         if (I->is_indirect_call()) {
-            I->try_resolve_indirect_call();
+            I->try_resolve_indirect_call(deferred);
         }
         else {
-            I->resolve_direct_call();
+            I->resolve_direct_call(deferred);
         }
     }
 }
@@ -63,6 +63,9 @@ void BasicBlock::check_insertion_side_effects_on_module(Instruction* ins) {
         if (callee) {
             callee->append_user(ci);
         }
+        if (Module* m = inserted_module()) {
+            m->call_inserted(ci, callee);
+        }
     }
 }
 
@@ -72,6 +75,9 @@ void BasicBlock::check_deletion_side_effects_on_module(Instruction *ins) {
         if (callee) {
             callee->remove_user(ci);
         }
+        if (Module* m = inserted_module()) {
+            m->call_deleted(ci, callee);
+        }
     }
 }
 
@@ -188,6 +194,15 @@ Module* BasicBlock::module() const {
     return parent()->parent();
 }
 
+/**@brief The module of the block, or NULL if its function is not inserted yet
+ *
+ * The calls of a function that is not inserted yet reach the module's analyses when
+ * the function is inserted.
+ */
+Module* BasicBlock::inserted_module() const {
+    return parent() ? parent()->parent() : NULL;
+}
+
 /**@brief Returns a clone of this block.
  * Each instruction will be a new object instead of pointing to the old object.
  *
@@ -220,8 +235,10 @@ BasicBlock* BasicBlock::clone() {
 }
 
 void BasicBlock::print_to_stream(FILE *fp) {
-    if (!is_entry())
-        fprintf(fp, "%s\n", raw_text().c_str());
+    if (!is_entry()) {
+        raw_view().print_to(fp);
+        fputc('\n', fp);
+    }
 
     auto& l = _instruction_list;
     for (auto i = l.begin(); i != l.end(); ++i) {
@@ -231,7 +248,7 @@ void BasicBlock::print_to_stream(FILE *fp) {
 
 void BasicBlock::print_to_stream(std::ostream &os) {
     //if (!is_entry())
-        os << raw_text() << '\n';
+        os << raw_view() << '\n';
 
     for (auto i: instruction_list()) {
         i->print_to_stream(os);
@@ -44,7 +44,7 @@ public:
     bool insert_instruction_before(Instruction* old, Instruction* neu);
     bool insert_instruction_after(Instruction* old, Instruction* neu);
     bool insert_instruction_after(Instruction* old, InstList& neus);
-    void resolve_callinsts();
+    void resolve_callinsts(std::vector<CallInstFamily*>* deferred=NULL);
 
     void replace(iterator iter, Instruction* neu);
     void replace(Instruction* old, Instruction* neu);
@@ -55,6 +55,7 @@ public:
     Function* parent() const                              { return _parent; }
     void set_parent(Function* f)                          { _parent = f; }
     Module* module() const;
+    Module* inserted_module() const;
 
     bool is_entry()                                       { return _is_entry; }
     void set_is_entry(bool v=1)                           { _is_entry = v; }
@@ -63,6 +64,7 @@ public:
     void set_is_exit(bool v=1)                            { _is_exit = v; }
 
     void append_pred(string label)                        { _pred_labels.push_back(label); }
+    const std::vector<string>& pred_labels() const        { return _pred_labels; }
 
     /**@ Return a list of CallInstFamily* in this block, original order not guaranteed
      *
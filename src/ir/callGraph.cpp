@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <inst/callInstFamily.h>
+#include "../utilities/macros.h"
+#include "callGraph.h"
+#include "module.h"
+#include "function.h"
+#include "basicBlock.h"
+
+/**@brief Build the graph of @param module from the callers of its functions
+ *
+ * All lazily parsed functions are parsed first, since a call is only resolved when the
+ * function containing it is parsed.
+ */
+CallGraph::CallGraph(Module* module): _module(module), _frozen(false), _mark(0) {
+    module->materialize_all();
+    for (auto F: module->function_list()) {
+        node(F);
+    }
+    for (auto F: module->function_list()) {
+        for (auto ci: F->callers()) {
+            add_call(ci->function(), F);
+        }
+    }
+}
+
+CallGraph::Node CallGraph::node(Function* f) {
+    if (f->call_graph_node() == NONE) {
+        f->set_call_graph_node((Node)_functions.size());
+        _functions.push_back(f);
+        _frozen = false;
+    }
+    guarantee(_functions[f->call_graph_node()] == f, "function %s is in another call graph", f->name_as_c_str());
+    return f->call_graph_node();
+}
+
+/**@brief Add a function that was just inserted into the module, with the calls it makes
+ *
+ * Calls to the function are added as they are created.
+ */
+void CallGraph::add_function(Function* f) {
+    node(f);
+    if (_module->is_fully_resolved() && f->is_defined()) {
+        add_calls_of(f);
+    }
+}
+
+void CallGraph::add_calls_of(Function* f) {
+    for (auto bb: f->basic_block_list()) {
+        for (auto ci: bb->callinst_list()) {
+            if (Function* callee = ci->called_function()) {
+                add_call(f, callee);
+            }
+        }
+    }
+}
+
+void CallGraph::add_call(Function* caller, Function* callee) {
+    _edges[edge_key(node(caller), node(callee))]++;
+    _frozen = false;
+}
+
+void CallGraph::remove_call(Function* caller, Function* callee) {
+    auto it = _edges.find(edge_key(node(caller), node(callee)));
+    guarantee(it != _edges.end(), "no call from %s to %s", caller->name_as_c_str(), callee->name_as_c_str());
+    if (--it->second == 0) {
+        _edges.erase(it);
+    }
+    _frozen = false;
+}
+
+/**@brief Rebuild the snapshot if the live graph changed
+ *
+ * _edges is ordered by caller and then callee, so the callee rows come out sorted
+ * directly; the caller rows are filled by a counting sort over the same walk.
+ */
+void CallGraph::freeze() {
+    if (_frozen) {
+        return;
+    }
+
+    size_t n = _functions.size();
+    _callee_offsets.assign(n + 1, 0);
+    _caller_offsets.assign(n + 1, 0);
+    _callees.clear();
+    _callees.reserve(_edges.size());
+    for (auto& e: _edges) {
+        Node caller = (Node)(e.first >> 32);
+        Node callee = (Node)e.first;
+        _callee_offsets[caller + 1]++;
+        _caller_offsets[callee + 1]++;
+        _callees.push_back(callee);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        _callee_offsets[i + 1] += _callee_offsets[i];
+        _caller_offsets[i + 1] += _caller_offsets[i];
+    }
+
+    _callers.resize(_edges.size());
+    std::vector<uint32_t> next(_caller_offsets.begin(), _caller_offsets.end() - 1);
+    for (Node caller = 0; caller < n; ++caller) {
+        for (uint32_t i = _callee_offsets[caller]; i < _callee_offsets[caller + 1]; ++i) {
+            _callers[next[_callees[i]]++] = caller;
+        }
+    }
+
+    find_sccs();
+    _marks.assign(n, 0);
+    _mark = 0;
+    _frozen = true;
+}
+
+/**@brief Tarjan's algorithm, with an explicit stack so that deep call chains can't
+ * overflow the native one. Tarjan emits an SCC only after every SCC reachable from
+ * it, which is the reverse topological order.
+ */
+void CallGraph::find_sccs() {
+    static const uint32_t UNVISITED = UINT32_MAX;
+    struct Frame {
+        Node node;
+        uint32_t next_edge;
+    };
+
+    size_t n = _functions.size();
+    std::vector<uint32_t> index(n, UNVISITED);
+    std::vector<uint32_t> low(n);
+    std::vector<bool> on_stack(n, false);
+    std::vector<Node> stack;
+    std::vector<Frame> frames;
+    uint32_t counter = 0;
+
+    _scc_of.assign(n, 0);
+    _scc_offsets.assign(1, 0);
+    _scc_nodes.clear();
+    _scc_nodes.reserve(n);
+
+    for (Node root = 0; root < n; ++root) {
+        if (index[root] != UNVISITED) {
+            continue;
+        }
+
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        on_stack[root] = true;
+        frames.push_back(Frame{root, _callee_offsets[root]});
+
+        while (!frames.empty()) {
+            Frame& f = frames.back();
+            Node v = f.node;
+            if (f.next_edge < _callee_offsets[v + 1]) {
+                Node w = _callees[f.next_edge++];
+                if (index[w] == UNVISITED) {
+                    index[w] = low[w] = counter++;
+                    stack.push_back(w);
+                    on_stack[w] = true;
+                    frames.push_back(Frame{w, _callee_offsets[w]});
+                }
+                else if (on_stack[w]) {
+                    low[v] = std::min(low[v], index[w]);
+                }
+                continue;
+            }
+
+            if (low[v] == index[v]) {
+                uint32_t scc = (uint32_t)_scc_offsets.size() - 1;
+                Node w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    on_stack[w] = false;
+                    _scc_of[w] = scc;
+                    _scc_nodes.push_back(w);
+                } while (w != v);
+                _scc_offsets.push_back((uint32_t)_scc_nodes.size());
+            }
+
+            frames.pop_back();
+            if (!frames.empty()) {
+                Node u = frames.back().node;
+                low[u] = std::min(low[u], low[v]);
+            }
+        }
+    }
+}
+
+CallGraph::NodeRange CallGraph::range(const std::vector<uint32_t>& offsets, const std::vector<Node>& nodes, Node n) const {
+    return NodeRange{nodes.data() + offsets[n], nodes.data() + offsets[n + 1]};
+}
+
+CallGraph::NodeRange CallGraph::callees(Node n) {
+    freeze();
+    return range(_callee_offsets, _callees, n);
+}
+
+CallGraph::NodeRange CallGraph::callers(Node n) {
+    freeze();
+    return range(_caller_offsets, _callers, n);
+}
+
+/**@brief The number of calls from @param caller to @param callee */
+uint32_t CallGraph::call_sites(Node caller, Node callee) const {
+    auto it = _edges.find(edge_key(caller, callee));
+    return it == _edges.end() ? 0 : it->second;
+}
+
+/**@brief Whether @param n can reach itself */
+bool CallGraph::is_recursive(Node n) {
+    freeze();
+    uint32_t scc = _scc_of[n];
+    return _scc_offsets[scc + 1] - _scc_offsets[scc] > 1 || call_sites(n, n) > 0;
+}
+
+/**@brief Collect @param n and every function that reaches it through at most
+ * @param levels calls into @param out, nearest first
+ */
+void CallGraph::callers_within(Node n, int levels, std::vector<Node>& out) {
+    freeze();
+    if (++_mark == 0) {
+        std::fill(_marks.begin(), _marks.end(), 0);
+        _mark = 1;
+    }
+
+    size_t begin = out.size();
+    out.push_back(n);
+    _marks[n] = _mark;
+    for (int level = 0; level < levels; ++level) {
+        size_t end = out.size();
+        for (size_t i = begin; i < end; ++i) {
+            for (Node caller: callers(out[i])) {
+                if (_marks[caller] != _mark) {
+                    _marks[caller] = _mark;
+                    out.push_back(caller);
+                }
+            }
+        }
+        if (end == out.size()) {
+            break;
+        }
+        begin = end;
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef LLPARSER_CALLGRAPH_H
+#define LLPARSER_CALLGRAPH_H
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+class Module;
+class Function;
+
+/**@brief The call graph of a module
+ *
+ * Every function of the module is a node, numbered in the order it joined the graph.
+ * There is an edge from caller to callee for each pair that has at least one resolved
+ * call site, and the live graph counts the call sites of each edge. Module keeps the
+ * counts up to date as calls are inserted, deleted or redirected and as functions are
+ * inserted, so building the graph once is enough for the rest of the run.
+ *
+ * Traversals read a frozen snapshot instead: the callees and callers of each node in
+ * compressed sparse rows, plus the strongly connected components. The snapshot is
+ * rebuilt on the first query after the live graph changed. Ranges returned by the
+ * queries are valid until then.
+ *
+ * The SCCs are numbered in reverse topological order: an SCC comes after every SCC
+ * it calls into, so walking them by number visits callees before their callers.
+ */
+class CallGraph {
+public:
+    typedef uint32_t Node;
+    static const Node NONE = UINT32_MAX;
+
+    struct NodeRange {
+        const Node* _begin;
+        const Node* _end;
+
+        const Node* begin() const                           { return _begin; }
+        const Node* end() const                             { return _end; }
+        uint32_t size() const                               { return (uint32_t)(_end - _begin); }
+        bool empty() const                                  { return _begin == _end; }
+    };
+private:
+    Module* _module;
+    std::vector<Function*> _functions;                      // node -> function
+    std::map<uint64_t, uint32_t> _edges;                    // (caller << 32 | callee) -> call sites
+    bool _frozen;
+
+    /* the snapshot */
+    std::vector<uint32_t> _callee_offsets;
+    std::vector<Node> _callees;
+    std::vector<uint32_t> _caller_offsets;
+    std::vector<Node> _callers;
+    std::vector<uint32_t> _scc_of;
+    std::vector<uint32_t> _scc_offsets;
+    std::vector<Node> _scc_nodes;
+    std::vector<uint32_t> _marks;                           // visit marks of walks
+    uint32_t _mark;
+
+    static uint64_t edge_key(Node caller, Node callee)      { return (uint64_t)caller << 32 | callee; }
+    void freeze();
+    void find_sccs();
+    void add_calls_of(Function* f);
+    NodeRange range(const std::vector<uint32_t>& offsets, const std::vector<Node>& nodes, Node n) const;
+public:
+    CallGraph(Module* module);
+
+    Module* module() const                                  { return _module; }
+    uint32_t size() const                                   { return (uint32_t)_functions.size(); }
+    Function* function(Node n) const                        { return _functions[n]; }
+    Node node(Function* f);
+
+    /* live updates, see Module */
+    void add_function(Function* f);
+    void add_call(Function* caller, Function* callee);
+    void remove_call(Function* caller, Function* callee);
+
+    /* queries on the snapshot */
+    NodeRange callees(Node n);
+    NodeRange callers(Node n);
+    uint32_t call_sites(Node caller, Node callee) const;
+
+    uint32_t scc_count()                                    { freeze(); return (uint32_t)_scc_offsets.size() - 1; }
+    uint32_t scc_of(Node n)                                 { freeze(); return _scc_of[n]; }
+    NodeRange scc_members(uint32_t scc)                     { freeze(); return range(_scc_offsets, _scc_nodes, scc); }
+    NodeRange reverse_topological_order()                   { freeze(); return NodeRange{_scc_nodes.data(), _scc_nodes.data() + _scc_nodes.size()}; }
+    bool is_recursive(Node n);
+
+    void callers_within(Node n, int levels, std::vector<Node>& out);
+};
+
+#endif //LLPARSER_CALLGRAPH_H
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <climits>
+#include <inst/callInstFamily.h>
+#include <di/diLocation.h>
+#include "callSiteIndex.h"
+#include "module.h"
+#include "function.h"
+#include "basicBlock.h"
+
+/**@brief Index the calls of @param module, parsing its lazily parsed functions first */
+CallSiteIndex::CallSiteIndex(Module* module) {
+    module->materialize_all();
+    for (auto F: module->function_list()) {
+        if (F->is_defined()) {
+            add_calls_of(F);
+        }
+    }
+}
+
+void CallSiteIndex::add_calls_of(Function* f) {
+    for (auto bb: f->basic_block_list()) {
+        for (auto ci: bb->callinst_list()) {
+            add_call(ci);
+        }
+    }
+}
+
+/**@brief Index @param ci, if it has a location */
+void CallSiteIndex::add_call(CallInstFamily* ci) {
+    DILocation* loc = ci->debug_loc();
+    if (!loc) {
+        return;
+    }
+
+    Symbol name(loc->filename());
+    uint32_t f;
+    if (const uint32_t* found = _file_index.find(name)) {
+        f = *found;
+    }
+    else {
+        f = (uint32_t)_files.size();
+        _files.push_back(File{name, std::vector<Site>(), true});
+        _file_index.insert(name, f);
+        _query_files.clear();  // the new file may match names that were already asked for
+    }
+
+    File& file = _files[f];
+    Site site{loc->line(), ci};
+    if (!file.sites.empty() && site < file.sites.back()) {
+        file.sorted = false;
+    }
+    file.sites.push_back(site);
+}
+
+void CallSiteIndex::remove_call(CallInstFamily* ci) {
+    DILocation* loc = ci->debug_loc();
+    if (!loc) {
+        return;
+    }
+
+    if (const uint32_t* f = _file_index.find(Symbol::find(loc->filename()))) {
+        auto& sites = _files[*f].sites;
+        auto it = std::find_if(sites.begin(), sites.end(), [ci](const Site& s) { return s.call == ci; });
+        if (it != sites.end()) {
+            sites.erase(it);
+        }
+    }
+}
+
+const std::vector<uint32_t>& CallSiteIndex::files_in(const string& filename) {
+    auto it = _query_files.find(filename);
+    if (it != _query_files.end()) {
+        return it->second;
+    }
+
+    std::vector<uint32_t>& files = _query_files[filename];
+    for (uint32_t f = 0; f < _files.size(); ++f) {
+        if (filename.find(_files[f].name.str()) != string::npos) {
+            files.push_back(f);
+        }
+    }
+    return files;
+}
+
+CallSiteIndex::File& CallSiteIndex::sorted(uint32_t f) {
+    File& file = _files[f];
+    if (!file.sorted) {
+        std::sort(file.sites.begin(), file.sites.end());
+        file.sorted = true;
+    }
+    return file;
+}
+
+/**@brief Append the calls at most @param distance lines away from @param line, in the
+ * files that @param filename contains, to @param out
+ */
+void CallSiteIndex::sites_near(const string& filename, int line, int distance, std::vector<Site>& out) {
+    long long low = (long long)line - distance;
+    long long high = (long long)line + distance;
+    for (auto f: files_in(filename)) {
+        auto& sites = sorted(f).sites;
+        Site first{(int)std::max(low, (long long)INT_MIN), NULL};
+        for (auto it = std::lower_bound(sites.begin(), sites.end(), first);
+             it != sites.end() && it->line <= high; ++it) {
+            out.push_back(*it);
+        }
+    }
+}
+
+/**@brief The call nearest to @param line, at most @param distance lines away, that
+ * @param accept takes, in the files that @param filename contains
+ *
+ * Ties go to the lowest address, which is the order the passes used to break them in
+ * when they collected the candidates in a std::map.
+ *
+ * Each file is searched outwards from @param line, so only the calls that are nearer
+ * than the best one found so far are looked at.
+ */
+CallInstFamily* CallSiteIndex::nearest(const string& filename, int line, int distance, const Filter& accept) {
+    CallInstFamily* best = NULL;
+    long long best_offset = LLONG_MAX;
+    for (auto f: files_in(filename)) {
+        auto& sites = sorted(f).sites;
+        size_t hi = std::lower_bound(sites.begin(), sites.end(), Site{line, NULL}) - sites.begin();
+        size_t lo = hi;
+        while (true) {
+            long long hi_offset = hi < sites.size() ? (long long)sites[hi].line - line : LLONG_MAX;
+            long long lo_offset = lo > 0 ? (long long)line - sites[lo-1].line : LLONG_MAX;
+            long long offset = std::min(hi_offset, lo_offset);
+            if (offset == LLONG_MAX || offset > distance || offset > best_offset) {
+                break;
+            }
+
+            CallInstFamily* ci = hi_offset <= lo_offset ? sites[hi++].call : sites[--lo].call;
+            if ((offset < best_offset || ci < best) && accept(ci)) {
+                best = ci;
+                best_offset = offset;
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,62 @@
+#ifndef LLPARSER_CALLSITEINDEX_H
+#define LLPARSER_CALLSITEINDEX_H
+
+#include <functional>
+#include <map>
+#include <vector>
+#include "../utilities/symbol.h"
+#include "../utilities/symbolMap.h"
+
+class Module;
+class Function;
+class CallInstFamily;
+
+/**@brief The calls of a module by source location
+ *
+ * Every call that has a DILocation is filed under the interned file name and the line
+ * of that location, sorted by line, so the calls near a line take a binary search to
+ * find instead of a scan over all the callers of a function.
+ *
+ * A file name in a query, e.g. from a profile, matches every indexed file name it
+ * contains, the same way the clone passes have always matched them. Which indexed
+ * files a query name matches is computed once per query name.
+ *
+ * Module keeps the index up to date as calls and functions are inserted or deleted.
+ * Redirecting a call doesn't move it, so callers filter by callee at query time.
+ */
+class CallSiteIndex {
+public:
+    struct Site {
+        int line;
+        CallInstFamily* call;
+
+        bool operator<(const Site& o) const                 { return line != o.line ? line < o.line : call < o.call; }
+    };
+    typedef std::function<bool(CallInstFamily*)> Filter;
+private:
+    struct File {
+        Symbol name;
+        std::vector<Site> sites;
+        bool sorted;
+    };
+
+    std::vector<File> _files;
+    SymbolMap<uint32_t> _file_index;                        // name -> position in _files
+    std::map<string, std::vector<uint32_t>> _query_files;   // query name -> the files it contains
+
+    const std::vector<uint32_t>& files_in(const string& filename);
+    File& sorted(uint32_t f);
+public:
+    CallSiteIndex(Module* module);
+
+    bool empty() const                                      { return _files.empty(); }
+
+    void add_call(CallInstFamily* ci);
+    void remove_call(CallInstFamily* ci);
+    void add_calls_of(Function* f);
+
+    void sites_near(const string& filename, int line, int distance, std::vector<Site>& out);
+    CallInstFamily* nearest(const string& filename, int line, int distance, const Filter& accept);
+};
+
+#endif //LLPARSER_CALLSITEINDEX_H
@@ -7,6 +7,10 @@
 #include <asmParser/sysDict.h>
 #include <utilities/flags.h>
 #include <di/diSubprogram.h>
+#include <utilities/mutex.h>
+#include <utilities/textArena.h>
+#include <utilities/profiler.h>
+#include <asmParser/llParser.h>
 
 Function::Function(): Value() {
     _is_external = false;
@@ -16,8 +20,91 @@ Function::Function(): Value() {
     _dbg_id = -1;
     _di_subprogram = NULL;
     _is_clone = false;
+    _lazy_body = NULL;
+    _call_graph_node = CallGraph::NONE;
 }
 
+/* a member-wise copy for clone(), which only copies materialized functions */
+Function::Function(const Function& f): Value(f) {
+    _is_external = f._is_external;
+    _is_defined = f._is_defined;
+    _parent = f._parent;
+    _basic_block_list = f._basic_block_list;
+    _entry_block = f._entry_block;
+    _dbg_id = f._dbg_id;
+    _di_subprogram = f._di_subprogram;
+    _is_clone = f._is_clone;
+    _lazy_body = f._lazy_body.load();
+    _call_graph_node = f._call_graph_node;
+}
+
+/**@brief Parse the body of a lazily parsed function
+ *
+ * The body is parsed into a scratch function first, so that the blocks only
+ * become visible once they are complete. If the module's calls are already
+ * resolved, the calls in the new body are resolved too.
+ *
+ * Only the function's own lock is held while parsing, so bodies of any functions
+ * parse at the same time, as with ParallelFunctionParsing. Their text and objects
+ * go to an arena of their own, which joins the module's arena under its object
+ * lock, together with the resolution of the calls, which changes the users of
+ * the callees.
+ */
+void Function::materialize() {
+    if (is_materialized()) {
+        return;
+    }
+
+    ScopedPhase phase("materialize");
+    _materialize_lock.lock();
+    if (_lazy_body) {
+        Function scratch;
+        scratch.set_name(name());
+        TextArena* current = TextArena::current();
+        if (module()) {
+            TextArena arena;
+            TextArena::set_current(&arena);
+            {
+                TextArena::ObjectScope objects(&arena);
+                LLParser parser;
+                parser.parse_lazy_body(&scratch, _lazy_body);
+            }
+            TextArena::set_current(current);
+            take_blocks(scratch);
+
+            module()->object_lock().lock();
+            module()->text_arena().adopt(&arena);
+            if (module()->is_fully_resolved()) {
+                for (auto bb: _basic_block_list) {
+                    bb->resolve_callinsts();
+                }
+            }
+            module()->object_lock().unlock();
+        }
+        else {
+            LLParser parser;
+            parser.parse_lazy_body(&scratch, _lazy_body);
+            take_blocks(scratch);
+        }
+
+        /* publish the blocks to the threads that check is_materialized() without the lock */
+        LazyBody* body = _lazy_body;
+        _lazy_body.store(NULL, std::memory_order_release);
+        delete body;
+    }
+    _materialize_lock.unlock();
+}
+
+/* move the blocks parsed into @param scratch to this function */
+void Function::take_blocks(Function& scratch) {
+    for (auto bb: scratch._basic_block_list) {
+        bb->set_parent(this);
+    }
+    _basic_block_list.swap(scratch._basic_block_list);
+    _entry_block = scratch._entry_block;
+}
+
+
 BasicBlock* Function::create_basic_block(string label) {
     BasicBlock* bb = create_basic_block();
     bb->set_name(label);
@@ -32,7 +119,7 @@ BasicBlock* Function::create_basic_block() {
 }
 
 int Function::get_basic_block_index(BasicBlock *bb) {
-    auto& l = _basic_block_list;
+    auto& l = basic_block_list();
     if (l.empty()) {
         return -1;
     }
@@ -42,23 +129,68 @@ int Function::get_basic_block_index(BasicBlock *bb) {
 }
 
 Instruction* Function::get_instruction(int bi, int ii) {
-    BasicBlock* bb = _basic_block_list.at(bi);
+    BasicBlock* bb = basic_block_list().at(bi);
     return bb->instruction_list().at(ii);
 }
 
 Instruction* Function::get_instruction(Point2D<int> &pos) {
-    BasicBlock* bb = _basic_block_list.at(pos.x);
+    BasicBlock* bb = basic_block_list().at(pos.x);
     return bb->instruction_list().at(pos.y);
 }
 
-std::vector<CallInstFamily*> Function::caller_list() {
-    std::vector<CallInstFamily*> callers;
-    for (auto I: user_set()) {
-        if (CallInstFamily* ci = dynamic_cast<CallInstFamily*>(I)) {
-            callers.push_back(ci);
+/**@brief Free the basic blocks and instructions of this function
+ *
+ * The function becomes empty. Calls in the body must not be resolved,
+ * since the callees are not told.
+ */
+void Function::delete_body() {
+    if (LazyBody* body = _lazy_body.exchange(NULL)) {
+        delete body;
+    }
+
+    for (auto bb: _basic_block_list) {
+        for (auto I: bb->instruction_list()) {
+            delete I;
         }
+        delete bb;
     }
-    return callers;
+    _basic_block_list.clear();
+    _entry_block = NULL;
+}
+
+/**@brief The users of this function, after all calls to it are resolved
+ *
+ * A call is only resolved when the function that contains it is parsed, so all
+ * lazily parsed functions of the module are parsed first. Value::users() gives
+ * the calls resolved so far.
+ */
+UserList& Function::resolved_users() {
+    if (module()) {
+        module()->materialize_all();
+    }
+    return Value::users();
+}
+
+/**@brief The calls to this function, without copying them */
+CallerRange Function::callers() {
+    return CallerRange(resolved_users());
+}
+
+/**@brief A copy of the calls to this function, for loops that change them */
+std::vector<CallInstFamily*> Function::caller_list() {
+    std::vector<CallInstFamily*> list;
+    for (auto ci: callers()) {
+        list.push_back(ci);
+    }
+    return list;
+}
+
+size_t CallerRange::size() const {
+    size_t n = 0;
+    for (auto it = begin(); it != end(); ++it) {
+        n++;
+    }
+    return n;
 }
 
 std::size_t Function::instruction_count() {
@@ -98,9 +230,11 @@ std::size_t Function::instruction_count() {
  */
 //todo: may need to create a Function from scratch
 Function* Function::clone(string new_name) {
+    materialize();
     Function* copy = new Function(*this);
     copy->set_parent(NULL);
-    copy->user_set().clear();
+    copy->users().clear();
+    copy->set_call_graph_node(CallGraph::NONE);
     if (is_defined()) {
         for (auto it = copy->begin(); it != copy->end(); ++it) {
             // don't delete the old basic block, it is still used by the original function
@@ -158,7 +292,7 @@ Function* Function::clone(string new_name) {
 void Function::rename(string name) {
     if (parent() == NULL) {
         string& raw = raw_text();
-        string old = '@' + _name;
+        string old = '@' + _name.str();
         string neu = '@' + name;
         Strings::ireplace(raw, old, neu);
         _name = name;
@@ -171,10 +305,16 @@ void Function::rename(string name) {
 void Function::print_to_stream(FILE *fp) {
     fprintf(fp, ";\n");
     if (is_external()) {
-        fprintf(fp, "%s\n", raw_text().c_str());
+        raw_view().print_to(fp);
+        fputc('\n', fp);
     }
     else {
-        fprintf(fp, "%s {\n", raw_text().c_str());
+        raw_view().print_to(fp);
+        fputs(" {\n", fp);
+        if (_lazy_body) {
+            print_lazy_body(fp);
+            return;
+        }
         //fprintf(fp, "%s\n", raw_text().c_str());
         auto l = _basic_block_list;
         for (int i = 0; i < l.size(); ++i) {
@@ -191,10 +331,14 @@ void Function::print_to_stream(FILE *fp) {
 void Function::print_to_stream(std::ostream& os) {
     os << ";\n";
     if (is_external()) {
-        os << raw_text() << '\n';
+        os << raw_view() << '\n';
     }
     else {
-        os << raw_text() << " {\n";
+        os << raw_view() << " {\n";
+        if (_lazy_body) {
+            print_lazy_body(os);
+            return;
+        }
         for (auto i: basic_block_list()) {
             i->print_to_stream(os);
         }
@@ -203,6 +347,26 @@ void Function::print_to_stream(std::ostream& os) {
 }
 
 
+/**@brief Print the body of a function that is not parsed yet as it is in the input
+ *
+ * The body includes the closing '}'.
+ */
+void Function::print_lazy_body(FILE *fp) {
+    LazyBody* body = _lazy_body;
+    fwrite(body->begin, 1, body->end - body->begin, fp);
+    if (body->end[-1] != '\n') {
+        fputc('\n', fp);
+    }
+}
+
+void Function::print_lazy_body(std::ostream &os) {
+    LazyBody* body = _lazy_body;
+    os.write(body->begin, body->end - body->begin);
+    if (body->end[-1] != '\n') {
+        os << '\n';
+    }
+}
+
 DISubprogram* Function::di_subprogram() {
     /* Cloned functions cloned the _di_subprogram from their prototype,
      * but the dbg_id is set to -1
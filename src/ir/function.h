@@ -10,7 +10,10 @@
 #include "instruction.h"
 #include "basicBlock.h"
 #include <vector>
+#include <atomic>
 #include <inst/callInstFamily.h>
+#include "callGraph.h"
+#include "../utilities/mutex.h"
 
 class BasicBlock;
 class Module;
@@ -19,7 +22,53 @@ class Instruction;
 class CallInst;
 
 class DISubprogram;
+class MappedFile;
+
+/**@brief Where the body of a function that is not parsed yet is in the mapped input
+ *
+ * [begin, end) starts at the line after the header and includes the closing '}' line.
+ */
+struct LazyBody {
+    MappedFile* file;
+    const char* begin;
+    const char* end;
+    long long line_before;  // line number of the header
+};
 
+/**@brief The calls among the users of a function
+ *
+ * Iterates the user list in place, so the list must not change during the iteration.
+ * A loop that adds or removes callers, e.g. by replace_callee(), should iterate a
+ * copy from Function::caller_list() instead.
+ */
+class CallerRange {
+    UserList::const_iterator _begin;
+    UserList::const_iterator _end;
+public:
+    class iterator {
+        UserList::const_iterator _p;
+        UserList::const_iterator _end;
+
+        void skip() {
+            while (_p != _end && (*_p)->type() != Instruction::CallInstType
+                   && (*_p)->type() != Instruction::InvokeInstType) {
+                ++_p;
+            }
+        }
+    public:
+        iterator(UserList::const_iterator p, UserList::const_iterator end): _p(p), _end(end)    { skip(); }
+        CallInstFamily* operator*() const                   { return static_cast<CallInstFamily*>(*_p); }
+        iterator& operator++()                              { ++_p; skip(); return *this; }
+        bool operator!=(const iterator& o) const            { return _p != o._p; }
+        bool operator==(const iterator& o) const            { return _p == o._p; }
+    };
+
+    CallerRange(const UserList& users): _begin(users.begin()), _end(users.end()) {}
+    iterator begin() const                                  { return iterator(_begin, _end); }
+    iterator end() const                                    { return iterator(_end, _end); }
+    bool empty() const                                      { return begin() == end(); }
+    size_t size() const;
+};
 
 class Function: public Value {
     Module* _parent;
@@ -31,16 +80,29 @@ class Function: public Value {
     DISubprogram* _di_subprogram;
 
     bool _is_clone;
+    std::atomic<LazyBody*> _lazy_body;  // NULL once the body is parsed, stored with release order
+    Mutex _materialize_lock;  // held while the body is parsed
+    CallGraph::Node _call_graph_node;
+
+    void print_lazy_body(FILE* fp);
+    void print_lazy_body(std::ostream& os);
+    void take_blocks(Function& scratch);
 public:
     Function();
+    Function(const Function& f);
 
     typedef std::vector<BasicBlock*>::iterator iterator;
-    std::vector<BasicBlock*>& basic_block_list()           { return _basic_block_list; }
+    std::vector<BasicBlock*>& basic_block_list()           { if (!is_materialized()) materialize(); return _basic_block_list; }
+
+    iterator begin()                                       { return basic_block_list().begin(); }
+    iterator end()                                         { return basic_block_list().end(); }
 
-    iterator begin()                                       { return _basic_block_list.begin(); }
-    iterator end()                                         { return _basic_block_list.end(); }
+    void append_basic_block(BasicBlock* bb)                { basic_block_list().push_back(bb); }
 
-    void append_basic_block(BasicBlock* bb)                { _basic_block_list.push_back(bb); }
+    /* lazy parsing */
+    bool is_materialized()                                 { return _lazy_body.load(std::memory_order_acquire) == NULL; }
+    void set_lazy_body(LazyBody* body)                     { _lazy_body = body; }
+    void materialize();
     bool is_external()                                     { return _is_external; }
     void set_is_external()                                 { _is_external = true; }
 
@@ -60,19 +122,26 @@ public:
     BasicBlock* create_basic_block(string label);
     BasicBlock* create_basic_block();
 
-    BasicBlock* entry_block()                              { return _entry_block; }
+    BasicBlock* entry_block()                              { if (!is_materialized()) materialize(); return _entry_block; }
     void set_entry_block(BasicBlock* bb)                   { _entry_block = bb; }
 
-    int basic_block_num()                                  { return _basic_block_list.size(); }
+    int basic_block_num()                                  { return basic_block_list().size(); }
 
     int get_basic_block_index(BasicBlock* bb);
     Instruction* get_instruction(int bi, int ii);
     Instruction* get_instruction(Point2D<int> &pos);
     std::size_t instruction_count();
 
+    UserList& resolved_users();
+    CallerRange callers();
     std::vector<CallInstFamily*> caller_list();
 
+    /* node in the module's CallGraph, NONE until the function joins it */
+    CallGraph::Node call_graph_node()                      { return _call_graph_node; }
+    void set_call_graph_node(CallGraph::Node n)            { _call_graph_node = n; }
+
     Function* clone(string new_name="");
+    void delete_body();
     void rename(string name);
 
     void print_to_stream(FILE* fp);
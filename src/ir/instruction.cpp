@@ -7,6 +7,7 @@
 #include "irEssential.h"
 #include <inst/instEssential.h>
 #include <di/diEssential.h>
+#include <new>
 
 Instruction::Instruction(): Value() {
     //_parser = SysDict::instParser;  // for synchronous inst parsing
@@ -17,6 +18,47 @@ Instruction::Instruction(): Value() {
     _debug_loc = NULL;
 }
 
+/**@brief Allocate a name the way the instruction itself is allocated, see Shadow::operator new
+ *
+ * The arena only gives the memory back with the module, the destructor of the instruction
+ * frees what a long name has allocated.
+ */
+string* LocalName::make(const string& s) {
+    return new (Shadow::operator new(sizeof(string))) string(s);
+}
+
+LocalName& LocalName::operator=(const LocalName& other) {
+    if (this != &other) {
+        if (other._str) {
+            set(*other._str);
+        }
+        else if (_str) {
+            _str->clear();
+        }
+    }
+    return *this;
+}
+
+LocalName::~LocalName() {
+    if (_str) {
+        _str->~string();
+    }
+}
+
+const string& LocalName::str() const {
+    static const string empty;
+    return _str ? *_str : empty;
+}
+
+void LocalName::set(const string& s) {
+    if (_str) {
+        *_str = s;
+    }
+    else {
+        _str = make(s);
+    }
+}
+
 Function* Instruction::function() {
     if (parent()) {
         return parent()->parent();
@@ -79,6 +121,27 @@ Instruction* Instruction::clone() {
         case Instruction::BitCastInstType:
             i = new BitCastInst(*dynamic_cast<BitCastInst*>(this));
             break;
+        case Instruction::GetElementPtrInstType:
+            i = new GetElementPtrInst(*dynamic_cast<GetElementPtrInst*>(this));
+            break;
+        case Instruction::PhiInstType:
+            i = new PhiInst(*dynamic_cast<PhiInst*>(this));
+            break;
+        case Instruction::CmpInstType:
+            i = new CmpInst(*dynamic_cast<CmpInst*>(this));
+            break;
+        case Instruction::BinaryInstType:
+            i = new BinaryInst(*dynamic_cast<BinaryInst*>(this));
+            break;
+        case Instruction::CastInstType:
+            i = new CastInst(*dynamic_cast<CastInst*>(this));
+            break;
+        case Instruction::ReturnInstType:
+            i = new ReturnInst(*dynamic_cast<ReturnInst*>(this));
+            break;
+        case Instruction::SwitchInstType:
+            i = new SwitchInst(*dynamic_cast<SwitchInst*>(this));
+            break;
         default:
             i = new Instruction(*this);
     }
@@ -87,11 +150,11 @@ Instruction* Instruction::clone() {
 }
 
 void Instruction::print_to_stream(std::ostream &os) {
-    string& text = raw_text();
-    if (!(text[0] == ' ' && text[1] == ' ')) {
-        text = "  " + text;
+    StringRef text = raw_view();
+    if (!(text.size() >= 2 && text[0] == ' ' && text[1] == ' ')) {
+        raw_text() = "  " + raw_text();
     }
-    os << raw_text() << std::endl;
+    os << raw_view() << std::endl;
 }
 
 void Instruction::print_to_stream(FILE *fp) {
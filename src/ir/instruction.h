@@ -16,6 +16,33 @@ class DILocation;
 
 class InstParser;
 
+/**@brief Two operands that belong together, such as an incoming value of a phi and its block
+ *
+ */
+struct OperandPair {
+    StringRef first;
+    StringRef second;
+};
+
+/**@brief The name of an instruction, placed in the arena of its module next to the instruction
+ *
+ * Local names hardly repeat (%call.i4.i93, %123), so unlike the names of globals, functions and
+ * blocks they are not interned in the process-wide Symbol table, which is never freed.
+ */
+class LocalName {
+    string* _str;  // NULL if unnamed
+
+    static string* make(const string& s);
+public:
+    LocalName(): _str(NULL) {}
+    LocalName(const LocalName& other): _str(other._str ? make(*other._str) : NULL) {}
+    LocalName& operator=(const LocalName& other);
+    ~LocalName();
+
+    const string& str() const;
+    void set(const string& s);
+};
+
 class Instruction: public Value {
 public:
     enum InstType {
@@ -28,25 +55,37 @@ public:
         InvokeInstType,
         BitCastInstType,
         GetElementPtrInstType,
+        PhiInstType,
+        CmpInstType,
+        BinaryInstType,
+        CastInstType,
+        ReturnInstType,
+        SwitchInstType,
     };
 
 protected:
     InstParser* _parser;
     InstType _type;
-    string _opcode;
+    Symbol _opcode;
     BasicBlock* _parent;
     bool _has_assignment;
     int _dbg_id;
     DILocation* _debug_loc;
-    string _owner;  // mainly for debug
+    Symbol _owner;  // mainly for debug
+    LocalName _local_name;
 public:
     Instruction();
 
-    const string& opcode()                    { return _opcode; }
-    void set_opcode(string op)                { _opcode = op; }
+    const string& name() const override       { return _local_name.str(); }
+    const char* name_as_c_str() const override  { return _local_name.str().c_str(); }
+    void set_name(string name) override       { _local_name.set(name); }
+
+    const string& opcode()                    { return _opcode.str(); }
+    Symbol opcode_symbol()                    { return _opcode; }
+    void set_opcode(Symbol op)                { _opcode = op; }
 
-    string owner()                            { return _owner; }  // unsafe
-    void set_owner(string owner)              { _owner = owner; }
+    string owner()                            { return _owner.str(); }  // unsafe
+    void set_owner(Symbol owner)              { _owner = owner; }
 
     InstParser* parser()                      { return _parser; }
 
@@ -12,6 +12,8 @@
 #include "globalVariable.h"
 #include "alias.h"
 #include "function.h"
+#include "callGraph.h"
+#include "callSiteIndex.h"
 #include "basicBlock.h"
 #include "instruction.h"
 #include "attribute.h"
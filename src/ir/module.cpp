@@ -2,6 +2,7 @@
 // Created by GentlyGuitar on 6/6/2017.
 //
 
+#include <algorithm>
 #include <thread>
 #include "irEssential.h"
 #include <inst/instEssential.h>
@@ -9,6 +10,9 @@
 #include <utilities/flags.h>
 #include <asmParser/sysDict.h>
 #include <asmParser/llParser.h>
+#include <utilities/workerPool.h>
+#include <utilities/profiler.h>
+#include <utilities/systems.h>
 
 string Module::get_header(string key) {
      if (_headers.find(key) == _headers.end()) {
@@ -19,6 +23,65 @@ string Module::get_header(string key) {
      }
 }
 
+/**@brief Destroy the module with everything in it
+ *
+ * The destructors of the IR objects only free what the objects own outside of
+ * the arena (e.g. their instruction lists), the objects themselves and all raw
+ * text are released with the arena, a chunk at a time.
+ */
+Module::~Module() {
+    delete _stream;
+    delete _call_graph.load();
+    delete _call_site_index.load();
+
+    for (auto f: _function_list) {
+        f->delete_body();
+        delete f;
+    }
+    for (auto gv: _global_list)                 { delete gv; }
+    for (auto& it: _alias_map)                  { delete it.second; }
+    for (auto st: _struct_list)                 { delete st; }
+    for (auto cd: _comdat_list)                 { delete cd; }
+    for (auto attr: _attribute_list)            { delete attr; }
+    for (auto& it: _named_metadata_map)         { delete it.second; }
+    for (auto md: _unnamed_metadata_list)       { delete md; }
+}
+
+/**@brief Allocate an IR object in the arena of this module from any thread
+ *
+ * Objects the parser creates take the unlocked path of TextArena::ObjectScope instead.
+ */
+void* Module::allocate_object(size_t size) {
+    _object_lock.lock();
+    void* p = _text_arena.allocate_object(size);
+    _object_lock.unlock();
+    return p;
+}
+
+/**@brief Forget all entities without destroying them, for when another module has taken them over
+ *
+ */
+void Module::drop_contents() {
+    if (CallGraph* cg = _call_graph.exchange(NULL)) {
+        for (uint32_t n = 0; n < cg->size(); ++n) {
+            cg->function(n)->set_call_graph_node(CallGraph::NONE);
+        }
+        delete cg;
+    }
+    delete _call_site_index.exchange(NULL);
+    _struct_list.clear();
+    _comdat_list.clear();
+    _global_list.clear();
+    _alias_map.clear();
+    _alias_index.clear();
+    _function_list.clear();
+    _function_map.clear();
+    _value_map.clear();
+    _attribute_list.clear();
+    _named_metadata_map.clear();
+    _unnamed_metadata_list.clear();
+}
+
 // Globals
 void Module::append_new_global(string text) {
     LLParser* parser = SysDict::parser;
@@ -26,24 +89,14 @@ void Module::append_new_global(string text) {
     parser->parse_global(this);
 }
 
-Function* Module::get_function(string key) {
+Function* Module::get_function(Symbol key) {
     // todo: here it assumes an aliasee must be a Function, which seems
     // ok for now but may not always be true
     if (Alias* alias = get_alias(key)) {
         return dynamic_cast<Function*>(alias->aliasee());
     }
-//
-//    if (_function_map.find(key) == _function_map.end()) {
-//        return NULL;
-//    } else {
-//        return _function_map[key];
-//    }
 
-    if (_value_map.find(key) == _value_map.end()) {
-        return NULL;
-    } else {
-        return dynamic_cast<Function*>(_value_map[key]);
-    }
+    return dynamic_cast<Function*>(_value_map.get(key));
 }
 
 Function* Module::get_function_by_orig_name(string key) {
@@ -66,19 +119,13 @@ Function* Module::get_function_by_orig_name(string key) {
 void Module::add_global_variable(GlobalVariable* gv) {
     _global_list.push_back(gv);
     guarantee(!gv->name().empty(), "");
-    if (_value_map.find(gv->name()) != _value_map.end()) {
+    if (!_value_map.insert(gv->name_symbol(), gv)) {
         throw SymbolRedefinitionError(gv->name());
     }
-    _value_map[gv->name()] = gv;
 }
 
 GlobalVariable* Module::get_global_variable(string name) {
-    if (_value_map.find(name) != _value_map.end()) {
-        return dynamic_cast<GlobalVariable*>(_value_map[name]);
-    }
-    else {
-        return NULL;
-    }
+    return dynamic_cast<GlobalVariable*>(_value_map.get(name));
 }
 
 void Module::set_as_resolved(Function *f) {
@@ -99,7 +146,7 @@ void Module::insert_new_function(int pos, Function *inserted) {
     guarantee(inserted != NULL, "inserted function is NULL");
     guarantee(inserted->parent() == NULL, "inserted function already belong to a module");
 
-    if (get_function(inserted->name())) {
+    if (get_function(inserted->name_symbol())) {
         string msg = "invalid redefinition of function "+ inserted->name();
         throw SymbolRedefinitionError(msg);
     }
@@ -119,7 +166,15 @@ void Module::insert_new_function(int pos, Function *inserted) {
     l.insert(l.begin()+pos, inserted);
     inserted->set_parent(this);
     //_function_map[inserted->name()] = inserted;
-    _value_map[inserted->name()] = inserted;
+    _value_map.set(inserted->name_symbol(), inserted);
+
+    if (CallGraph* cg = call_graph_if_built()) {
+        cg->add_function(inserted);
+    }
+    CallSiteIndex* index = _call_site_index.load(std::memory_order_acquire);
+    if (index && inserted->is_defined()) {
+        index->add_calls_of(inserted);
+    }
 }
 
 void Module::insert_function_before(Function *old, Function *inserted) {
@@ -163,6 +218,7 @@ MetaData* Module::get_debug_info(int i) {
 }
 
 void Module::resolve_debug_info() {
+    ScopedPhase phase("resolve_debug_info");
     std::vector<DILocation*> more;
     for (auto i: unnamed_metadata_list()) {
         i->resolve_refs();
@@ -186,18 +242,138 @@ void Module::resolve_debug_info() {
 //    }
 }
 
+/**@brief Parse the bodies of all functions that are not parsed yet
+ *
+ * Needed before anything that has to see every instruction of the module, such as the
+ * complete set of callers of a function. Threads that call it while another thread is
+ * parsing the bodies wait until all of them are parsed.
+ */
+void Module::materialize_all() {
+    if (!has_lazy_functions()) {
+        return;
+    }
+    Tracer::lock(&_materialize_all_lock, "materialize_all_lock");
+    if (_has_lazy_functions.load(std::memory_order_relaxed)) {
+        for (auto F: function_list()) {
+            F->materialize();
+        }
+        _has_lazy_functions.store(false, std::memory_order_release);
+    }
+    _materialize_all_lock.unlock();
+}
+
+/**@brief The call graph of this module, built on first use and kept up to date after that
+ *
+ * Threads that ask while another thread builds it wait for that one.
+ */
+CallGraph& Module::call_graph() {
+    CallGraph* cg = _call_graph.load(std::memory_order_acquire);
+    if (!cg) {
+        Tracer::lock(&_call_graph_lock, "call_graph_lock");
+        cg = _call_graph.load(std::memory_order_relaxed);
+        if (!cg) {
+            cg = new CallGraph(this);
+            _call_graph.store(cg, std::memory_order_release);
+        }
+        _call_graph_lock.unlock();
+    }
+    return *cg;
+}
+
+/**@brief The calls of this module by source location, built on first use and kept up to date after that
+ *
+ * Threads that ask while another thread builds it wait for that one.
+ */
+CallSiteIndex& Module::call_site_index() {
+    CallSiteIndex* index = _call_site_index.load(std::memory_order_acquire);
+    if (!index) {
+        Tracer::lock(&_call_site_index_lock, "call_site_index_lock");
+        index = _call_site_index.load(std::memory_order_relaxed);
+        if (!index) {
+            index = new CallSiteIndex(this);
+            _call_site_index.store(index, std::memory_order_release);
+        }
+        _call_site_index_lock.unlock();
+    }
+    return *index;
+}
+
+/**@brief Update the analyses that are built after @param ci is inserted into a function of this module
+ *
+ * @param callee: the function @param ci calls, NULL if unresolved
+ */
+void Module::call_inserted(CallInstFamily* ci, Function* callee) {
+    CallGraph* cg = call_graph_if_built();
+    if (cg && callee) {
+        cg->add_call(ci->function(), callee);
+    }
+    if (CallSiteIndex* index = _call_site_index.load(std::memory_order_acquire)) {
+        index->add_call(ci);
+    }
+}
+
+void Module::call_deleted(CallInstFamily* ci, Function* callee) {
+    CallGraph* cg = call_graph_if_built();
+    if (cg && callee) {
+        cg->remove_call(ci->function(), callee);
+    }
+    if (CallSiteIndex* index = _call_site_index.load(std::memory_order_acquire)) {
+        index->remove_call(ci);
+    }
+}
+
+/**@brief Resolve the calls in all parsed functions
+ *
+ * Functions that are not parsed yet resolve their calls when they are parsed.
+ *
+ * With ParallelResolution the functions are split into contiguous slices that are
+ * resolved on a pool of threads. Resolving a call only writes the call itself and
+ * reads the module's symbol tables, so the slices don't interfere. The calls are
+ * added to the users of their callees afterwards on this thread, slice by slice in
+ * the original order, so the result doesn't depend on the scheduling.
+ */
 void Module::resolve_callinsts() {
+    ScopedPhase phase("resolve_callinsts");
+    std::vector<Function*> functions;
     for (auto F: function_list()) {
-        for (auto B: F->basic_block_list()) {
-            B->resolve_callinsts();
-//            for (auto I: B->callinst_list()) {
-//                if (I->is_indirect_call()) {
-//                    I->try_resolve_indirect_call();
-//                }
-//                else {
-//                    I->resolve_direct_call();
-//                }
-//            }
+        if (F->is_materialized()) {
+            functions.push_back(F);
+        }
+    }
+
+    const size_t min_functions_per_slice = 16;
+    if (!ParallelResolution || functions.size() < 2 * min_functions_per_slice) {
+        for (auto F: functions) {
+            for (auto B: F->basic_block_list()) {
+                B->resolve_callinsts();
+            }
+        }
+        return;
+    }
+
+    WorkerPool pool(ParsingThreads);
+    size_t nslices = std::min(functions.size() / min_functions_per_slice, (size_t)pool.size() * 4);
+    std::vector<std::vector<CallInstFamily*>> resolved(nslices);
+    for (size_t i = 0; i < nslices; ++i) {
+        size_t begin = functions.size() * i / nslices;
+        size_t end = functions.size() * (i+1) / nslices;
+        std::vector<CallInstFamily*>* calls = &resolved[i];
+        Function** slice = functions.data();
+        Module* module = this;
+        pool.submit([=] {
+            ModuleContext context(module);
+            for (size_t f = begin; f < end; ++f) {
+                for (auto B: slice[f]->basic_block_list()) {
+                    B->resolve_callinsts(calls);
+                }
+            }
+        });
+    }
+    pool.wait();
+
+    for (auto& calls: resolved) {
+        for (auto ci: calls) {
+            ci->called_function()->append_user(ci);
         }
     }
 }
@@ -205,7 +381,7 @@ void Module::resolve_callinsts() {
 void Module::resolve_aliases() {
     for (auto it: _alias_map) {
         Alias* a = it.second;
-        Function* f = get_function(a->get_raw_field("aliasee"));
+        Function* f = get_function(a->get_raw_field(RawField::Aliasee));
         guarantee(f, " ");
         a->set_aliasee(f);
     }
@@ -217,6 +393,7 @@ void Module::resolve_callinsts_and_aliases() {
 }
 
 void Module::resolve_after_parse() {
+    ScopedPhase phase("resolve_after_parse");
     if (1) {
     //if (ParallelModule) {
         std::thread t1(&Module::resolve_debug_info, this);
@@ -234,6 +411,15 @@ void Module::resolve_after_parse() {
 }
 
 void Module::print_to_stream(std::ostream &os) {
+    print_leading_sections(os);
+    for (auto i: function_list()) { os << i; }         os << '\n';
+    print_trailing_sections(os);
+}
+
+/**@brief Print everything before the functions
+ *
+ */
+void Module::print_leading_sections(std::ostream &os) {
     os << "; ModuleID = '" << module_id() << "'\n";
     for (auto pair: headers()) {
         os << pair.first << " = \"" << pair.second << "\"\n";
@@ -251,7 +437,12 @@ void Module::print_to_stream(std::ostream &os) {
     for (auto i: comdat_list()) { os << i; }           os << '\n';
     for (auto i: global_list()) { os << i; }           os << '\n';
     for (auto i: alias_map()) { os << i.second; }      os << '\n';
-    for (auto i: function_list()) { os << i; }         os << '\n';
+}
+
+/**@brief Print everything after the functions
+ *
+ */
+void Module::print_trailing_sections(std::ostream &os) {
     for (auto i: attribute_list()) { os << i; }        os << '\n';
     for (auto i: named_metadata_map()) { os << i.second; }        os << '\n';
     for (auto i: unnamed_metadata_list()) { os << i; }            os << '\n';
@@ -315,6 +506,78 @@ void Module::print_to_stream(FILE *fp) {
     }
 }
 
+/**@brief In streaming mode, finish the streamed output instead of printing the module again
+ *
+ * The functions of a streaming module are already written to the stream and
+ * freed, so the module can only be printed to the file it streams to.
+ */
+void Module::print_to_file(const char* file) {
+    ScopedPhase phase("print");
+    if (!is_streaming()) {
+        Value::print_to_file(file);
+        return;
+    }
+
+    guarantee(_stream_file == file, "module is streamed to %s, cannot print it to %s",
+              _stream_file.c_str(), file);
+    end_streaming();
+}
+
+/**@brief Open @param file and print everything before the functions to it
+ *
+ * The functions are written by stream_function() as they are parsed. The rest
+ * of the module is written by end_streaming().
+ */
+void Module::begin_streaming(const string& file) {
+    guarantee(!is_streaming(), "module is already streamed to %s", _stream_file.c_str());
+    /* @param file may be the mapped input, which must stay intact until the end */
+    _stream_path = Systems::output_path_for(file);
+    _stream = new std::ofstream(_stream_path);
+    guarantee(_stream->good(), "open file %s failed", _stream_path.c_str());
+    _stream_file = file;
+    print_leading_sections(*_stream);
+}
+
+/**@brief Write @param f to the stream, then remove it from the module and free it
+ *
+ */
+void Module::stream_function(Function* f) {
+    guarantee(is_streaming(), "module is not streaming");
+    *_stream << f;
+
+    auto& l = _function_list;
+    auto it = std::find(l.begin(), l.end(), f);
+    if (it != l.end()) {
+        l.erase(it);
+    }
+    if (_value_map.get(f->name_symbol()) == f) {
+        _value_map.erase(f->name_symbol());
+    }
+
+    f->delete_body();
+    delete f;
+}
+
+/**@brief Write the functions that are still in the module, e.g. those added by passes,
+ * and everything after the functions, then close the stream
+ */
+void Module::end_streaming() {
+    if (!is_streaming()) {
+        return;
+    }
+
+    std::ostream& os = *_stream;
+    for (auto i: function_list()) { os << i; }         os << '\n';
+    print_trailing_sections(os);
+
+    _stream->close();
+    guarantee(!_stream->fail(), "write file %s failed", _stream_path.c_str());
+    delete _stream;
+    _stream = NULL;
+    guarantee(Systems::commit_output(_stream_path, _stream_file), "rename %s to %s failed",
+              _stream_path.c_str(), _stream_file.c_str());
+}
+
 void Module::check_after_parse() {
 //    guarantee(_function_map.size() == _function_list.size(),
 //              "map size: %d, list size: %d\n", _function_map.size(), _function_list.size());
@@ -8,8 +8,12 @@
 #include <map>
 #include <vector>
 #include <fstream>
+#include <atomic>
 #include "value.h"
 #include "../utilities/macros.h"
+#include "../utilities/mutex.h"
+#include "../utilities/textArena.h"
+#include "../utilities/symbolMap.h"
 #include "comdat.h"
 
 class StructType;
@@ -17,12 +21,14 @@ class Comdat;
 class GlobalVariable;
 class Alias;
 class Function;
+class CallInstFamily;
 class Attribute;
 class MetaData;
+class CallGraph;
+class CallSiteIndex;
 
 class DILocation;
 
-// todo: to add a routine to destroy a Module
 class Module: public Value {
 public:
     enum Language {
@@ -35,22 +41,44 @@ private:
     string _input_file;
     string _module_id;
     bool _is_fully_resolved;
+    std::atomic<bool> _has_lazy_functions;  // some function bodies are not parsed yet
     std::map<string, string> _headers;
     std::vector<string> _module_level_inline_asms;
     std::vector<StructType*> _struct_list;
     std::vector<Comdat*> _comdat_list;
     std::vector<GlobalVariable*> _global_list;
-    std::map<string, Alias*> _alias_map;
+    std::map<string, Alias*> _alias_map;        // ordered, for printing
+    SymbolMap<Alias*> _alias_index;             // for lookups
     std::vector<Function*> _function_list;  // guaranteed in the original order
     std::map<string, Function*> _function_map;  // for symbol resolving
-    std::map<string, Value*> _value_map;
+    SymbolMap<Value*> _value_map;               // globals and functions by name
     std::vector<Attribute*> _attribute_list;
     //std::vector<MetaData*> _metadata_list;
     std::map<string, MetaData*> _named_metadata_map;
     std::vector<MetaData*> _unnamed_metadata_list;
+    TextArena _text_arena;  // raw text of everything in this module
+    Mutex _object_lock;  // for the arena, outside of the parser
+    Mutex _materialize_all_lock;  // held by the thread in materialize_all(), the others wait
+    std::atomic<CallGraph*> _call_graph;  // built on first use, under _call_graph_lock
+    Mutex _call_graph_lock;
+    std::atomic<CallSiteIndex*> _call_site_index;  // built on first use, under _call_site_index_lock
+    Mutex _call_site_index_lock;
+
+    /* streaming mode */
+    std::ofstream* _stream;
+    string _stream_file;
+    string _stream_path;  // where the stream is written until end_streaming()
+
+    void print_leading_sections(std::ostream& os);
+    void print_trailing_sections(std::ostream& os);
 public:
 
-    Module(): _lang(Language::c), _is_fully_resolved(false) {}
+    Module(): _lang(Language::c), _is_fully_resolved(false), _has_lazy_functions(false), _call_graph(NULL), _call_site_index(NULL), _stream(NULL) {}
+    ~Module();
+
+    /* a module owns an arena, so it is not allocated in one */
+    static void* operator new(size_t size)                 { return ::operator new(size); }
+    static void operator delete(void* p)                   { ::operator delete(p); }
 
     Module::Language language()                            { return _lang; }
     void set_language(Language l)                          { _lang = l; }
@@ -74,6 +102,17 @@ public:
     bool is_fully_resolved()                                   { return _is_fully_resolved; }
     void set_is_fully_resolved(bool v=1)                       { _is_fully_resolved = v; }
 
+    bool has_lazy_functions()                                  { return _has_lazy_functions.load(std::memory_order_acquire); }
+    void set_has_lazy_functions(bool v=1)                      { _has_lazy_functions = v; }
+    void materialize_all();
+    void drop_contents();
+
+    CallGraph& call_graph();
+    CallGraph* call_graph_if_built()                           { return _call_graph.load(std::memory_order_acquire); }
+    CallSiteIndex& call_site_index();
+    void call_inserted(CallInstFamily* ci, Function* callee);
+    void call_deleted(CallInstFamily* ci, Function* callee);
+
     std::vector<string> &module_level_inline_asms() {
         return _module_level_inline_asms;
     }
@@ -102,10 +141,13 @@ public:
     std::map<string, Alias*>& alias_map()                  { return _alias_map; }
     std::vector<Function*>& function_list()                { return _function_list; }
     std::map<string, Function*>& function_map()            { return _function_map; }
-    std::map<string, Value*>& value_map()                  { return _value_map; }
+    SymbolMap<Value*>& value_map()                         { return _value_map; }
     std::vector<Attribute*>& attribute_list()              { return _attribute_list; }
     std::map<string, MetaData*>& named_metadata_map()      { return _named_metadata_map; };
     std::vector<MetaData*>& unnamed_metadata_list()        { return _unnamed_metadata_list; }
+    TextArena& text_arena()                                { return _text_arena; }
+    void* allocate_object(size_t size);
+    Mutex& object_lock()                                   { return _object_lock; }
 
     // Globals
     void append_new_global(string text);
@@ -121,8 +163,10 @@ public:
     void add_comdat(Comdat* cd)                            { _comdat_list.push_back(cd); }
     void add_global_variable(GlobalVariable* gv);
     GlobalVariable* get_global_variable(string name);
-    void add_alias(string key, Alias* value)               { _alias_map[key] = value; }
-    Alias* get_alias(string key)                           { if (_alias_map.find(key) == _alias_map.end()) { return NULL; } else { return _alias_map[key]; } }
+    void add_alias(string key, Alias* value)               { _alias_map[key] = value; _alias_index.set(Symbol(key), value); }
+    Alias* get_alias(Symbol key)                           { return _alias_index.get(key); }
+    Alias* get_alias(const string& key)                    { return _alias_index.get(key); }
+    Alias* get_alias(const char* key)                      { return _alias_index.get(string(key)); }
     void append_new_function(Function* f)                  { insert_new_function(_function_list.size(), f); }
     void append_attribute(Attribute* att)                  { _attribute_list.push_back(att); }
     void set_named_metadata(string key, MetaData* md)      { _named_metadata_map[key] = md; }
@@ -130,7 +174,9 @@ public:
 
     MetaData* get_debug_info(int i);
 
-    Function* get_function(string key);
+    Function* get_function(Symbol key);
+    Function* get_function(const string& key)              { return get_function(Symbol::find(key)); }
+    Function* get_function(const char* key)                { return get_function(Symbol::find(key)); }
     Function* get_function_by_orig_name(string key);
     Function* create_child_function_symbol(string name);
     Function* create_child_function(string name);
@@ -144,6 +190,14 @@ public:
 
     void print_to_stream(std::ostream& ofs);
     void print_to_stream(FILE* fp);
+    using Value::print_to_file;
+    void print_to_file(const char* file);
+
+    /* streaming mode, see LLParser::stream_functions() */
+    bool is_streaming()                                    { return _stream != NULL; }
+    void begin_streaming(const string& file);
+    void stream_function(Function* f);
+    void end_streaming();
 
     // check
     void check_after_parse();
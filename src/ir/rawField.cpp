@@ -0,0 +1,118 @@
+#include <deque>
+#include <unordered_map>
+#include <utilities/mutex.h>
+#include "rawField.h"
+
+namespace {
+
+struct Builtins {
+    std::vector<string> names;
+    std::unordered_map<string, RawField::Key> keys;
+
+    Builtins() {
+#define RAW_FIELD_ADD(id, name) names.push_back(name); keys[name] = RawField::id;
+        RAW_FIELDS_DO(RAW_FIELD_ADD)
+#undef RAW_FIELD_ADD
+    }
+};
+
+const Builtins& builtins() {
+    static Builtins b;
+    return b;
+}
+
+/* Names seen at runtime. A deque keeps references to the names valid while it grows */
+std::deque<string> extra_names;
+std::unordered_map<string, RawField::Key> extra_keys;
+
+}
+
+RawField::Key RawField::key(const string& name) {
+    auto& b = builtins();
+    auto it = b.keys.find(name);
+    if (it != b.keys.end()) {
+        return it->second;
+    }
+
+    Locks::raw_field_lock->lock();
+    auto eit = extra_keys.find(name);
+    Key k;
+    if (eit != extra_keys.end()) {
+        k = eit->second;
+    }
+    else {
+        guarantee(BuiltinCount + extra_names.size() < UINT16_MAX, "too many raw field names");
+        k = (Key)(BuiltinCount + extra_names.size());
+        extra_names.push_back(name);
+        extra_keys[name] = k;
+    }
+    Locks::raw_field_lock->unlock();
+    return k;
+}
+
+const string& RawField::name(Key key) {
+    if (key < BuiltinCount) {
+        return builtins().names[key];
+    }
+
+    Locks::raw_field_lock->lock();
+    const string& s = extra_names.at(key - BuiltinCount);
+    Locks::raw_field_lock->unlock();
+    return s;
+}
+
+const int RawFieldLayout::NoSlot;
+const int RawFieldTable::Slots;
+const uint16_t RawFieldTable::NoKey;
+
+RawFieldLayout::RawFieldLayout(std::initializer_list<RawField::Key> keys) {
+    guarantee(keys.size() <= RawFieldTable::Slots, "a raw field layout has more keys than slots");
+    std::fill(_slot, _slot + RawField::BuiltinCount, (uint8_t)NoSlot);
+    int s = 0;
+    for (auto k: keys) {
+        guarantee(k < RawField::BuiltinCount, "only builtin raw fields have a slot");
+        _slot[k] = (uint8_t)s++;
+    }
+}
+
+RawFieldTable::RawFieldTable(const RawFieldTable& other):
+    _layout(other._layout),
+    _spill(other._spill ? new std::vector<Entry>(*other._spill) : NULL) {
+    std::copy(other._keys, other._keys + Slots, _keys);
+    std::copy(other._slots, other._slots + Slots, _slots);
+}
+
+RawFieldTable& RawFieldTable::operator=(const RawFieldTable& other) {
+    if (this != &other) {
+        std::vector<Entry>* spill = other._spill ? new std::vector<Entry>(*other._spill) : NULL;
+        delete _spill;
+        _spill = spill;
+        _layout = other._layout;
+        std::copy(other._keys, other._keys + Slots, _keys);
+        std::copy(other._slots, other._slots + Slots, _slots);
+    }
+    return *this;
+}
+
+size_t RawFieldTable::size() const {
+    size_t n = _spill ? _spill->size() : 0;
+    for (int i = 0; i < Slots; i++) {
+        if (_keys[i] != NoKey) {
+            n++;
+        }
+    }
+    return n;
+}
+
+void RawFieldTable::set_spilled(RawField::Key key, StringRef value) {
+    if (!_spill) {
+        _spill = new std::vector<Entry>();
+    }
+    for (auto& e: *_spill) {
+        if (e.key == key) {
+            e.value = value;
+            return;
+        }
+    }
+    _spill->push_back(Entry{key, value});
+}
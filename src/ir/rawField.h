@@ -0,0 +1,236 @@
+#ifndef LLPARSER_RAWFIELD_H
+#define LLPARSER_RAWFIELD_H
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+#include "../utilities/macros.h"
+#include "../utilities/stringRef.h"
+
+/* The field names the parser and the passes use, as (enumerator, name) */
+#define RAW_FIELDS_DO(f)                   \
+  /* instructions */                       \
+  f(Args,             "args")              \
+  f(Value,            "value")             \
+  f(Pointer,          "pointer")           \
+  f(Ty,               "ty")                \
+  f(Ty2,              "ty2")               \
+  f(Fnty,             "fnty")              \
+  f(Fnptrval,         "fnptrval")          \
+  f(FnAttrs,          "fn-attrs")          \
+  f(RetAttrs,         "ret-attrs")         \
+  f(ParamAttrs,       "param-attrs")       \
+  f(Cconv,            "cconv")             \
+  f(Tail,             "tail")              \
+  f(FastMath,         "fast-math")         \
+  f(Alignment,        "alignment")         \
+  f(Inalloca,         "inalloca")          \
+  f(Atomic,           "atomic")            \
+  f(Volatile,         "volatile")          \
+  f(Inbounds,         "inbounds")          \
+  f(Cond,             "cond")              \
+  f(TrueLabel,        "true-label")        \
+  f(FalseLabel,       "false-label")       \
+  f(NormalLabel,      "normal-label")      \
+  f(ExceptionLabel,   "exception-label")   \
+  f(FinalPointer,     "final-pointer")     \
+  f(FinalValue,       "final-value")       \
+  f(NumElements,      "num-elements")      \
+  f(DefaultLabel,     "default-label")     \
+  f(Predicate,        "predicate")         \
+  f(Lhs,              "lhs")               \
+  f(Rhs,              "rhs")               \
+  f(Nuw,              "nuw")               \
+  f(Nsw,              "nsw")               \
+  f(Exact,            "exact")             \
+  /* globals, functions and aliases */     \
+  f(Linkage,          "linkage")           \
+  f(Visibility,       "visibility")        \
+  f(Type,             "type")              \
+  f(Aliasee,          "aliasee")           \
+  /* debug info */                         \
+  f(Scope,            "scope")             \
+  f(Line,             "line")              \
+  f(Column,           "column")            \
+  f(File,             "file")              \
+  f(Name,             "name")              \
+  f(LinkageName,      "linkageName")       \
+  f(Unit,             "unit")              \
+  f(Variables,        "variables")         \
+  f(IsLocal,          "isLocal")           \
+  f(IsDefinition,     "isDefinition")      \
+  f(IsOptimized,      "isOptimized")       \
+  f(ScopeLine,        "scopeLine")         \
+  f(Flags,            "flags")             \
+  f(Tag,              "tag")               \
+  f(BaseType,         "baseType")          \
+  f(Size,             "size")              \
+  f(Align,            "align")             \
+  f(Offset,           "offset")            \
+  f(Discriminator,    "discriminator")     \
+  f(Arg,              "arg")               \
+  f(Types,            "types")             \
+  f(InlinedAt,        "inlinedAt")         \
+  f(Filename,         "filename")          \
+  f(Directory,        "directory")         \
+  f(Encoding,         "encoding")          \
+  f(Identifier,       "identifier")        \
+  f(Elements,         "elements")          \
+
+/**@brief Keys of raw fields
+ *
+ * The fields in RAW_FIELDS_DO have fixed keys. Any other name (mostly debug info fields
+ * that nobody looks at) gets a key the first time it is seen, which stays valid for the
+ * rest of the run.
+ */
+class RawField {
+public:
+    enum Key: uint16_t {
+#define RAW_FIELD_ENUM(id, name) id,
+        RAW_FIELDS_DO(RAW_FIELD_ENUM)
+#undef RAW_FIELD_ENUM
+        BuiltinCount
+    };
+
+    static Key key(const string& name);
+    static const string& name(Key key);
+};
+
+/**@brief Where each builtin field of one class of Shadow lives in its RawFieldTable
+ *
+ * A class lists the fields its parser sets, and each of them gets a fixed slot. A key that
+ * is not listed, including every runtime key, goes to the spill of the table.
+ */
+class RawFieldLayout {
+public:
+    static const int NoSlot = 0xff;
+private:
+    uint8_t _slot[RawField::BuiltinCount];
+public:
+    RawFieldLayout(std::initializer_list<RawField::Key> keys);
+
+    int slot(RawField::Key key) const              { return key < RawField::BuiltinCount ? _slot[key] : NoSlot; }
+};
+
+/**@brief The raw fields of one Shadow
+ *
+ * The values live in a fixed inline array. With a layout, a builtin key maps to its slot
+ * directly; without one (globals, functions, debug info), the slots are filled in the order
+ * the fields are set and found by a scan of the keys. What doesn't fit in the slots goes to
+ * a spill vector that is allocated the first time it is needed.
+ */
+class RawFieldTable {
+public:
+    static const int Slots = 8;
+
+    struct Entry {
+        RawField::Key key;
+        StringRef value;
+    };
+
+    /* Walks the used slots, then the spill */
+    class const_iterator {
+        const RawFieldTable* _table;
+        size_t _i;
+        mutable Entry _entry;
+
+        void skip_empty() {
+            while (_i < Slots && _table->_keys[_i] == NoKey) {
+                _i++;
+            }
+        }
+    public:
+        const_iterator(const RawFieldTable* table, size_t i): _table(table), _i(i)  { skip_empty(); }
+
+        const Entry& operator*() const {
+            if (_i < Slots) {
+                _entry.key = (RawField::Key)_table->_keys[_i];
+                _entry.value = _table->_slots[_i];
+                return _entry;
+            }
+            return (*_table->_spill)[_i - Slots];
+        }
+        const Entry* operator->() const                     { return &**this; }
+        const_iterator& operator++()                        { _i++; skip_empty(); return *this; }
+        bool operator==(const const_iterator& o) const      { return _i == o._i; }
+        bool operator!=(const const_iterator& o) const      { return _i != o._i; }
+    };
+private:
+    static const uint16_t NoKey = UINT16_MAX;
+
+    const RawFieldLayout* _layout;
+    uint16_t _keys[Slots];           // the key in each slot, NoKey if the slot is free
+    StringRef _slots[Slots];
+    std::vector<Entry>* _spill;
+
+    int slot_of(RawField::Key key) const {
+        if (_layout) {
+            int s = _layout->slot(key);
+            return s != RawFieldLayout::NoSlot && _keys[s] == key ? s : -1;
+        }
+        for (int i = 0; i < Slots; i++) {
+            if (_keys[i] == key) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    int free_slot_for(RawField::Key key) const {
+        if (_layout) {
+            int s = _layout->slot(key);
+            return s != RawFieldLayout::NoSlot ? s : -1;
+        }
+        for (int i = 0; i < Slots; i++) {
+            if (_keys[i] == NoKey) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void set_spilled(RawField::Key key, StringRef value);
+public:
+    RawFieldTable(): _layout(NULL), _spill(NULL)            { std::fill(_keys, _keys + Slots, NoKey); }
+    RawFieldTable(const RawFieldTable& other);
+    RawFieldTable& operator=(const RawFieldTable& other);
+    ~RawFieldTable()                                        { delete _spill; }
+
+    /* Only while the table is empty, i.e. from the constructor of the class */
+    void set_layout(const RawFieldLayout* layout)           { _layout = layout; }
+
+    size_t size() const;
+    const_iterator begin() const                            { return const_iterator(this, 0); }
+    const_iterator end() const                              { return const_iterator(this, Slots + (_spill ? _spill->size() : 0)); }
+
+    const StringRef* find(RawField::Key key) const {
+        int s = slot_of(key);
+        if (s >= 0) {
+            return &_slots[s];
+        }
+        if (_spill) {
+            for (auto& e: *_spill) {
+                if (e.key == key) {
+                    return &e.value;
+                }
+            }
+        }
+        return NULL;
+    }
+
+    void set(RawField::Key key, StringRef value) {
+        int s = slot_of(key);
+        if (s < 0) {
+            s = free_slot_for(key);
+        }
+        if (s >= 0) {
+            _keys[s] = key;
+            _slots[s] = value;
+            return;
+        }
+        set_spilled(key, value);
+    }
+};
+
+#endif //LLPARSER_RAWFIELD_H
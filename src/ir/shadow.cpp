@@ -3,8 +3,85 @@
 //
 
 #include <utilities/strings.h>
+#include <asmParser/sysDict.h>
 #include "shadow.h"
 #include "../utilities/flags.h"
+#include "../utilities/textArena.h"
+
+Shadow::Shadow(const Shadow& other):
+    _raw_ref(other._raw_ref),
+    _raw_owned(other._raw_owned ? new string(*other._raw_owned) : NULL),
+    _has_raw_text(other._has_raw_text),
+    _fully_parsed(other._fully_parsed),
+    _raw_fields(other._raw_fields) {}
+
+Shadow& Shadow::operator=(const Shadow& other) {
+    if (this != &other) {
+        string* owned = other._raw_owned ? new string(*other._raw_owned) : NULL;
+        delete _raw_owned;
+        _raw_owned = owned;
+        _raw_ref = other._raw_ref;
+        _has_raw_text = other._has_raw_text;
+        _fully_parsed = other._fully_parsed;
+        _raw_fields = other._raw_fields;
+    }
+    return *this;
+}
+
+/**@brief Allocate an IR object in the arena of its module
+ *
+ * What the parser parses goes to the arena it fills (the module, a slice or a streamed
+ * function), see TextArena::ObjectScope. Anything else, e.g. what a pass creates, goes to
+ * the module that is current on the thread. Objects created outside any module go to the
+ * shared arena.
+ */
+void* Shadow::operator new(size_t size) {
+    if (TextArena* arena = TextArena::objects()) {
+        return arena->allocate_object(size);
+    }
+    if (Module* m = SysDict::current_module()) {
+        return m->allocate_object(size);
+    }
+    return TextArena::shared()->allocate_object(size);
+}
+
+/**@brief Get the raw text for modification
+ *
+ * The first call copies the text out of the arena, later modifications
+ * only touch this Shadow's own copy.
+ */
+string& Shadow::raw_text() {
+    if (!_raw_owned) {
+        _raw_owned = new string(_raw_ref.str());
+        _raw_ref = StringRef();
+    }
+    return *_raw_owned;
+}
+
+void Shadow::set_raw_text(const string& text) {
+    if (_raw_owned) {
+        *_raw_owned = text;
+    }
+    else {
+        _raw_owned = new string(text);
+    }
+    _raw_ref = StringRef();
+}
+
+/**@brief Set a raw field, the value is copied into the current TextArena
+ *
+ */
+void Shadow::set_raw_field(RawField::Key field, const string& value) {
+    _raw_fields.set(field, TextArena::current()->copy(value));
+}
+
+/**@brief The value of a raw field, or an empty StringRef if the field is not set
+ *
+ */
+StringRef Shadow::raw_field(RawField::Key field) const {
+    const StringRef* v = _raw_fields.find(field);
+    return v ? *v : StringRef();
+}
 
 /**@brief
  *
@@ -16,10 +93,10 @@
  * @param field
  * @param new_value
  */
-void Shadow::update_raw_field(string field, string new_value) {
+void Shadow::update_raw_field(RawField::Key field, const string& new_value) {
     if (has_raw_field(field)) {
         string old_value = get_raw_field(field);
-        Strings::ireplace(_raw_text, old_value, new_value);
+        Strings::ireplace(raw_text(), old_value, new_value);
         set_raw_field(field, new_value);
     }
 }
@@ -29,8 +106,8 @@ void Shadow::update_raw_field(string field, string new_value) {
  */
 void Shadow::dump_raw_fields() {
     std::cout << "num of fields: " << _raw_fields.size() << '\n';
-    for (auto i: _raw_fields) {
-        std::cout << "  " << i.first << ": " << i.second << '\n';
+    for (auto& i: _raw_fields) {
+        std::cout << "  " << RawField::name(i.key) << ": " << i.value << '\n';
     }
     std::cout << '\n';
 }
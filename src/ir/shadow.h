@@ -6,12 +6,26 @@
 #define LLPARSER_SHADOW_H
 
 #include <string>
-#include <map>
 #include "../utilities/macros.h"
+#include "../utilities/stringRef.h"
+#include "rawField.h"
 
+/**@brief The textual form of an IR entity
+ *
+ * Raw text and raw field values are StringRefs into the module's TextArena, or
+ * straight into the mapped input file. They are never copied for reading. The
+ * first call to the mutable raw_text() copies the text into a string owned by
+ * the Shadow, which then takes over (copy-on-write); set_raw_text(const string&)
+ * does the same.
+ *
+ * The views into the input stay valid while the module is written, even to the
+ * input itself: output files are replaced by a rename, never truncated in place
+ * (see Systems::output_path_for()).
+ */
 class Shadow {
 protected:
-    string _raw_text;
+    StringRef _raw_ref;
+    string* _raw_owned;  // NULL until the raw text is modified
     bool _has_raw_text;
     bool _fully_parsed;
 
@@ -20,30 +34,51 @@ protected:
      *  1. Required fields of the instruction such as operands, arguments
      *  2. Optional fields that have a value such as "fastmath"
      *  3. Optional fields that have no value such as "volatile"
-     *  All of them are stored in this map
+     *  All of them are stored in this table
      */
-    std::map<string, string> _raw_fields;
+    RawFieldTable _raw_fields;
 public:
-    Shadow(): _has_raw_text(false), _fully_parsed(false) {}
+    Shadow(): _raw_owned(NULL), _has_raw_text(false), _fully_parsed(false) {}
+    Shadow(const Shadow& other);
+    Shadow& operator=(const Shadow& other);
+    virtual ~Shadow()            { delete _raw_owned; }
 
-    string& raw_text()           { return _raw_text; }
-    const char* raw_c_str()      { return _raw_text.c_str(); }
+    /* IR objects are allocated in the arena of their module and freed with it */
+    static void* operator new(size_t size);
+    static void operator delete(void* p)      {}
+
+    string& raw_text();
+    StringRef raw_view() const   { return _raw_owned ? StringRef(*_raw_owned) : _raw_ref; }
+    string raw_str() const       { return raw_view().str(); }  // a copy, raw_view() is not NUL-terminated
+    bool raw_text_is_owned()     { return _raw_owned != NULL; }
     bool has_raw_text()          { return _has_raw_text; }
     bool fully_parsed()          { return _fully_parsed; }
 
     virtual void init_raw_field()                                 {}
-    void set_raw_field(string field, string value)                { _raw_fields[field] = value; }
-    bool has_raw_field(string field) const                        { return _raw_fields.find(field) != _raw_fields.end(); }
-    string get_raw_field(string field)                            { return _raw_fields[field]; }
-    void update_raw_field(string field, string new_value);
+    void set_raw_field_layout(const RawFieldLayout* layout)       { _raw_fields.set_layout(layout); }
+    void set_raw_field(RawField::Key field, const string& value);
+    void set_raw_field(RawField::Key field, StringRef value)      { _raw_fields.set(field, value); }
+    bool has_raw_field(RawField::Key field) const                 { return _raw_fields.find(field) != NULL; }
+    StringRef raw_field(RawField::Key field) const;
+    string get_raw_field(RawField::Key field) const               { return raw_field(field).str(); }
+    const RawFieldTable& raw_fields() const                       { return _raw_fields; }
+    void update_raw_field(RawField::Key field, const string& new_value);
+
+    /* by name, for fields that are not known in advance */
+    void set_raw_field(const string& field, const string& value)  { set_raw_field(RawField::key(field), value); }
+    void set_raw_field(const string& field, StringRef value)      { set_raw_field(RawField::key(field), value); }
+    bool has_raw_field(const string& field) const                 { return has_raw_field(RawField::key(field)); }
+    string get_raw_field(const string& field) const               { return get_raw_field(RawField::key(field)); }
+    void update_raw_field(const string& field, const string& new_value)  { update_raw_field(RawField::key(field), new_value); }
 
-    void set_raw_text(string text)      { _raw_text = text; }
-    void append_raw_text(string text)   { _raw_text += text; }
+    void set_raw_text(const string& text);
+    void set_raw_text(StringRef text)   { _raw_ref = text; delete _raw_owned; _raw_owned = NULL; }
+    void append_raw_text(const string& text)   { raw_text() += text; }
     void set_has_raw_text(bool has)     { _has_raw_text = has; }
     void set_fully_parsed(bool fully)   { _fully_parsed = fully; }
 
 
-    virtual void dump()                 { std::cout << raw_text() << std::endl; }
+    virtual void dump()                 { std::cout << raw_view() << std::endl; }
     virtual void dump_raw_fields();
 };
 
@@ -0,0 +1,98 @@
+#include <cstdlib>
+#include <cstring>
+#include "../utilities/macros.h"
+#include "userList.h"
+
+UserList::UserList(const UserList& other): UserList() {
+    *this = other;
+}
+
+UserList& UserList::operator=(const UserList& other) {
+    if (this == &other) {
+        return *this;
+    }
+    clear();
+    for (auto user: other) {
+        append(user);
+    }
+    return *this;
+}
+
+UserList::~UserList() {
+    clear();
+}
+
+void UserList::grow() {
+    _capacity = _capacity ? _capacity * 2 : 2;
+    _data = (Instruction**)realloc(_data, _capacity * sizeof(Instruction*));
+    guarantee(_data, "UserList: out of memory");
+}
+
+void UserList::build_index() {
+    _index = new std::unordered_map<Instruction*, uint32_t>();
+    _index->reserve(_size * 2);
+    for (uint32_t i = 0; i < _size; ++i) {
+        (*_index)[_data[i]] = i;
+    }
+}
+
+bool UserList::contains(Instruction* user) const {
+    if (_index) {
+        return _index->find(user) != _index->end();
+    }
+    for (uint32_t i = 0; i < _size; ++i) {
+        if (_data[i] == user) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void UserList::append(Instruction* user) {
+    if (_size == _capacity) {
+        grow();
+    }
+    _data[_size] = user;
+    if (_index) {
+        (*_index)[user] = _size;
+    }
+    _size++;
+    if (!_index && _size > INDEX_THRESHOLD) {
+        build_index();
+    }
+}
+
+bool UserList::remove(Instruction* user) {
+    uint32_t i = _size;
+    if (_index) {
+        auto it = _index->find(user);
+        if (it != _index->end()) {
+            i = it->second;
+            _index->erase(it);
+        }
+    }
+    else {
+        for (i = 0; i < _size && _data[i] != user; ++i);
+    }
+    if (i == _size) {
+        return false;
+    }
+
+    _size--;
+    if (i != _size) {
+        _data[i] = _data[_size];
+        if (_index) {
+            (*_index)[_data[i]] = i;
+        }
+    }
+    return true;
+}
+
+void UserList::clear() {
+    free(_data);
+    delete _index;
+    _data = NULL;
+    _size = 0;
+    _capacity = 0;
+    _index = NULL;
+}
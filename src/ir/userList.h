@@ -0,0 +1,49 @@
+#ifndef LLPARSER_USERLIST_H
+#define LLPARSER_USERLIST_H
+
+#include <cstdint>
+#include <unordered_map>
+
+class Instruction;
+
+/**@brief The users of a Value, as a flat array
+ *
+ * An empty list takes no memory beyond its own three words, which matters because
+ * every instruction and metadata node has one. A list that grows past INDEX_THRESHOLD
+ * users (the callers of @malloc, say) also keeps a hash index from user to position,
+ * so that contains() and remove() stay O(1).
+ *
+ * remove() moves the last user into the hole, so the order is only stable as long as
+ * nothing is removed.
+ */
+class UserList {
+    static const uint32_t INDEX_THRESHOLD = 16;
+
+    Instruction** _data;
+    uint32_t _size;
+    uint32_t _capacity;
+    std::unordered_map<Instruction*, uint32_t>* _index;
+
+    void grow();
+    void build_index();
+public:
+    typedef Instruction* const* const_iterator;
+
+    UserList(): _data(NULL), _size(0), _capacity(0), _index(NULL) {}
+    UserList(const UserList& other);
+    UserList& operator=(const UserList& other);
+    ~UserList();
+
+    uint32_t size() const                                   { return _size; }
+    bool empty() const                                      { return _size == 0; }
+    const_iterator begin() const                            { return _data; }
+    const_iterator end() const                              { return _data + _size; }
+    Instruction* operator[](uint32_t i) const               { return _data[i]; }
+
+    bool contains(Instruction* user) const;
+    void append(Instruction* user);
+    bool remove(Instruction* user);
+    void clear();
+};
+
+#endif //LLPARSER_USERLIST_H
@@ -5,10 +5,11 @@
 #include <fstream>
 #include <algorithm>
 #include <cstdio>
+#include <unistd.h>
+#include <utilities/systems.h>
 #include "value.h"
 
 Value::Value(): Shadow() {
-    _name = "";
     _copy_cnt = 1000;  // use a large number to avoid collision with llvm's renaming scheme
     _copy_prototype = NULL;
 }
@@ -44,23 +45,36 @@ string Value::prototype_name() {
 }
 
 void Value::append_user(Instruction *user) {
-    guarantee(_users.find(user) == _users.end(), "A value is used twice by instruction %p", user);
-    _users.insert(user);
+    guarantee(!_users.contains(user), "A value is used twice by instruction %p", user);
+    _users.append(user);
 }
 
 void Value::remove_user(Instruction *user) {
-    auto& vec = user_set();
-    vec.erase(user);  // remove from set is simpler than remove from vector
+    _users.remove(user);
 }
 
+/**@brief Print to @param file, which only changes once everything is printed
+ *
+ * The raw text may point into the mapped input, which may be @param file itself,
+ * see Systems::output_path_for().
+ */
 void Value::print_to_file(const char *file) {
+    string path = Systems::output_path_for(file);
     std::ofstream ofs;
-    ofs.open(file);
+    ofs.open(path);
     if (!ofs.good()) {
-        fprintf(stderr, "open file %s failed.\n", file);
+        fprintf(stderr, "open file %s failed.\n", path.c_str());
+        return;
     }
     ofs << this;
     ofs.close();
+    if (ofs.fail()) {
+        unlink(path.c_str());
+        fprintf(stderr, "write file %s failed.\n", path.c_str());
+    }
+    else if (!Systems::commit_output(path, file)) {
+        fprintf(stderr, "rename %s to %s failed.\n", path.c_str(), file);
+    }
 //    FILE* fp = fopen(file, "w");
 //    if (fp == NULL) {
 //        fprintf(stderr, "open file %s failed", file);
@@ -78,7 +92,7 @@ void Value::print_to_file(string file) {
 }
 
 void Value::print_to_stream(std::ostream &os) {
-    os << raw_text() << std::endl;
+    os << raw_view() << std::endl;
 }
 
 std::ostream& operator<<(std::ostream& os, Value* v) {
@@ -87,6 +101,7 @@ std::ostream& operator<<(std::ostream& os, Value* v) {
 }
 
 void Value::print_to_stream(FILE *fp) {
-    fprintf(fp, "%s\n", raw_text().c_str());
+    raw_view().print_to(fp);
+    fputc('\n', fp);
     //fprintf(fp, "Value::print_to_stream called, are you sure this should be called?\n");
 }
\ No newline at end of file
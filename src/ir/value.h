@@ -8,7 +8,9 @@
 #include <map>
 #include <set>
 #include "shadow.h"
+#include "userList.h"
 #include "../utilities/macros.h"
+#include "../utilities/symbol.h"
 
 class Instruction;
 
@@ -16,18 +18,18 @@ class Value: public Shadow {
 public:
     typedef std::vector<Instruction*> InstList;
     typedef InstList::iterator inst_iterator;
-    typedef std::set<Instruction*> InstSet;
 protected:
-    string _name;
+    Symbol _name;
     //std::map<string, string> _properties;
     int _copy_cnt;
     Value* _copy_prototype;
-    InstSet _users;
+    UserList _users;
 public:
     Value();
-    virtual const string& name() const                   { return _name; }
+    virtual const string& name() const                   { return _name.str(); }
     virtual const char* name_as_c_str() const            { return _name.c_str(); };
-    virtual void set_name(string name)                   { _name = name; }
+    virtual void set_name(string name)                   { _name = Symbol(name); }
+    Symbol name_symbol() const                           { return _name; }
 
     int copy_cnt()                                       { return _copy_cnt; }
     void set_copy_cnt(int cnt)                           { _copy_cnt = cnt; }
@@ -45,7 +47,7 @@ public:
     /* caller/user interfaces */
     void append_user(Instruction* user);
 
-    InstSet& user_set()                                   { return _users; }
+    UserList& users()                                     { return _users; }
     void remove_user(Instruction* user);
 
 
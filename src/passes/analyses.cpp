@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <ir/irEssential.h>
+#include <inst/switchInst.h>
+#include "analyses.h"
+
+/* A label operand, e.g. "%bb1", names the block "bb1" */
+static string block_name(StringRef label) {
+    if (!label.empty() && label[0] == '%') {
+        return string(label.data() + 1, label.size() - 1);
+    }
+    return label.str();
+}
+
+ControlFlowGraph::ControlFlowGraph(Function* function) {
+    auto& blocks = function->basic_block_list();
+    std::unordered_map<string, BasicBlock*> by_name;
+    for (uint32_t i = 0; i < blocks.size(); ++i) {
+        _index[blocks[i]] = i;
+        by_name[blocks[i]->name()] = blocks[i];
+    }
+    _successors.resize(blocks.size());
+    _predecessors.resize(blocks.size());
+
+    std::vector<StringRef> labels;
+    for (uint32_t i = 0; i < blocks.size(); ++i) {
+        auto& insts = blocks[i]->instruction_list();
+        if (insts.empty()) {
+            continue;
+        }
+
+        Instruction* term = insts.back();
+        labels.clear();
+        switch (term->type()) {
+            case Instruction::BranchInstType:
+                labels.push_back(term->raw_field(RawField::TrueLabel));
+                if (term->has_raw_field(RawField::FalseLabel)) {
+                    labels.push_back(term->raw_field(RawField::FalseLabel));
+                }
+                break;
+            case Instruction::SwitchInstType: {
+                SwitchInst* si = static_cast<SwitchInst*>(term);
+                labels.push_back(si->default_label());
+                for (auto& c: si->cases()) {
+                    labels.push_back(c.second);
+                }
+                break;
+            }
+            case Instruction::InvokeInstType:
+                labels.push_back(term->raw_field(RawField::NormalLabel));
+                labels.push_back(term->raw_field(RawField::ExceptionLabel));
+                break;
+            default:
+                break;
+        }
+
+        for (auto label: labels) {
+            auto it = by_name.find(block_name(label));
+            guarantee(it != by_name.end(), "no block %s in function %s",
+                      label.str().c_str(), function->name_as_c_str());
+            BasicBlock* succ = it->second;
+            auto& succs = _successors[i];
+            if (std::find(succs.begin(), succs.end(), succ) == succs.end()) {
+                succs.push_back(succ);
+                _predecessors[_index[succ]].push_back(blocks[i]);
+            }
+        }
+    }
+}
+
+uint32_t ControlFlowGraph::index(BasicBlock* bb) {
+    auto it = _index.find(bb);
+    guarantee(it != _index.end(), "block %s is not in the graph", bb->name().c_str());
+    return it->second;
+}
+
+OpcodeIndex::OpcodeIndex(Module* module) {
+    for (auto F: module->function_list()) {
+        for (auto B: F->basic_block_list()) {
+            for (auto I: B->instruction_list()) {
+                _instructions[I->opcode()].push_back(I);
+            }
+        }
+    }
+}
+
+const std::vector<Instruction*>& OpcodeIndex::instructions(const string& opcode) {
+    static const std::vector<Instruction*> none;
+    auto it = _instructions.find(opcode);
+    return it == _instructions.end() ? none : it->second;
+}
+
+MemoryFunctions::MemoryFunctions(Module* module) {
+    for (auto& k: known()) {
+        if (Function* f = module->get_function(k.name)) {
+            (k.is_free ? _frees : _allocs).push_back(f);
+        }
+    }
+}
+
+/**@brief Whether BenAlloc replaces @param k when it runs for @param lang */
+bool MemoryFunctions::is_used_by(const Known& k, const string& lang) {
+    string l = k.lang;
+    if (l == "c") {
+        return lang == "c" || lang == "cpp" || lang == "all";
+    }
+    if (l == "cpp") {
+        return lang == "cpp" || lang == "all";
+    }
+    return lang == l || lang == "all";
+}
+
+const std::vector<MemoryFunctions::Known>& MemoryFunctions::known() {
+    static const std::vector<Known> functions = {
+        {"malloc",                "ben_malloc",                   true,  false, "c"},
+        {"calloc",                "ben_calloc",                   true,  false, "c"},
+        {"realloc",               "ben_realloc",                  true,  false, "c"},
+        {"free",                  "ben_free",                     false, true,  "c"},
+
+        {"_Znam",                 "ben_malloc",                   true,  false, "cpp"},
+        {"_Znwm",                 "ben_malloc",                   true,  false, "cpp"},
+        {"_ZdaPv",                "ben_free",                     false, true,  "cpp"},
+        {"_ZdlPv",                "ben_free",                     false, true,  "cpp"},
+
+        {"f90_alloc",             "f90_ben_alloc",                true,  false, "flang"},
+        {"f90_alloc03",           "f90_ben_alloc03",              true,  false, "flang"},
+        {"f90_alloc03_chk",       "f90_ben_alloc03_chk",          true,  false, "flang"},
+        {"f90_alloc04",           "f90_ben_alloc04",              true,  false, "flang"},
+        {"f90_alloc04_chk",       "f90_ben_alloc04_chk",          true,  false, "flang"},
+
+        {"f90_kalloc",            "f90_ben_kalloc",               true,  false, "flang"},
+        {"f90_calloc",            "f90_ben_calloc",               true,  false, "flang"},
+        {"f90_calloc03",          "f90_ben_calloc03",             true,  false, "flang"},
+        {"f90_calloc04",          "f90_ben_calloc04",             true,  false, "flang"},
+        {"f90_kcalloc",           "f90_ben_kcalloc",              true,  false, "flang"},
+        {"f90_ptr_alloc",         "f90_ben_ptr_alloc",            true,  false, "flang"},
+        {"f90_ptr_alloc03",       "f90_ben_ptr_alloc03",          true,  false, "flang"},
+        {"f90_ptr_alloc04",       "f90_ben_ptr_alloc04",          true,  false, "flang"},
+        {"f90_ptr_src_alloc03",   "f90_ben_ptr_src_alloc03",      true,  false, "flang"},
+        {"f90_ptr_src_alloc04",   "f90_ben_ptr_src_alloc04",      true,  false, "flang"},
+        {"f90_ptr_src_calloc03",  "f90_ben_ptr_src_calloc03",     true,  false, "flang"},
+        {"f90_ptr_src_calloc04",  "f90_ben_ptr_src_calloc04",     true,  false, "flang"},
+        {"f90_ptr_kalloc",        "f90_ben_ptr_kalloc",           true,  false, "flang"},
+        {"f90_ptr_calloc",        "f90_ben_ptr_calloc",           true,  false, "flang"},
+        {"f90_ptr_calloc03",      "f90_ben_ptr_calloc03",         true,  false, "flang"},
+        {"f90_ptr_calloc04",      "f90_ben_ptr_calloc04",         true,  false, "flang"},
+        {"f90_ptr_kcalloc",       "f90_ben_ptr_kcalloc",          true,  false, "flang"},
+        {"f90_auto_allocv",       "f90_ben_auto_allocv",          true,  false, "flang"},
+        {"f90_auto_alloc",        "f90_ben_auto_alloc",           true,  false, "flang"},
+        {"f90_auto_alloc04",      "f90_ben_auto_alloc04",         true,  false, "flang"},
+        {"f90_auto_calloc",       "f90_ben_auto_calloc",          true,  false, "flang"},
+        {"f90_auto_calloc04",     "f90_ben_auto_calloc04",        true,  false, "flang"},
+
+        {"f90_dealloc",           "f90_ben_dealloc",              false, true,  "flang"},
+        {"f90_dealloc03",         "f90_ben_dealloc03",            false, true,  "flang"},
+        {"f90_dealloc_mbr",       "f90_ben_dealloc_mbr",          false, true,  "flang"},
+        {"f90_dealloc_mbr03",     "f90_ben_dealloc_mbr03",        false, true,  "flang"},
+        {"f90_deallocx",          "f90_ben_deallocx",             false, true,  "flang"},
+        {"f90_auto_dealloc",      "f90_ben_auto_dealloc",         false, true,  "flang"},
+    };
+    return functions;
+}
@@ -0,0 +1,70 @@
+#ifndef LLPARSER_ANALYSES_H
+#define LLPARSER_ANALYSES_H
+
+#include <map>
+#include <vector>
+#include <unordered_map>
+#include "analysisManager.h"
+
+class BasicBlock;
+class Instruction;
+
+/**@brief The successors and predecessors of the blocks of a function
+ *
+ * Edges come from the labels of br, switch and invoke, which are the terminators
+ * this parser knows the targets of.
+ */
+class ControlFlowGraph: public Analysis {
+    std::unordered_map<BasicBlock*, uint32_t> _index;
+    std::vector<std::vector<BasicBlock*>> _successors;
+    std::vector<std::vector<BasicBlock*>> _predecessors;
+public:
+    ControlFlowGraph(Function* function);
+
+    const std::vector<BasicBlock*>& successors(BasicBlock* bb)      { return _successors[index(bb)]; }
+    const std::vector<BasicBlock*>& predecessors(BasicBlock* bb)    { return _predecessors[index(bb)]; }
+    uint32_t index(BasicBlock* bb);
+};
+
+/**@brief The instructions of a module grouped by opcode, in module order */
+class OpcodeIndex: public Analysis {
+public:
+    typedef std::map<string, std::vector<Instruction*>> Map;
+private:
+    Map _instructions;
+public:
+    OpcodeIndex(Module* module);
+
+    const std::vector<Instruction*>& instructions(const string& opcode);
+    Map::const_iterator begin() const                       { return _instructions.begin(); }
+    Map::const_iterator end() const                         { return _instructions.end(); }
+};
+
+/**@brief The allocation and deallocation functions that a module declares
+ *
+ * The known functions are those of C, C++ and flang, each with the function that
+ * BenAlloc replaces it with.
+ */
+class MemoryFunctions: public Analysis {
+public:
+    struct Known {
+        const char* name;
+        const char* ben_name;
+        bool add_id;
+        bool is_free;
+        const char* lang;  // c, cpp or flang
+    };
+private:
+    std::vector<Function*> _allocs;
+    std::vector<Function*> _frees;
+public:
+    MemoryFunctions(Module* module);
+
+    const std::vector<Function*>& allocs() const            { return _allocs; }
+    const std::vector<Function*>& frees() const             { return _frees; }
+
+    static const std::vector<Known>& known();
+    static bool is_used_by(const Known& k, const string& lang);
+};
+
+#endif //LLPARSER_ANALYSES_H
@@ -0,0 +1,102 @@
+#include "analysisManager.h"
+
+AnalysisManager::~AnalysisManager() {
+    release_all();
+}
+
+Analysis* AnalysisManager::find(Module* m, Function* f, std::type_index type) {
+    Analysis* result = NULL;
+    _lock.lock();
+    auto mit = _results.find(m);
+    if (mit != _results.end()) {
+        Results* results = &mit->second.module;
+        if (f) {
+            auto fit = mit->second.functions.find(f);
+            results = fit == mit->second.functions.end() ? NULL : &fit->second;
+        }
+        if (results) {
+            auto it = results->find(type);
+            if (it != results->end()) {
+                result = it->second;
+            }
+        }
+    }
+    _lock.unlock();
+    return result;
+}
+
+/**@brief Keep @param result, unless another thread computed the same analysis meanwhile,
+ * and return the one that is kept
+ *
+ * The analysis is computed without holding the lock, so that an analysis can ask for
+ * others while it is computed.
+ */
+Analysis* AnalysisManager::insert(Module* m, Function* f, std::type_index type, Analysis* result) {
+    _lock.lock();
+    ModuleResults& mr = _results[m];
+    Results& results = f ? mr.functions[f] : mr.module;
+    auto it = results.insert(std::make_pair(type, result)).first;
+    Analysis* kept = it->second;
+    _lock.unlock();
+
+    if (kept != result) {
+        delete result;
+    }
+    return kept;
+}
+
+void AnalysisManager::clear(Results& results) {
+    for (auto& it: results) {
+        delete it.second;
+    }
+    results.clear();
+}
+
+/**@brief Forget the results of @param m itself, the results of its functions are kept */
+void AnalysisManager::invalidate(Module* m) {
+    _lock.lock();
+    auto mit = _results.find(m);
+    if (mit != _results.end()) {
+        clear(mit->second.module);
+    }
+    _lock.unlock();
+}
+
+void AnalysisManager::invalidate(Function* f) {
+    _lock.lock();
+    auto mit = _results.find(f->module());
+    if (mit != _results.end()) {
+        auto fit = mit->second.functions.find(f);
+        if (fit != mit->second.functions.end()) {
+            clear(fit->second);
+            mit->second.functions.erase(fit);
+        }
+    }
+    _lock.unlock();
+}
+
+/**@brief Forget everything about @param m and its functions */
+void AnalysisManager::release(Module* m) {
+    _lock.lock();
+    auto mit = _results.find(m);
+    if (mit != _results.end()) {
+        clear(mit->second.module);
+        for (auto& fr: mit->second.functions) {
+            clear(fr.second);
+        }
+        _results.erase(mit);
+    }
+    _lock.unlock();
+}
+
+void AnalysisManager::release_all() {
+    _lock.lock();
+    for (auto& mr: _results) {
+        clear(mr.second.module);
+        for (auto& fr: mr.second.functions) {
+            clear(fr.second);
+        }
+    }
+    _results.clear();
+    _lock.unlock();
+}
@@ -0,0 +1,90 @@
+#ifndef LLPARSER_ANALYSISMANAGER_H
+#define LLPARSER_ANALYSISMANAGER_H
+
+#include <map>
+#include <typeindex>
+#include <typeinfo>
+#include <ir/module.h>
+#include <ir/function.h>
+#include <ir/callGraph.h>
+#include <ir/callSiteIndex.h>
+#include <utilities/mutex.h>
+
+/**@brief The result of an analysis of a module or a function
+ *
+ * An analysis of a module is constructed from the Module*, an analysis of a function
+ * from the Function*. Results only hold what they computed, so they can be deleted
+ * whenever the IR they describe changes.
+ */
+class Analysis {
+public:
+    virtual ~Analysis()                                     {}
+};
+
+/**@brief Computes analyses on demand and keeps the results until they are invalidated
+ *
+ * Passes ask for results by type, e.g. get<OpcodeIndex>(module), and every pass that
+ * asks for the same analysis of the same module or function gets the same result.
+ * The pass manager invalidates the results of what a pass reports it changed: the
+ * function for function and basic block passes, the whole module for module passes.
+ *
+ * The call graph and the call site index are kept up to date by the module itself,
+ * so get() just forwards to the module for them and they are never invalidated.
+ *
+ * Results of different functions can be asked for from several threads at once.
+ */
+class AnalysisManager {
+    typedef std::map<std::type_index, Analysis*> Results;
+
+    struct ModuleResults {
+        Results module;
+        std::map<Function*, Results> functions;
+    };
+
+    std::map<Module*, ModuleResults> _results;
+    Mutex _lock;
+
+    Analysis* find(Module* m, Function* f, std::type_index type);
+    Analysis* insert(Module* m, Function* f, std::type_index type, Analysis* result);
+    static void clear(Results& results);
+public:
+    ~AnalysisManager();
+
+    template <class A> A& get(Module* m);
+    template <class A> A& get(Function* f);
+
+    void invalidate(Module* m);
+    void invalidate(Function* f);
+    void release(Module* m);
+    void release_all();
+};
+
+template <class A>
+A& AnalysisManager::get(Module* m) {
+    std::type_index type(typeid(A));
+    if (Analysis* result = find(m, NULL, type)) {
+        return *static_cast<A*>(result);
+    }
+    return *static_cast<A*>(insert(m, NULL, type, new A(m)));
+}
+
+template <class A>
+A& AnalysisManager::get(Function* f) {
+    std::type_index type(typeid(A));
+    if (Analysis* result = find(f->module(), f, type)) {
+        return *static_cast<A*>(result);
+    }
+    return *static_cast<A*>(insert(f->module(), f, type, new A(f)));
+}
+
+template <>
+inline CallGraph& AnalysisManager::get<CallGraph>(Module* m) {
+    return m->call_graph();
+}
+
+template <>
+inline CallSiteIndex& AnalysisManager::get<CallSiteIndex>(Module* m) {
+    return m->call_site_index();
+}
+
+#endif //LLPARSER_ANALYSISMANAGER_H
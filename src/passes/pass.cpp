@@ -5,6 +5,7 @@
 #include <utilities/macros.h>
 #include <utilities/strings.h>
 #include "pass.h"
+#include "passManager.h"
 #include <utilities/flags.h>
 
 #define ARG_DEFAULT_VALUE "1"
@@ -17,11 +18,17 @@ Pass::Pass() {
     _is_function_pass = false;
     _is_basic_block_pass = false;
     _is_instruction_pass = false;
+    _is_thread_safe = false;
 
     _is_parse_time = false;
     _unloader = NULL;
 }
 
+/**@brief The analyses shared by all passes */
+AnalysisManager& Pass::analyses() {
+    return PassManager::pass_manager->analyses();
+}
+
 void Pass::unload() {
     guarantee(_unloader, " ");
     _unloader(this);
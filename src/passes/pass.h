@@ -15,6 +15,7 @@ class Function;
 class BasicBlock;
 class Instruction;
 class Pass;
+class AnalysisManager;
 
 
 typedef Pass* (*pass_loader)();
@@ -30,6 +31,7 @@ class Pass {
     bool _is_function_pass;
     bool _is_basic_block_pass;
     bool _is_instruction_pass;
+    bool _is_thread_safe;
 
     bool _is_parse_time;
     std::map<string, string> _args;
@@ -64,6 +66,8 @@ public:
     bool has_argument(string key);
     void print_arguments();
 
+    AnalysisManager& analyses();
+
     void set_unloader(pass_unloader v)                     { _unloader = v; }
     void unload();
 
@@ -79,10 +83,24 @@ public:
     void set_is_basic_block_pass(bool v=1)   { _is_basic_block_pass = v; }
     void set_is_instruction_pass(bool v=1)   { _is_instruction_pass = v; }
 
+    /**@brief Whether run_on_function() and run_on_basic_block() can run on different
+     * functions of one or more modules at the same time
+     *
+     * Such a pass only changes the function or block it is given and keeps its own
+     * state safe to share. It must not add, remove or retarget calls: the user lists of
+     * the callees, the call graph and the call site index are shared by all functions
+     * and are not locked. Nor may it create IR through IRBuilder, which uses the shared
+     * parser. Debug builds (LLDEBUG) check the calls of each function after such passes
+     * ran on it. Passes that don't declare this always run on one function at a time.
+     */
+    bool is_thread_safe()                    { return _is_thread_safe; }
+    void set_is_thread_safe(bool v=1)        { _is_thread_safe = v; }
+
     bool is_run_at_parse_time()              { return  _is_parse_time; }
     void set_run_at_parse_time(bool v=1)     { _is_parse_time = v; }
 
 
+    /* run_on_xxx() returns whether the pass changed the IR, which invalidates the analyses of what it ran on */
     virtual bool run_on_global() {
         printf("Pass.run_on_global called: do nothing\n");
         return false; // not mutate
@@ -7,12 +7,18 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <atomic>
 #include <vector>
 #include <peripheral/argsParser.h>
 #include <peripheral/sysArgs.h>
 #include <utilities/strings.h>
 #include <utilities/flags.h>
 #include <ir/function.h>
+#include <ir/basicBlock.h>
+#include <asmParser/sysDict.h>
+#include <utilities/workerPool.h>
+#include <utilities/textArena.h>
+#include <utilities/profiler.h>
 #include "passManager.h"
 #include "pass.h"
 #include "../ir/instruction.h"
@@ -30,10 +36,12 @@ PassManager* PassManager::pass_manager = NULL;
 
 PassManager::PassManager() {
     _pass_lib_path = "../passes";
+    _pool = NULL;
 }
 
 PassManager::~PassManager() {
     for (auto p: _module_passes) {
+        ScopedPhase phase(p->name(), "do_finalization");
         p->do_finalization();
     }
 
@@ -53,6 +61,8 @@ PassManager::~PassManager() {
             }
         }
     }
+
+    delete _pool;
 }
 
 void PassManager::init() {
@@ -114,6 +124,7 @@ void PassManager::add_pass(Pass *p) {
     }
     if (p->is_module_pass()) {
         // other passes's initializations are applied in apply_passes()
+        ScopedPhase phase(p->name(), "do_initialization");
         p->do_initialization();
         insert_with_priority(_module_passes, p);
     }
@@ -209,20 +220,171 @@ void PassManager::add_pass(string name) {
 
 // apply passes
 
+/**@brief Run all passes on @param module
+ *
+ * If every function and basic block pass is thread-safe, the functions go through
+ * them on a pool of threads without holding the pass manager lock, so the modules
+ * of ParallelModule aren't serialized on it either. Otherwise the functions run
+ * one by one under the lock. Either way each pass is initialized for the module
+ * before it runs on any function and finalized after it ran on all of them.
+ *
+ * The analyses of the module are released once its passes are finalized.
+ */
 void PassManager::apply_passes(Module *module) {
-    Locks::pass_manager_lock->lock();
+    Tracer::lock(Locks::pass_manager_lock, "pass_manager_lock");
 
     apply_module_passes(module);
 
     apply_initializations(module);
 
-    for (auto F: module->function_list()) {
-        for (auto B: F->basic_block_list()) {
-            apply_basic_block_passes(B);
+    bool parallel = ParallelPasses && is_thread_safe() && module->function_list().size() > 1;
+    if (parallel) {
+        if (!_pool) {
+            _pool = new WorkerPool(PassThreads);
+        }
+    }
+    else {
+        for (auto F: module->function_list()) {
+            if (apply_function_local_passes(F)) {
+                _analyses.invalidate(module);
+            }
         }
-        apply_function_passes(F);
     }
+    Locks::pass_manager_lock->unlock();
 
+    if (parallel) {
+        apply_function_local_passes_in_parallel(module);
+    }
+
+    Tracer::lock(Locks::pass_manager_lock, "pass_manager_lock");
+    apply_finalization(module);
+    _analyses.release(module);
+    Locks::pass_manager_lock->unlock();
+}
+
+/**@brief Whether the function and basic block passes can run on several functions at once */
+bool PassManager::is_thread_safe() {
+    for (auto p: _function_passes) {
+        if (!p->is_thread_safe()) {
+            return false;
+        }
+    }
+    for (auto p: _basic_block_passes) {
+        if (!p->is_thread_safe()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef LLDEBUG
+/* the calls in the body of @param func, which must be parsed, with their callees */
+static std::vector<std::pair<CallInstFamily*, Function*>> calls_of(Function* func) {
+    std::vector<std::pair<CallInstFamily*, Function*>> calls;
+    for (auto B: func->basic_block_list()) {
+        for (auto I: B->instruction_list()) {
+            if (CallInstFamily* ci = dynamic_cast<CallInstFamily*>(I)) {
+                calls.push_back(std::make_pair(ci, ci->called_function()));
+            }
+        }
+    }
+    return calls;
+}
+#endif
+
+/**@brief Apply the function and basic block passes to the functions of @param module
+ * on the pool
+ *
+ * The module's arena is only written by the thread that parses the module, or under
+ * its object lock, so this thread uses the shared arena while the workers run,
+ * as they do.
+ *
+ * Other workers may still be using the analyses of the module, so they are only
+ * invalidated once all functions are done.
+ *
+ * Debug builds check that the passes kept the contract of Pass::is_thread_safe():
+ * each function that was parsed before its passes ran has the same calls, to the
+ * same callees, after them.
+ */
+void PassManager::apply_function_local_passes_in_parallel(Module* module) {
+    std::vector<Function*>& functions = module->function_list();
+    TextArena* arena = TextArena::current();
+    TextArena::set_current(NULL);
+
+    std::atomic<bool> mutated(false);
+    _pool->parallel_for(functions.size(),
+                        [&](size_t i) {
+                            Function* F = functions[i];
+#ifdef LLDEBUG
+                            bool checked = F->is_materialized();
+                            auto calls = checked ? calls_of(F) : decltype(calls_of(F))();
+#endif
+                            if (apply_function_local_passes(F)) {
+                                mutated = true;
+                            }
+#ifdef LLDEBUG
+                            guarantee(!checked || calls_of(F) == calls,
+                                      "a thread-safe pass changed the calls in %s", F->name_as_c_str());
+#endif
+                        },
+                        [=] { SysDict::attach_thread(module); },
+                        [] { SysDict::detach_thread(); });
+
+    TextArena::set_current(arena);
+    if (mutated) {
+        _analyses.invalidate(module);
+    }
+}
+
+/**@brief Apply the basic block passes and then the function passes to @param func,
+ * and return whether any of them changed it
+ */
+bool PassManager::apply_function_local_passes(Function* func) {
+    bool mutated = false;
+    /* don't make lazily parsed functions parse their bodies for nothing */
+    if (!_basic_block_passes.empty()) {
+        for (auto B: func->basic_block_list()) {
+            mutated |= apply_basic_block_passes(B);
+        }
+    }
+    mutated |= apply_function_passes(func);
+    return mutated;
+}
+
+/**@brief Initialize the passes for a module whose functions are streamed
+ *
+ * In streaming mode the functions are handed to apply_passes(Function*) one
+ * by one as they are parsed, this is only valid if is_function_local().
+ */
+void PassManager::begin_streaming(Module* module) {
+    guarantee(is_function_local(), "module and global passes cannot run on a streamed module");
+    Tracer::lock(Locks::pass_manager_lock, "pass_manager_lock");
+    apply_initializations(module);
+    Locks::pass_manager_lock->unlock();
+}
+
+/**@brief Apply the function and basic block passes to the streamed @param func
+ *
+ * The function is freed after this, so its analyses are released here.
+ */
+void PassManager::apply_passes(Function* func) {
+    bool locked = !(ParallelPasses && is_thread_safe());
+    if (locked) {
+        Tracer::lock(Locks::pass_manager_lock, "pass_manager_lock");
+    }
+
+    if (apply_function_local_passes(func)) {
+        _analyses.invalidate(func->module());
+    }
+    _analyses.invalidate(func);
+
+    if (locked) {
+        Locks::pass_manager_lock->unlock();
+    }
+}
+
+void PassManager::end_streaming(Module* module) {
+    Tracer::lock(Locks::pass_manager_lock, "pass_manager_lock");
     apply_finalization(module);
     Locks::pass_manager_lock->unlock();
 }
@@ -230,36 +392,55 @@ void PassManager::apply_passes(Module *module) {
 void PassManager::apply_global_passes() {
     std::vector<Pass*>& passes = _global_passes;
     for (int i = 0; i < passes.size(); ++i) {
-        int mutated = passes[i]->run_on_global();
+        ScopedPhase phase(passes[i]->name(), "run_on_global");
+        if (passes[i]->run_on_global()) {
+            _analyses.release_all();
+        }
     }
 }
 
 void PassManager::apply_module_passes(Module *module) {
     std::vector<Pass*>& passes = _module_passes;
     for (int i = 0; i < passes.size(); ++i) {
-        int mutated = passes[i]->run_on_module(module);
+        ScopedPhase phase(passes[i]->name(), "run_on_module", module->input_file().c_str());
+        if (passes[i]->run_on_module(module)) {
+            _analyses.release(module);
+        }
     }
 }
 
-void PassManager::apply_function_passes(Function *func) {
+bool PassManager::apply_function_passes(Function *func) {
+    bool mutated = false;
     std::vector<Pass*>& passes = _function_passes;
     for (int i = 0; i < passes.size(); ++i) {
-        int mutated = passes[i]->run_on_function(func);
+        ScopedPhase phase(passes[i]->name(), "run_on_function", func->name_as_c_str());
+        if (passes[i]->run_on_function(func)) {
+            _analyses.invalidate(func);
+            mutated = true;
+        }
     }
+    return mutated;
 }
 
 void PassManager::apply_instruction_passes(Instruction *inst) {
     std::vector<Pass*>& passes = _instruction_passes;
     for (int i = 0; i < passes.size(); ++i) {
+        ScopedPhase phase(passes[i]->name(), "run_on_instruction");
         int mutated = passes[i]->run_on_instruction(inst);
     }
 }
 
-void PassManager::apply_basic_block_passes(BasicBlock *bb) {
+bool PassManager::apply_basic_block_passes(BasicBlock *bb) {
+    bool mutated = false;
     std::vector<Pass*>& passes = _basic_block_passes;
     for (int i = 0; i < passes.size(); ++i) {
-        int mutated = passes[i]->run_on_basic_block(bb);
+        ScopedPhase phase(passes[i]->name(), "run_on_basic_block");
+        if (passes[i]->run_on_basic_block(bb)) {
+            _analyses.invalidate(bb->parent());
+            mutated = true;
+        }
     }
+    return mutated;
 }
 
 // initialization and finalization
@@ -267,11 +448,13 @@ void PassManager::apply_basic_block_passes(BasicBlock *bb) {
 void PassManager::apply_initializations(Module *module) {
     std::vector<Pass*>& passes = _function_passes;
     for (int i = 0; i < passes.size(); ++i) {
+        ScopedPhase phase(passes[i]->name(), "do_initialization", module->input_file().c_str());
         passes[i]->do_initialization(module);
     }
 
     std::vector<Pass*>& passes1 = _basic_block_passes;
     for (int i = 0; i < passes1.size(); ++i) {
+        ScopedPhase phase(passes1[i]->name(), "do_initialization", module->input_file().c_str());
         passes1[i]->do_initialization(module);
     }
 }
@@ -279,11 +462,13 @@ void PassManager::apply_initializations(Module *module) {
 void PassManager::apply_finalization(Module *module) {
     std::vector<Pass*>& passes = _function_passes;
     for (int i = 0; i < passes.size(); ++i) {
+        ScopedPhase phase(passes[i]->name(), "do_finalization", module->input_file().c_str());
         passes[i]->do_finalization(module);
     }
 
     std::vector<Pass*>& passes2 = _basic_block_passes;
     for (int i = 0; i < passes2.size(); ++i) {
+        ScopedPhase phase(passes2[i]->name(), "do_finalization", module->input_file().c_str());
         passes2[i]->do_finalization(module);
     }
 }
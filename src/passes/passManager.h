@@ -9,12 +9,14 @@
 #include <type_traits>
 #include <ir/module.h>
 #include "../ir/instruction.h"
+#include "analysisManager.h"
 
 class Pass;
 class Instruction;
 class BasicBlock;
 class Function;
 class Module;
+class WorkerPool;
 
 
 class PassManager {
@@ -28,6 +30,11 @@ class PassManager {
     std::vector<Pass*> _basic_block_passes;
     std::vector<Pass*> _instruction_passes;
     string _pass_lib_path;
+    WorkerPool* _pool;
+    AnalysisManager _analyses;
+
+    bool apply_function_local_passes(Function* func);
+    void apply_function_local_passes_in_parallel(Module* module);
 public:
     PassManager();
     ~PassManager();
@@ -41,12 +48,22 @@ public:
 
     void apply_global_passes();
     void apply_module_passes(Module* module);
-    void apply_function_passes(Function* func);
-    void apply_basic_block_passes(BasicBlock* bb);
+    bool apply_function_passes(Function* func);
+    bool apply_basic_block_passes(BasicBlock* bb);
     void apply_instruction_passes(Instruction* inst);
 
+    AnalysisManager& analyses()                            { return _analyses; }
+
     void apply_passes(Module* module);
 
+    /* streaming mode */
+    bool is_function_local()                               { return _global_passes.empty() && _module_passes.empty(); }
+    bool has_global_passes()                               { return !_global_passes.empty(); }
+    bool is_thread_safe();
+    void begin_streaming(Module* module);
+    void apply_passes(Function* func);
+    void end_streaming(Module* module);
+
     void apply_initializations();
     void apply_finalization();
     void apply_initializations(Module* module);
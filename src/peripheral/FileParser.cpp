@@ -2,24 +2,188 @@
 // Created by tzhou on 8/27/17.
 //
 
+#include <cstring>
 #include <utilities/flags.h>
 #include "FileParser.h"
 
 FileParser::FileParser() {
     _line_number = 0;
+    _mapped = NULL;
+    _owns_mapping = false;
+    _map_pos = NULL;
+    _map_end = NULL;
+    _line_begin = NULL;
+    _line_len = 0;
+    _use_map = false;
+    _good = false;
+    _eof = false;
 }
 
 void FileParser::reset_parser() {
     StringParser::reset_parser();
     _line_number = 0;
+    close();
+    _file_name.clear();
+}
+
+/**@brief Open @param file for line reading
+ *
+ * The file is mapped when -XX:+UseMmapInput is on and the file is a regular file,
+ * otherwise it is opened as a std::ifstream.
+ *
+ * @return false if the file can't be opened either way
+ */
+bool FileParser::open(const string& file) {
+    close();
+
+    if (UseMmapInput) {
+        MappedFile* mf = new MappedFile();
+        if (mf->open(file)) {
+            _mapped = mf;
+            _owns_mapping = true;
+            _use_map = true;
+            _map_pos = mf->data();
+            _map_end = mf->end();
+            _good = true;
+            _eof = false;
+            return true;
+        }
+        delete mf;
+    }
+
+    _ifs.open(file.c_str());
+    return _ifs.is_open();
+}
+
+/**@brief Read the lines in [@param begin, @param end) of a mapping that someone else owns
+ *
+ * @param line_before: the line number of the line before @param begin
+ */
+bool FileParser::open_slice(MappedFile* file, const char* begin, const char* end, long long line_before) {
+    close();
+    guarantee(file && begin >= file->data() && end <= file->end() && begin <= end, "bad slice");
+
+    _mapped = file;
+    _owns_mapping = false;
+    _use_map = true;
+    _map_pos = begin;
+    _map_end = end;
+    _line_number = line_before;
+    _good = true;
+    _eof = false;
+    return true;
+}
 
+/**@brief Continue reading at @param pos of the mapping, the next getline() reads the line at @param pos
+ *
+ * @param line_before: the line number of the line before @param pos
+ */
+void FileParser::seek_mapped(const char* pos, long long line_before) {
+    guarantee(_use_map && pos >= _mapped->data() && pos <= _map_end, "bad seek");
+    _map_pos = pos;
+    _line_number = line_before;
+    _good = true;
+    _eof = false;
+}
+
+void FileParser::close() {
     if (_ifs.is_open()) {
         _ifs.close();
     }
-    _file_name.clear();
+    _ifs.clear();
+
+    if (_owns_mapping) {
+        delete _mapped;
+    }
+    _mapped = NULL;
+    _owns_mapping = false;
+    _use_map = false;
+    _map_pos = NULL;
+    _map_end = NULL;
+    _line_begin = NULL;
+    _line_len = 0;
+    _good = false;
+    _eof = false;
+}
+
+/**@brief Hand the mapping over to someone that outlives the parser
+ *
+ * The parser keeps reading from the mapping but will no longer unmap it,
+ * which allows line_ref() to be used.
+ *
+ * @return the mapping, or NULL if the input is not mapped
+ */
+MappedFile* FileParser::share_mapping() {
+    _owns_mapping = false;
+    return _mapped;
+}
+
+/**@brief The current text as a view into the mapped input
+ *
+ * This only succeeds when the mapping has been shared and the current text
+ * is still (a prefix of) the last physical line, e.g. not a joined multi-line
+ * instruction.
+ *
+ * @return a null StringRef if the text is not in the mapping
+ */
+StringRef FileParser::line_ref() {
+    if (!_use_map || _owns_mapping || _line_begin == NULL) {
+        return StringRef();
+    }
+    if (_text.size() > _line_len || memcmp(_text.data(), _line_begin, _text.size()) != 0) {
+        return StringRef();
+    }
+    return StringRef(_line_begin, _text.size());
 }
 
-std::ifstream& FileParser::getline() {
+/**@brief Advance to the next physical line of the mapping without copying it
+ *
+ * @return false if there are no more lines
+ */
+bool FileParser::next_mapped_line() {
+    if (_map_pos >= _map_end) {
+        return false;
+    }
+
+    const char* nl = (const char*)memchr(_map_pos, '\n', _map_end - _map_pos);
+    const char* eol = nl ? nl : _map_end;
+    _line_begin = _map_pos;
+    _line_len = eol - _map_pos;
+    _map_pos = nl ? nl + 1 : _map_end;
+    _line_number++;
+
+    if (PrintParsedLine) {
+        printf("%lld: %.*s\n", _line_number, (int)_line_len, _line_begin);
+    }
+    return true;
+}
+
+/**@brief Make the current physical line the text being parsed
+ *
+ * assign() reuses the capacity of _text, so no allocation happens once the
+ * buffer has grown to the longest line.
+ */
+void FileParser::load_mapped_line() {
+    _text.assign(_line_begin, _line_len);
+    _intext_pos = 0;
+    _char = _text[_intext_pos];
+    _eol = false;
+}
+
+bool FileParser::getline() {
+    if (_use_map) {
+        if (next_mapped_line()) {
+            load_mapped_line();
+        }
+        else {
+            /* mimic std::getline(), which clears the string when nothing is extracted */
+            _text.clear();
+            _good = false;
+            _eof = true;
+        }
+        return _good;
+    }
+
     if (std::getline(_ifs, _text)) {
         _line_number++;
         _intext_pos = 0;
@@ -35,35 +199,65 @@ std::ifstream& FileParser::getline() {
         }
     }
 
-    return _ifs;
+    return (bool)_ifs;
 }
 
-std::ifstream& FileParser::getline_nocomment() {
+bool FileParser::getline_nocomment() {
+    if (_use_map) {
+        while (next_mapped_line()) {
+            if (_line_len == 0 || _line_begin[0] != ';') {
+                load_mapped_line();
+                return true;
+            }
+        }
+        return getline();  // fails and sets the eof states
+    }
+
     do {
         if (!getline()) {
             break;
         }
     } while (line()[0] == ';');
 
-    return _ifs;
+    return (bool)_ifs;
 }
 
-std::ifstream& FileParser::getline_nonempty() {
+bool FileParser::getline_nonempty() {
+    if (_use_map) {
+        while (next_mapped_line()) {
+            if (_line_len != 0) {
+                load_mapped_line();
+                return true;
+            }
+        }
+        return getline();
+    }
+
     do {
         if (!getline()) {
             break;
         }
     } while (line().empty());
 
-    return _ifs;
+    return (bool)_ifs;
 }
 
-std::ifstream& FileParser::get_real_line() {
+bool FileParser::get_real_line() {
+    if (_use_map) {
+        while (next_mapped_line()) {
+            if (_line_len != 0 && _line_begin[0] != ';') {
+                load_mapped_line();
+                return true;
+            }
+        }
+        return getline();
+    }
+
     do {
         if (!getline()) {
             break;
         }
     } while (line().empty() || line()[0] == ';');
 
-    return _ifs;
-}
\ No newline at end of file
+    return (bool)_ifs;
+}
@@ -7,23 +7,63 @@
 
 #include <fstream>
 #include "stringParser.h"
+#include <utilities/stringRef.h>
+#include "mappedFile.h"
 
+/**@brief Line-oriented reader of an input file.
+ *
+ * With -XX:+UseMmapInput (default) a regular file is mapped into memory
+ * and lines are located in the mapping directly; blank and comment lines
+ * are skipped by advancing a pointer, and only the accepted line is copied
+ * into the reusable text buffer. Inputs that can't be mapped, such as pipes,
+ * are read through a std::ifstream instead.
+ */
 class FileParser: public virtual StringParser {
 protected:
     string _file_name;
     std::ifstream _ifs;
     long long _line_number;
 
+    /* mmap mode */
+    MappedFile* _mapped;
+    bool _owns_mapping;
+    const char* _map_pos;
+    const char* _map_end;
+    const char* _line_begin;  // start of the current physical line in the mapping
+    size_t _line_len;
+    bool _use_map;
+    bool _good;
+    bool _eof;
+
+    bool next_mapped_line();
+    void load_mapped_line();
 public:
     FileParser();
     const string& filename()                                 { return _file_name; }
     string& line()                                           { return _text; }
     long long line_number()                                  { return _line_number; }
 
-    std::ifstream& getline();
-    std::ifstream& getline_nocomment();
-    std::ifstream& getline_nonempty();
-    std::ifstream& get_real_line();
+    bool open(const string& file);
+    bool open_slice(MappedFile* file, const char* begin, const char* end, long long line_before);
+    void seek_mapped(const char* pos, long long line_before);
+    void close();
+    bool is_open()                                           { return _use_map || _ifs.is_open(); }
+    bool is_mapped()                                         { return _use_map; }
+    /// The mapping outlives this parser, e.g. it is owned by the module being parsed
+    bool mapping_is_shared()                                 { return _use_map && !_owns_mapping; }
+    bool good()                                              { return _use_map ? _good : (bool)_ifs; }
+    bool eof()                                               { return _use_map ? _eof : _ifs.eof(); }
+
+    /// The bytes of the last physical line read, inside the mapping. NULL when not mapped.
+    const char* line_begin()                                 { return _use_map ? _line_begin : NULL; }
+    size_t line_length()                                     { return _line_len; }
+    StringRef line_ref();
+    MappedFile* share_mapping();
+
+    bool getline();
+    bool getline_nocomment();
+    bool getline_nonempty();
+    bool get_real_line();
 
     virtual void reset_parser();
 };
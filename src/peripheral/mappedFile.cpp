@@ -0,0 +1,66 @@
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mappedFile.h"
+
+/**@brief Map the file at @param path into memory
+ *
+ * The kernel is told that the mapping will be read sequentially
+ * and asked to start reading ahead right away, which is how the
+ * parser walks through it.
+ *
+ * @return false if the file can't be mapped, in which case nothing is held open
+ */
+bool MappedFile::open(const string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps its own reference to the file
+    if (p == MAP_FAILED) {
+        return false;
+    }
+
+    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+    madvise(p, (size_t)st.st_size, MADV_WILLNEED);
+
+    _data = (const char*)p;
+    _size = (size_t)st.st_size;
+    _path = path;
+    return true;
+}
+
+void MappedFile::close() {
+    if (_data) {
+        munmap((void*)_data, _size);
+    }
+    _data = NULL;
+    _size = 0;
+    _path.clear();
+}
+
+/**@brief Drop the pages that lie entirely within [@param begin, @param end) from memory
+ *
+ * The mapping stays valid, the pages are read from the file again if touched.
+ */
+void MappedFile::release(const char* begin, const char* end) {
+    guarantee(begin >= _data && end <= _data + _size, "release range out of the mapping");
+    const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t b = ((uintptr_t)begin + page - 1) & ~(page - 1);
+    uintptr_t e = (uintptr_t)end & ~(page - 1);
+    if (b < e) {
+        madvise((void*)b, e - b, MADV_DONTNEED);
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef LLPARSER_MAPPEDFILE_H
+#define LLPARSER_MAPPEDFILE_H
+
+#include <cstddef>
+#include "utilities/macros.h"
+
+/**@brief A read-only memory mapping of a whole input file.
+ *
+ * Only regular, non-empty files can be mapped. Pipes, fifos and
+ * character devices make open() fail so that the caller can fall
+ * back to a std::ifstream.
+ *
+ * The mapping is private, but the file must still not be truncated while it is
+ * mapped, or reading the lost pages raises SIGBUS. sopt never writes its output
+ * in place, see Systems::output_path_for().
+ */
+class MappedFile {
+    const char* _data;
+    size_t _size;
+    string _path;
+public:
+    MappedFile(): _data(NULL), _size(0) {}
+    ~MappedFile()                                       { close(); }
+
+    bool open(const string& path);
+    void close();
+
+    bool is_open() const                                { return _data != NULL; }
+    const char* data() const                            { return _data; }
+    const char* end() const                             { return _data + _size; }
+    size_t size() const                                 { return _size; }
+    const string& path() const                          { return _path; }
+
+    bool contains(const char* p) const                  { return p >= _data && p < _data + _size; }
+    void release(const char* begin, const char* end);
+};
+
+#endif //LLPARSER_MAPPEDFILE_H
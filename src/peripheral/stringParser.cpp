@@ -2,6 +2,7 @@
 // Created by tlaber on 6/14/17.
 //
 
+#include <utilities/charScan.h>
 #include "stringParser.h"
 
 StringParser::StringParser() {
@@ -12,13 +13,23 @@ StringParser::StringParser() {
     _eol = false;
 }
 
-void StringParser::set_text(string & text) {
+void StringParser::set_text(const string & text) {
     _text = text;
     _intext_pos = 0;
     _char = _text[_intext_pos];
     _eol = false;
 }
 
+/**@brief Same as set_text(const string&), but takes the bytes from a raw buffer
+ * so that callers holding a view (e.g. into a mapped file) need no temporary string.
+ */
+void StringParser::set_text(const char* s, size_t n) {
+    _text.assign(s, n);
+    _intext_pos = 0;
+    _char = _text[_intext_pos];
+    _eol = false;
+}
+
 /**@brief This function won't set _eol in any case.
  * In other words, the argument can't be an out-of-range position
  *
@@ -30,6 +41,15 @@ void StringParser::set_intext_pos(int p) {
     _char = _text[_intext_pos];
 }
 
+/**@brief Restart parsing from the beginning of the current text without touching the text
+ *
+ */
+void StringParser::rewind() {
+    _intext_pos = 0;
+    _char = _text[_intext_pos];
+    _eol = false;
+}
+
 void StringParser::match(char c, bool skip_whitspace) {
     if (skip_whitspace)
         skip_ws();
@@ -302,11 +322,8 @@ StringParser* StringParser::get_word_of(string delims, bool append_delim, bool s
 
     if (!_eol) {
         int startp = intext_pos();
-        int endp = text().find_first_of(delims, startp);
-
-        if (endp == string::npos) {
-            endp = text().size();
-        }
+        int endp = startp + CharScan::find_first_of(_text.data() + startp, _text.size() - startp,
+                                                    delims.data(), delims.size());
 
         inc_intext_pos(endp - startp);
         _word = text().substr(startp, endp - startp);
@@ -391,10 +408,10 @@ void StringParser::jump_ahead() {
 /**@brief When current char is '(', '{', '[' or '<', jump to the end of the scope and return the skipped part
  *
  * One assumption of this function is that the left mark (like '[') must be different from the right mark.
+ * Marks inside a quoted string (like c"(\00") do not count.
  * @return
  */
 string StringParser::jump_to_end_of_scope() {
-    int num = 1;
     char left = _char;
     char right = ' ';
     if (left == '(') {
@@ -413,28 +430,21 @@ string StringParser::jump_to_end_of_scope() {
         parser_assert(0, "Bad scope start with %c", left);
     }
 
-    string text;
-    while (num != 0) {
-        text += _char;
-        inc_intext_pos();
-        if (_char == left) {
-            num++;
-        }
-        else if (_char == right) {
-            num--;
-        }
-    }
-    text += right;
-
-    guarantee(_char == right, " ");
-    inc_intext_pos();
+    int startp = _intext_pos;
+    size_t len = CharScan::find_scope_end(_text.data() + startp, _text.size() - startp, left, right);
+    parser_assert(len < _text.size() - startp, "Scope starting with %c is not closed", left);
 
-    return text;
+    inc_intext_pos(len + 1);
+    return _text.substr(startp, len + 1);
 }
 
 void StringParser::skip_ws() {
-    while (!_eol && _text[_intext_pos] == ' ' || _text[_intext_pos] == '\t' || _text[_intext_pos] == '\n') {
-        inc_intext_pos();
+    if (_eol) {
+        return;
+    }
+    size_t n = CharScan::skip_whitespace(_text.data() + _intext_pos, _text.size() - _intext_pos);
+    if (n) {
+        inc_intext_pos(n);
     }
 }
 
@@ -23,10 +23,12 @@ public:
     StringParser();
 
     string& text()                                        { return _text; }
-    void set_text(string& );
+    void set_text(const string& );
+    void set_text(const char* s, size_t n);
 
     int intext_pos()                                      { return _intext_pos; }
     void set_intext_pos(int p);
+    void rewind();
 
     string jump_to_end_of_scope();
     void skip_ws();
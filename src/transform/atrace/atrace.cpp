@@ -69,14 +69,14 @@ public:
 
             /* do load inst */
             if (LoadInst* li = dynamic_cast<LoadInst*>(I)) {
-                if (!li->get_raw_field("pointer").empty()) {
+                if (!li->get_raw_field(RawField::Pointer).empty()) {
                     //zpl("got %s, %s", I->raw_c_str(), li->pointer_type_str().c_str());
-                    string addr = li->get_raw_field("pointer");
-                    string value_ty = li->get_raw_field("ty");
+                    string addr = li->get_raw_field(RawField::Pointer);
+                    string value_ty = li->get_raw_field(RawField::Ty);
                     // skip global ints and bools
                     if (_skip_gint && (value_ty == "i64" || value_ty == "i32" || value_ty == "i8") && addr[0] == '@') {  
                         i++;
-                        zpl("skip %s", li->raw_c_str());
+                        zpl("skip %s", li->raw_str().c_str());
                         _skipped++;
                         continue;
                     }
@@ -104,20 +104,20 @@ public:
 
             /* do store inst */
             if (StoreInst* si = dynamic_cast<StoreInst*>(I)) {
-                if (!si->get_raw_field("pointer").empty()) {
+                if (!si->get_raw_field(RawField::Pointer).empty()) {
                     //zpl("got %s, %s", I->raw_c_str(), si->pointer_type_str().c_str());
-                    string addr = si->get_raw_field("pointer");
-                    string value_ty = si->get_raw_field("ty");
+                    string addr = si->get_raw_field(RawField::Pointer);
+                    string value_ty = si->get_raw_field(RawField::Ty);
                     if (_skip_gint && (value_ty == "i64" || value_ty == "i32" || value_ty == "i8") && addr[0] == '@') {
                         i++;
-                        zpl("skip %s", si->raw_c_str());
+                        zpl("skip %s", si->raw_str().c_str());
                         _skipped++;
                         continue;
                     }
 
 
                     string casted_addr = "%tz_store_addr" + std::to_string(_store_cnt++);
-                    string cast_inst_text = "  " +  casted_addr + " = bitcast " + si->get_raw_field("ty") + "* " + addr + " to i8*";
+                    string cast_inst_text = "  " +  casted_addr + " = bitcast " + si->get_raw_field(RawField::Ty) + "* " + addr + " to i8*";
                     Instruction* cast_inst = IRBuilder::create_instruction(cast_inst_text);
 
                     string call_inst_text = "  call void @xps_record_store(i8* " + casted_addr + ")";
@@ -14,6 +14,7 @@
 #include <peripheral/sysArgs.h>
 #include <inst/instEssential.h>
 #include <asmParser/irBuilder.h>
+#include <passes/analyses.h>
 
 
 struct MFunc {
@@ -129,57 +130,11 @@ public:
   }
 
   void init_lang() {
-    if (_lang == "c" || _lang == "cpp" || _lang == "all") {
-      _alloc_set.push_back(new MFunc("malloc", "ben_malloc", true));
-      _alloc_set.push_back(new MFunc("calloc", "ben_calloc", true));
-      _alloc_set.push_back(new MFunc("realloc", "ben_realloc", true));
-      _free_set.push_back(new MFunc("free", "ben_free", false));
-    }
-
-    if (_lang == "cpp" || _lang == "all") {
-      _alloc_set.push_back(new MFunc("_Znam", "ben_malloc", true));
-      _alloc_set.push_back(new MFunc("_Znwm", "ben_malloc", true));
-      _free_set.push_back(new MFunc("_ZdaPv", "ben_free", false));
-      _free_set.push_back(new MFunc("_ZdlPv", "ben_free", false));
-    }
-
-    if (_lang == "flang" || _lang == "all") {
-      _alloc_set.push_back(new MFunc("f90_alloc", "f90_ben_alloc", true));
-      _alloc_set.push_back(new MFunc("f90_alloc03", "f90_ben_alloc03", true));
-      _alloc_set.push_back(new MFunc("f90_alloc03_chk", "f90_ben_alloc03_chk", true));
-      _alloc_set.push_back(new MFunc("f90_alloc04", "f90_ben_alloc04", true));
-      _alloc_set.push_back(new MFunc("f90_alloc04_chk", "f90_ben_alloc04_chk", true));
-
-      _alloc_set.push_back(new MFunc("f90_kalloc", "f90_ben_kalloc", true));
-      _alloc_set.push_back(new MFunc("f90_calloc", "f90_ben_calloc", true));
-      _alloc_set.push_back(new MFunc("f90_calloc03", "f90_ben_calloc03", true));
-      _alloc_set.push_back(new MFunc("f90_calloc04", "f90_ben_calloc04", true));
-      _alloc_set.push_back(new MFunc("f90_kcalloc", "f90_ben_kcalloc", true));
-      _alloc_set.push_back(new MFunc("f90_ptr_alloc", "f90_ben_ptr_alloc", true));
-      _alloc_set.push_back(new MFunc("f90_ptr_alloc03", "f90_ben_ptr_alloc03", true));
-      _alloc_set.push_back(new MFunc("f90_ptr_alloc04", "f90_ben_ptr_alloc04", true));
-      _alloc_set.push_back(new MFunc("f90_ptr_src_alloc03", "f90_ben_ptr_src_alloc03", true));
-      _alloc_set.push_back(new MFunc("f90_ptr_src_alloc04", "f90_ben_ptr_src_alloc04", true));
-      _alloc_set.push_back(new MFunc("f90_ptr_src_calloc03", "f90_ben_ptr_src_calloc03", true));
-      _alloc_set.push_back(new MFunc("f90_ptr_src_calloc04", "f90_ben_ptr_src_calloc04", true));
-      _alloc_set.push_back(new MFunc("f90_ptr_kalloc", "f90_ben_ptr_kalloc", true));
-      _alloc_set.push_back(new MFunc("f90_ptr_calloc", "f90_ben_ptr_calloc", true));
-      _alloc_set.push_back(new MFunc("f90_ptr_calloc03", "f90_ben_ptr_calloc03", true));
-      _alloc_set.push_back(new MFunc("f90_ptr_calloc04", "f90_ben_ptr_calloc04", true));
-      _alloc_set.push_back(new MFunc("f90_ptr_kcalloc", "f90_ben_ptr_kcalloc", true));
-      _alloc_set.push_back(new MFunc("f90_auto_allocv", "f90_ben_auto_allocv", true));
-      _alloc_set.push_back(new MFunc("f90_auto_alloc", "f90_ben_auto_alloc", true));
-      _alloc_set.push_back(new MFunc("f90_auto_alloc04", "f90_ben_auto_alloc04", true));
-      _alloc_set.push_back(new MFunc("f90_auto_calloc", "f90_ben_auto_calloc", true));
-      _alloc_set.push_back(new MFunc("f90_auto_calloc04", "f90_ben_auto_calloc04", true));
-
-      _free_set.push_back(new MFunc("f90_dealloc", "f90_ben_dealloc", false));
-      _free_set.push_back(new MFunc("f90_dealloc03", "f90_ben_dealloc03", false));
-      _free_set.push_back(new MFunc("f90_dealloc_mbr", "f90_ben_dealloc_mbr", false));
-      _free_set.push_back(new MFunc("f90_dealloc_mbr03", "f90_ben_dealloc_mbr03", false));
-      _free_set.push_back(new MFunc("f90_deallocx", "f90_ben_deallocx", false));
-      _free_set.push_back(new MFunc("f90_auto_dealloc", "f90_ben_auto_dealloc", false));
-      // todo
+    for (auto& k: MemoryFunctions::known()) {
+      if (MemoryFunctions::is_used_by(k, _lang)) {
+        auto& set = k.is_free ? _free_set : _alloc_set;
+        set.push_back(new MFunc(k.name, k.ben_name, k.add_id));
+      }
     }
   }
 
@@ -224,13 +179,13 @@ public:
             if (I->is_indirect_call()) {
               BitCastInst* bci = dynamic_cast<BitCastInst*>(I->chain_inst());
               if (!bci) {
-                printf("Chain instruction not found for: %s\n", I->raw_c_str());
+                printf("Chain instruction not found for: %s\n", I->raw_str().c_str());
               }
               guarantee(bci, "");
-              bci->update_raw_field("value", "@" + t->new_name);
-              string ty2 = bci->get_raw_field("ty2");
+              bci->update_raw_field(RawField::Value, "@" + t->new_name);
+              string ty2 = bci->get_raw_field(RawField::Ty2);
               insert_i32_to_type(ty2);
-              bci->update_raw_field("ty2", ty2);
+              bci->update_raw_field(RawField::Ty2, ty2);
             }
             else {
               I->replace_callee(t->new_name);
@@ -251,13 +206,13 @@ public:
             //zpl("map %d to %d", id, _ap_map[id]);
             id = _ap_map[id];
           }
-          string new_args = "i32 " + std::to_string(id) + ", " + I->get_raw_field("args");
+          string new_args = "i32 " + std::to_string(id) + ", " + I->get_raw_field(RawField::Args);
           I->replace_args(new_args);
 
           if (flang_alloc) {
-            string fnty = I->get_raw_field("fnty");
+            string fnty = I->get_raw_field(RawField::Fnty);
             insert_i32_to_type(fnty);
-            I->update_raw_field("fnty", fnty);
+            I->update_raw_field(RawField::Fnty, fnty);
             //I->dump();
           }
 
@@ -286,7 +241,7 @@ public:
           for (auto& suf: suffixes) {
             for (auto& t: _free_set) {
               string old = "@"+t->old_name+suf;
-              if (I->raw_text().find(old) != string::npos) {
+              if (I->raw_view().find(old) != string::npos) {
                 Strings::ireplace(I->raw_text(), old, "@"+t->new_name+suf);
                 _new_frees++;
               }
@@ -306,7 +261,7 @@ public:
             //string targets[4] = {"malloc", "calloc", "realloc", "free"};
             for (auto& t: _alloc_set) {
               string old = "@"+t->old_name+suf;
-              if (I->raw_text().find(old) != string::npos) {
+              if (I->raw_view().find(old) != string::npos) {
                 Strings::ireplace(I->raw_text(), old, "@indi_"+t->old_name+suf);
               }
             }
@@ -333,7 +333,7 @@ public:
     void check_unused(Module* module) {
         printf("unused clone check...\n");
         for (auto F:module->function_list()) {
-            if (F->user_set().empty() && F->is_clone()) {
+            if (F->resolved_users().empty() && F->is_clone()) {
                 printf("Function %s is unused\n", F->name_as_c_str());
             }
         }
@@ -352,7 +352,7 @@ public:
         printf("call site num: %d\n", _all_paths.size());
         for (auto xpath: _all_paths) {
             CallInstFamily* alloc_caller = xpath->path[0];
-            string args = alloc_caller->get_raw_field("args");
+            string args = alloc_caller->get_raw_field(RawField::Args);
             ctx_log << get_apid_from_args(args) << " "
                     << alloc_caller->called_function()->name()
                     << std::endl;
@@ -49,7 +49,7 @@ std::vector<XPath*> ContextGenerator::generate(Module* module, string alloc,
   }
 
   int skip_cnt = 0;
-  for (auto ci: alloc_f->caller_list()) {
+  for (auto ci: alloc_f->callers()) {
     /* A special handler for wrf, with disabling this problematic function,
      * 1. there're over 2M contexts which cause memory usage issue
      * 2. the generated new IR is uncompilable for whatever reason
@@ -80,13 +80,13 @@ std::vector<XPath*> ContextGenerator::generate(Module* module, string alloc,
       // Stop traversing callers for functions that have no callers
       // or module_configure_in_use_for_config_ for wrf
       Function* F = tos->function();
-      if (F->caller_list().empty()
+      if (F->callers().empty()
         || F->name() == "module_configure_in_use_for_config_") {
         new_paths.push_back(xpath);
         DEBUG(zpl("reached top: %s", tos->function()->name_as_c_str());)
       }
       else {
-        for (auto ci: tos->function()->caller_list()) {
+        for (auto ci: tos->function()->callers()) {
           XPath* nxp = new XPath();
           nxp->hotness = xpath->hotness;
           nxp->path = context;
@@ -135,7 +135,7 @@ std::vector<XPath*> ContextGenerator::generate(Module* module, string alloc,
 
 void ContextGenerator::traverse() {
   auto tos = _stack[_stack.size()-1];
-  for (auto ci: tos->function()->caller_list()) {
+  for (auto ci: tos->function()->callers()) {
     _stack.push_back(ci);
     if (_stack.size() < 3) {
       traverse();
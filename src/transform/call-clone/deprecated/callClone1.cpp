@@ -573,7 +573,7 @@ public:
             guarantee(old_callee == "malloc" || old_callee == "calloc" || old_callee == "realloc", "old callee: %s", old_callee.c_str());
             ci->replace_callee("ben_"+old_callee);
             _ben_num++;
-            string new_args = "i32 " + std::to_string(id++) + ", " + ci->get_raw_field("args");
+            string new_args = "i32 " + std::to_string(id++) + ", " + ci->get_raw_field(RawField::Args);
             ci->replace_args(new_args);
         }
     }
@@ -6,6 +6,7 @@
 #include <sys/wait.h>
 #include <set>
 #include <iomanip>
+#include <climits>
 
 #include <peripheral/sysArgs.h>
 #include <inst/instEssential.h>
@@ -13,6 +14,7 @@
 #include <di/diEssential.h>
 #include <passes/pass.h>
 #include <ir/irEssential.h>
+#include <passes/analysisManager.h>
 #include <utilities/strings.h>
 #include <asmParser/sysDict.h>
 
@@ -58,12 +60,12 @@ bool CallgraphPass::run_on_module(Module *module) {
                 continue;
             }
 
-            if (F->caller_list().empty()) {
+            if (F->callers().empty()) {
                 continue;
             }
 
-            _caller_ofs << std::left << std::setw(50) << F->name() << F->caller_list().size() << std::endl;
-            for (auto I: F->caller_list()) {
+            _caller_ofs << std::left << std::setw(50) << F->name() << F->callers().size() << std::endl;
+            for (auto I: F->callers()) {
                 if (CallInstFamily* cif = dynamic_cast<CallInstFamily*>(I)) {
                     print_dot_line(I->function()->name(), F->name());
                     _caller_ofs << "  - " << I->function()->name() << std::endl;
@@ -100,19 +102,24 @@ bool CallgraphPass::run_on_module(Module *module) {
 //        waitpid(-1, &wstatus, 0);
         }
     }
+    return false;
 }
 
 void CallgraphPass::traverse(Function *F, Module* module) {
     guarantee(F, "function %s not found", F->name_as_c_str());
 
-    _visited.insert(F->name());
-    for (auto I: F->caller_list()) {
-        string caller_name = I->function()->name();
-        print_dot_line(caller_name, F->name());
-        //_dot_ofs << '"' << caller_name << "\" -> \"" << F->name() << "\";\n";
-
-        if (_visited.find(caller_name) == _visited.end()) {
-            traverse(module->get_function(caller_name), module);
+    /* every function that reaches F, one dot line per call site */
+    CallGraph& cg = analyses().get<CallGraph>(module);
+    std::vector<CallGraph::Node> nodes;
+    cg.callers_within(cg.node(F), INT_MAX, nodes);
+    for (auto callee: nodes) {
+        if (!_visited.insert(cg.function(callee)->name()).second) {
+            continue;
+        }
+        for (auto caller: cg.callers(callee)) {
+            for (uint32_t i = cg.call_sites(caller, callee); i > 0; --i) {
+                print_dot_line(cg.function(caller)->name(), cg.function(callee)->name());
+            }
         }
     }
 
@@ -149,12 +149,38 @@ public:
       Function* callerF = get_function(caller, caller_file);
       guarantee(calleeF, "Function %s not found", callee.c_str());
       guarantee(callerF, "Function %s not found", caller.c_str());
-      do_clone(calleeF, callerF, new_callee, point);
+      do_clone(calleeF, callerF, caller_file, new_callee, point);
     }
   }
 
-  void do_clone(Function* callee, Function* caller, string newname,
-                Point2D<int> callsite) {
+  /** @brief The call to @param callee in @param caller at @param callsite of @param file
+   *
+   * The call site is looked up as a source line_column in the module's CallSiteIndex,
+   * preferring a call at that column. Without debug info it is taken as the
+   * block_instruction position of the call in @param caller.
+   */
+  CallInstFamily* find_call(Function* callee, Function* caller, const string& file,
+                            Point2D<int>& callsite) {
+    CallSiteIndex& index = caller->parent()->call_site_index();
+    if (!index.empty()) {
+      auto in_caller = [&](CallInstFamily* ci) {
+        return ci->function() == caller && callee->resolved_users().contains(ci);
+      };
+      CallInstFamily* ci = index.nearest(file, callsite.x, 0, [&](CallInstFamily* ci) {
+        return in_caller(ci) && ci->debug_loc()->column() == callsite.y;
+      });
+      if (!ci) {
+        ci = index.nearest(file, callsite.x, 0, in_caller);
+      }
+      if (ci) {
+        return ci;
+      }
+    }
+    return dynamic_cast<CallInstFamily*>(caller->get_instruction(callsite));
+  }
+
+  void do_clone(Function* callee, Function* caller, const string& caller_file,
+                string newname, Point2D<int> callsite) {
     Module* calleeM = callee->parent();
     Module* callerM = caller->parent();
     Function* callee_clone = callee->clone(newname);
@@ -163,8 +189,7 @@ public:
     //zpl("append cloned f %s", callee_clone->name().c_str());
     calleeM->append_new_function(callee_clone);
 
-    auto user_i = dynamic_cast<CallInstFamily*>(
-      caller->get_instruction(callsite));
+    auto user_i = find_call(callee, caller, caller_file, callsite);
     guarantee(user_i, "");
 
     /* need to insert declaration if inter-procedural */
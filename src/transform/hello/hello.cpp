@@ -19,6 +19,7 @@ public:
 
     bool run_on_function(Function* func) {
         printf("hello function: %s\n", func->name().c_str());
+        return false;
     }
 
     void do_finalization(Module* m)  {
@@ -674,7 +674,7 @@ public:
                 guarantee(old_callee == "malloc" || old_callee == "calloc" || old_callee == "realloc", " ");
                 ci->replace_callee("ben_"+old_callee);
                 _ben_num++;
-                string new_args = "i32 " + std::to_string(_hot_counter) + ", " + ci->get_raw_field("args");
+                string new_args = "i32 " + std::to_string(_hot_counter) + ", " + ci->get_raw_field(RawField::Args);
                 ci->replace_args(new_args);
             }
         }
@@ -43,6 +43,7 @@ class HotCallClonePass: public Pass {
     std::map<CallInstFamily*, std::vector<XPS_Caller*>> _callers_map;
     std::map<CallInstFamily*, int> _dr_caller_freq;
     CallInstFamily* _search_root;
+    std::set<Function*> _located_callees;  // see check_debug_locs()
 
     std::vector<CallInstFamily*> _stack;
     string _caller;
@@ -547,60 +548,67 @@ public:
         return ret;
     }
 
-    CallInstFamily* approximately_match_alloc(string filename, int line) {
-        CallInstFamily* final = NULL;
+    CallSiteIndex& call_site_index() {
+        CallSiteIndex& index = SysDict::module()->call_site_index();
+        guarantee(!index.empty(), "This pass needs full debug info, please compile with -g");
+        return index;
+    }
+
+    /* The call site index skips calls without a location, so check that every call that
+     * level 1 picks from has one. Once per callee is enough, clones keep the location. */
+    void check_debug_locs(Function* callee) {
+        if (!_located_callees.insert(callee).second) {
+            return;
+        }
+        for (auto ci: callee->caller_list()) {
+            guarantee(ci->debug_loc(), "This pass needs full debug info, please compile with -g");
+        }
+    }
+
+    /* for C++ the call must also be in the caller of the frame */
+    bool in_caller(CallInstFamily* ci) {
+        if (SysDict::module()->language() == Module::Language::cpp) {
+            return ci->debug_loc()->function_linkage_name() == _caller;
+        }
+        return true;
+    }
 
-        // level 1
-        std::map<CallInstFamily*, int> users_offsets;
-        std::vector<CallInstFamily*> other_callers;
+    /* the calls to @param callee that level 1 of approximately_match() picks from */
+    void print_candidates(Function* callee, const string& filename, int line) {
+        std::vector<CallSiteIndex::Site> sites;
+        call_site_index().sites_near(filename, line, 9, sites);
+        for (auto& s: sites) {
+            if (!callee->resolved_users().contains(s.call)) {
+                continue;
+            }
+            DILocation *loc = s.call->debug_loc();
+            printf("loc->filename(): %s, loc->line(): %d, loc function: %s\n",
+                   loc->filename().c_str(), loc->line(), loc->function_linkage_name().c_str());
+            printf("filename: %s, line: %d, caller: %s\n\n",
+                   filename.c_str(), line, _caller.c_str());
+        }
+    }
 
+    CallInstFamily* approximately_match_alloc(string filename, int line) {
+        // level 1: the nearest call to an allocator within 9 lines
         //std::vector<string> candidates = {"malloc", "calloc", "realloc", "_Znam", "_Znwm", "_ZdaPv", "_ZdlPv"};
         std::vector<string> candidates = {"malloc", "calloc", "realloc"};
+        std::vector<Function*> allocs;
         for (auto c: candidates) {
             if (Function* alloc = SysDict::module()->get_function(c)) {
-                for (auto I: alloc->caller_list()) {
-                    if (CallInstFamily* ci = dynamic_cast<CallInstFamily*>(I)) {
-                        DILocation *loc = ci->debug_loc();
-                        guarantee(loc, "This pass needs full debug info, please compile with -g");
-                        if (Strings::contains(filename, loc->filename())
-                            && std::abs(line-loc->line()) < 10) {
-                            if (SysDict::module()->language() == Module::Language::cpp) {
-                                if (loc->function_linkage_name() == _caller) {
-                                    users_offsets[ci] = std::abs(line-loc->line());
-                                }
-                            }
-                            else {
-                                users_offsets[ci] = std::abs(line-loc->line());
-                            }
-
-                        }
-                        else {
-                            other_callers.push_back(ci);
-                        }
-                    }
-                }
+                check_debug_locs(alloc);
+                allocs.push_back(alloc);
             }
         }
 
-        if (users_offsets.size() == 0) {
-            final = NULL;
-        }
-        else if (users_offsets.size() == 1) {
-            final = users_offsets.begin()->first;
-        }
-        else {
-            int closest = users_offsets.begin()->second;
-            CallInstFamily* closest_I = users_offsets.begin()->first;
-            if (!final) {
-                for (auto it = users_offsets.begin(); it != users_offsets.end(); ++it) {
-                    if (it->second < closest) {
-                        closest = it->second;
-                        closest_I = it->first;
-                    }
+        CallInstFamily* final = call_site_index().nearest(filename, line, 9, [&](CallInstFamily* ci) {
+            for (auto alloc: allocs) {
+                if (alloc->resolved_users().contains(ci)) {
+                    return in_caller(ci);
                 }
-                final = closest_I;
             }
-        }
+            return false;
+        });
 
         if (final) {
             _caller = final->function()->name();
@@ -646,59 +654,15 @@ public:
             final = users[0];
         }
 
-        // level 1
-        std::map<CallInstFamily*, int> users_offsets;
-        std::vector<CallInstFamily*> other_callers;
+        // level 1: the nearest call to the callee within 9 lines
         if (!final) {
-            for (auto I: calleef->caller_list()) {
-                if (CallInstFamily* ci = dynamic_cast<CallInstFamily*>(I)) {
-                    DILocation *loc = ci->debug_loc();
-                    guarantee(loc, "This pass needs full debug info, please compile with -g");
-                    if (Strings::contains(filename, loc->filename()) &&  std::abs(line-loc->line()) < 10) {
-                        if (MatchVerbose) {
-                            printf("loc->filename(): %s, loc->line(): %d, loc function: %s\n",
-                                   loc->filename().c_str(), loc->line(), loc->function_linkage_name().c_str());
-                            printf("filename: %s, line: %d, caller: %s\n\n",
-                                   filename.c_str(), line, _caller.c_str());
-                        }
-
-                        if (SysDict::module()->language() == Module::Language::cpp) {
-                            if (loc->function_linkage_name() == _caller) {
-                                users_offsets[ci] = std::abs(line-loc->line());
-                            }
-                        }
-                        else {
-//                            if (loc->function_linkage_name() == _caller) {
-//                                users_offsets[ci] = std::abs(line-loc->line());
-//                            }
-                            users_offsets[ci] = std::abs(line-loc->line());
-                        }
-                    }
-                    else {
-                        other_callers.push_back(ci);
-                    }
-                }
-            }
-
-            if (users_offsets.size() == 0) {
-                final = NULL;
-            }
-            else if (users_offsets.size() == 1) {
-                final = users_offsets.begin()->first;
-            }
-            else {
-                int closest = users_offsets.begin()->second;
-                CallInstFamily* closest_I = users_offsets.begin()->first;
-                if (!final) {
-                    for (auto it = users_offsets.begin(); it != users_offsets.end(); ++it) {
-                        if (it->second < closest) {
-                            closest = it->second;
-                            closest_I = it->first;
-                        }
-                    }
-                    final = closest_I;
-                }
+            check_debug_locs(calleef);
+            if (MatchVerbose) {
+                print_candidates(calleef, filename, line);
             }
+            final = call_site_index().nearest(filename, line, 9, [&](CallInstFamily* ci) {
+                return calleef->resolved_users().contains(ci) && in_caller(ci);
+            });
         }
 
         /* not do this for now */
@@ -869,7 +833,7 @@ public:
                 guarantee(old_callee == "malloc" || old_callee == "calloc" || old_callee == "realloc", " ");
                 ci->replace_callee("ben_"+old_callee);
                 _ben_num++;
-                string new_args = "i32 " + std::to_string(_hot_counter) + ", " + ci->get_raw_field("args");
+                string new_args = "i32 " + std::to_string(_hot_counter) + ", " + ci->get_raw_field(RawField::Args);
                 ci->replace_args(new_args);
             }
         }
@@ -5,6 +5,7 @@
 
 #include <passes/pass.h>
 #include <ir/irEssential.h>
+#include <passes/analyses.h>
 #include <iomanip>
 
 class InstcountPass: public Pass {
@@ -16,17 +17,11 @@ public:
     }
 
     bool run_on_module(Module* module) override {
-        size_t nfunc = 0;
-        size_t nbb = 0;
-        for (auto F: module->function_list()) {
-            nfunc++;
-            for (auto B: F->basic_block_list()) {
-                nbb++;
-                for (auto I: B->instruction_list()) {
-                    _op_count[I->opcode()]++;
-                    if (I->type() != Instruction::UnknownInstType) {
-                        _parsed++;
-                    }
+        for (auto& op: analyses().get<OpcodeIndex>(module)) {
+            _op_count[op.first] += op.second.size();
+            for (auto I: op.second) {
+                if (I->type() != Instruction::UnknownInstType) {
+                    _parsed++;
                 }
             }
         }
@@ -39,6 +34,7 @@ public:
         }
         std::cout << std::setw(20) << "parsed" << " insts: " << _parsed << "/" << total << '\n';
         std::cout << "\n";
+        return false;
     }
 };
 
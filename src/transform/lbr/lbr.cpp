@@ -2,7 +2,8 @@
 #include <passes/pass.h>
 #include <ir/irEssential.h>
 #include <asmParser/irBuilder.h>
-#include <transform/ben-alloc/benAlloc.cpp>
+#include <asmParser/sysDict.h>
+#include <passes/analyses.h>
 
 // A module pass template
 
@@ -23,43 +24,23 @@ public:
     }
 
     void get_target_functions(Module* module, std::set<Function*>& funcs) {
-        BenAllocPass* ben_alloc = new BenAllocPass();
-        ben_alloc->do_initialization();
-        for (auto i: ben_alloc->alloc_set()) {
-            get_callers(module, i->old_name, funcs, _nlevel);
+        for (auto alloc_f: analyses().get<MemoryFunctions>(module).allocs()) {
+            get_callers(module, alloc_f, funcs, _nlevel);
         }
     }
 
-    void get_callers(Module* module, string& alloc, std::set<Function*>& funcs, int nlevel) {
-        Function* alloc_f = module->get_function(alloc);
-
-        if (!alloc_f) {
-            return;
-        }
-
-        std::set<Function*> old_set;
-        old_set.insert(alloc_f);
-
-        while (nlevel--) {
-            std::set<Function*> new_set;
-            for (auto f: old_set) {
-                for (auto ci: f->caller_list()) {
-                    new_set.insert(ci->function());
-                }
-                funcs.insert(f);
-            }
-
-            old_set = new_set;
-        }
-
-        for (auto i: old_set) {
-            funcs.insert(i);
+    void get_callers(Module* module, Function* alloc_f, std::set<Function*>& funcs, int nlevel) {
+        CallGraph& cg = analyses().get<CallGraph>(module);
+        std::vector<CallGraph::Node> nodes;
+        cg.callers_within(cg.node(alloc_f), nlevel, nodes);
+        for (auto n: nodes) {
+            funcs.insert(cg.function(n));
         }
     }
 
     void instrument_calls(Module* module, std::set<Function*>& funcs, int mode) {
         for (auto F: funcs) {
-            for (auto ci: F->caller_list()) {
+            for (auto ci: F->callers()) {
                 /* create instrument instructions */
                 string v1 = IRBuilder::get_new_local_varname();
                 Instruction* i1 = IRBuilder::create_instruction(v1+" = load i32, i32* @sopt_ctx, align 4");
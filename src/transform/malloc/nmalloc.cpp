@@ -205,10 +205,10 @@ public:
             if (bci && modify_bitcast(bci, new_callee, add_id)) {
                 string new_args;
                 if (add_id) {
-                    new_args = "i32 " + std::to_string(_counter) + ", " + ci->get_raw_field("args");
+                    new_args = "i32 " + std::to_string(_counter) + ", " + ci->get_raw_field(RawField::Args);
                 }
                 else {
-                    new_args = ci->get_raw_field("args");
+                    new_args = ci->get_raw_field(RawField::Args);
                 }
                 ci->replace_args(new_args);
             }
@@ -218,18 +218,18 @@ public:
 
             string new_args;
             if (add_id) {
-                new_args = "i32 " + std::to_string(_counter) + ", " + ci->get_raw_field("args");
+                new_args = "i32 " + std::to_string(_counter) + ", " + ci->get_raw_field(RawField::Args);
             }
             else {
-                new_args = ci->get_raw_field("args");
+                new_args = ci->get_raw_field(RawField::Args);
             }
             ci->replace_args(new_args);
         }
 
         if (ci->is_varargs()) {
             if (add_id) {
-                string args_sig = ci->get_raw_field("fnty");
-                guarantee(!args_sig.empty(), "problematic line: %s", ci->raw_c_str());
+                string args_sig = ci->get_raw_field(RawField::Fnty);
+                guarantee(!args_sig.empty(), "problematic line: %s", ci->raw_str().c_str());
                 string new_sig = args_sig;
 //            zpl("old sig: %s", args_sig.c_str());
 //            zpl("new sig: %s", new_sig.c_str());
@@ -292,10 +292,10 @@ public:
             old->replace_callee(new_callee);
             string new_args;
             if (add_id) {
-                new_args = "i32 " + std::to_string(_counter) + ", " + old->get_raw_field("args");
+                new_args = "i32 " + std::to_string(_counter) + ", " + old->get_raw_field(RawField::Args);
             }
             else {
-                new_args = old->get_raw_field("args");
+                new_args = old->get_raw_field(RawField::Args);
             }
 
             old->replace_args(new_args);
@@ -307,8 +307,8 @@ public:
 
         if (ci->is_varargs()) {
             if (add_id) {
-                string args_sig = ci->get_raw_field("fnty");
-                guarantee(!args_sig.empty(), "problematic line: %s", ci->raw_c_str());
+                string args_sig = ci->get_raw_field(RawField::Fnty);
+                guarantee(!args_sig.empty(), "problematic line: %s", ci->raw_str().c_str());
                 string new_sig = args_sig;
 //            zpl("old sig: %s", args_sig.c_str());
 //            zpl("new sig: %s", new_sig.c_str());
@@ -329,18 +329,18 @@ public:
 
     bool modify_bitcast(BitCastInst* bci, string new_value, bool add_id=true) {
         /* manipulate the text */
-        if (bci->get_raw_field("value")[0] != '@') {
+        if (bci->get_raw_field(RawField::Value)[0] != '@') {
             return false;
         }
 
         zpl("  old bitcast %s", bci->raw_text().c_str());
-        bci->update_raw_field("value", '@' + new_value);
+        bci->update_raw_field(RawField::Value, '@' + new_value);
 
         if (add_id) {
-            string new_casted_ty = bci->get_raw_field("ty2");
+            string new_casted_ty = bci->get_raw_field(RawField::Ty2);
             int insert_pos = new_casted_ty.find('(');
             new_casted_ty.insert(insert_pos+1, "i32, ");
-            bci->update_raw_field("ty2", new_casted_ty);
+            bci->update_raw_field(RawField::Ty2, new_casted_ty);
         }
         zpl("  new bitcast %s", bci->raw_text().c_str());
         return true;
@@ -354,12 +354,12 @@ public:
 
         /* manipulate the text */
         string text = old->raw_text();
-        string old_value = bci->get_raw_field("value");
+        string old_value = bci->get_raw_field(RawField::Value);
         new_value = '@' + new_value;
         Strings::ireplace(text, old_value, new_value);
 
         if (add_id) {
-            string old_casted_ty = bci->get_raw_field("ty2");
+            string old_casted_ty = bci->get_raw_field(RawField::Ty2);
             string new_casted_ty = old_casted_ty;
             int insert_pos = new_casted_ty.find('(');
             new_casted_ty.insert(insert_pos+1, "i32, ");
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <set>
+#include <climits>
 #include <utilities/macros.h>
 #include <asmParser/sysDict.h>
 #include <passes/pass.h>
@@ -142,52 +143,30 @@ public:
 //
 //    }
 
-    Instruction* approximately_match_alloc(string filename, int line) {
-        CallInstFamily* final = NULL;
+    CallSiteIndex& call_site_index() {
+        CallSiteIndex& index = SysDict::module()->call_site_index();
+        guarantee(!index.empty(), "This pass needs full debug info, please compile with -g");
+        return index;
+    }
 
-        // level 1
-        std::map<CallInstFamily*, int> users_offsets;
-        std::vector<CallInstFamily*> other_callers;
-        if (!final) {
-            std::vector<string> candidates = {"malloc", "calloc", "realloc"};
-            for (auto c: candidates) {
-                Function* alloc = SysDict::module()->get_function(c);
-                if (alloc) {
-                    for (auto I: alloc->caller_list()) {
-                        if (CallInstFamily* ci = dynamic_cast<CallInstFamily*>(I)) {
-                            DILocation *loc = ci->debug_loc();
-                            guarantee(loc, "This pass needs full debug info, please compile with -g");
-                            if (Strings::contains(filename, loc->filename())) {
-                                users_offsets[ci] = std::abs(line-loc->line());
-                            }
-                            else {
-                                other_callers.push_back(ci);
-                            }
-                        }
-                    }
-                }
+    Instruction* approximately_match_alloc(string filename, int line) {
+        // level 1: the nearest call to an allocator in the same file
+        std::vector<Function*> allocs;
+        std::vector<string> candidates = {"malloc", "calloc", "realloc"};
+        for (auto c: candidates) {
+            if (Function* alloc = SysDict::module()->get_function(c)) {
+                allocs.push_back(alloc);
             }
+        }
 
-            if (users_offsets.size() == 0) {
-                final = NULL;
-            }
-            else if (users_offsets.size() == 1) {
-                final = users_offsets.begin()->first;
-            }
-            else {
-                int closest = users_offsets.begin()->second;
-                CallInstFamily* closest_I = users_offsets.begin()->first;
-                if (!final) {
-                    for (auto it = users_offsets.begin(); it != users_offsets.end(); ++it) {
-                        if (it->second < closest) {
-                            closest = it->second;
-                            closest_I = it->first;
-                        }
-                    }
-                    final = closest_I;
+        CallInstFamily* final = call_site_index().nearest(filename, line, INT_MAX, [&](CallInstFamily* ci) {
+            for (auto alloc: allocs) {
+                if (alloc->resolved_users().contains(ci)) {
+                    return true;
                 }
             }
-        }
+            return false;
+        });
 
         if (final) {
             zpl("infer alloc: %s", final->called_function()->name_as_c_str())
@@ -244,48 +223,23 @@ public:
             final = users[0];
         }
 
-        // level 1
-        std::map<Instruction*, int> users_offsets;
-        std::vector<Instruction*> other_callers;
+        // level 1: the nearest call to the callee in the same file
         if (!final) {
-            for (auto I: calleef->caller_list()) {
-                if (CallInst* ci = dynamic_cast<CallInst*>(I)) {
-                    DILocation *loc = ci->debug_loc();
-                    guarantee(loc, "This pass needs full debug info, please compile with -g");
-                    if (Strings::contains(filename, loc->filename())) {
-                        users_offsets[I] = std::abs(line-loc->line());
-                    }
-                    else {
-                        other_callers.push_back(I);
-                    }
-                }
-            }
+            final = call_site_index().nearest(filename, line, INT_MAX, [&](CallInstFamily* ci) {
+                return ci->type() == Instruction::CallInstType && calleef->resolved_users().contains(ci);
+            });
+        }
 
-            if (users_offsets.size() == 0) {
-                final = NULL;
-            }
-            else if (users_offsets.size() == 1) {
-                final = users_offsets.begin()->first;
-            }
-            else {
-                int closest = users_offsets.begin()->second;
-                Instruction* closest_I = users_offsets.begin()->first;
-                if (!final) {
-                    for (auto it = users_offsets.begin(); it != users_offsets.end(); ++it) {
-                        if (it->second < closest) {
-                            closest = it->second;
-                            closest_I = it->first;
-                        }
-                    }
-                    final = closest_I;
+        // otherwise the first call in another file
+        if (!final) {
+            for (auto ci: calleef->callers()) {
+                if (ci->type() == Instruction::CallInstType) {
+                    final = ci;
+                    break;
                 }
             }
         }
 
-        if (!final && !other_callers.empty()) {
-            final = other_callers[0];
-        }
-
         if (_caller.empty() && final) {
             _caller = final->owner();
             zpl("infer caller: %s", _caller.c_str())
@@ -476,18 +430,18 @@ public:
 
         string new_args;
         if (add_id) {
-            new_args = "i32 " + std::to_string(_path_counter) + ", " + ci->get_raw_field("args");
+            new_args = "i32 " + std::to_string(_path_counter) + ", " + ci->get_raw_field(RawField::Args);
         }
         else {
-            new_args = ci->get_raw_field("args");
+            new_args = ci->get_raw_field(RawField::Args);
         }
         ci->replace_args(new_args);
 
 
         if (ci->is_varargs()) {
             if (add_id) {
-                string args_sig = ci->get_raw_field("fnty");
-                guarantee(!args_sig.empty(), "problematic line: %s", ci->raw_c_str());
+                string args_sig = ci->get_raw_field(RawField::Fnty);
+                guarantee(!args_sig.empty(), "problematic line: %s", ci->raw_str().c_str());
                 string new_sig = args_sig;
 //            zpl("old sig: %s", args_sig.c_str());
 //            zpl("new sig: %s", new_sig.c_str());
@@ -1,21 +1,34 @@
 //
 // Created by tzhou on 12/20/17.
 //
+#include <atomic>
+#include <sstream>
 #include <passes/pass.h>
 #include <ir/irEssential.h>
+#include <utilities/mutex.h>
 
+/* With ParallelPasses the functions are printed in the order they are done */
 class PrintFunctionPass: public Pass {
-    size_t _inst_cnt;
+    std::atomic<size_t> _inst_cnt;
+    Mutex _print_lock;
 public:
     PrintFunctionPass() {
         set_is_function_pass();
+        set_is_thread_safe();
 
         _inst_cnt = 0;
     }
 
     bool run_on_function(Function* function) override {
-        std::cout << function->name() << ": " << function->instruction_count() << " instructions" << std::endl;
-        _inst_cnt += function->instruction_count();
+        size_t count = function->instruction_count();
+        _inst_cnt += count;
+
+        std::ostringstream line;
+        line << function->name() << ": " << count << " instructions\n";
+        _print_lock.lock();
+        std::cout << line.str() << std::flush;
+        _print_lock.unlock();
+        return false;
     }
 
     void do_finalization(Module* M) override {
@@ -24,4 +37,4 @@ public:
     }
 };
 
-REGISTER_PASS(PrintFunctionPass);
\ No newline at end of file
+REGISTER_PASS(PrintFunctionPass);
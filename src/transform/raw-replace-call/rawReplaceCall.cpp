@@ -50,7 +50,7 @@ public:
                         string targets[4] = {"malloc", "calloc", "realloc", "free"};
                         for (auto& t: targets) {
                             string old = "@"+t+suf;
-                            if (I->raw_text().find(old) != string::npos) {
+                            if (I->raw_view().find(old) != string::npos) {
                                 Strings::ireplace(I->raw_text(), old, "@"+_prefix+t+suf);
                             }
                         }
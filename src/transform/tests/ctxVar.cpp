@@ -2,7 +2,7 @@
 #include <passes/pass.h>
 #include <ir/irEssential.h>
 #include <asmParser/irBuilder.h>
-#include <transform/ben-alloc/benAlloc.cpp>
+#include <passes/analyses.h>
 
 // A module pass template
 
@@ -13,44 +13,23 @@ public:
         set_is_module_pass();
     }
 
+    /* the functions that reach an allocation function through at most nlevel calls */
     void get_target_functions(Module* module, std::set<Function*>& funcs) {
-        BenAllocPass* ben_alloc = new BenAllocPass();
-        for (auto i: ben_alloc->alloc_set()) {
-            get_callers(module, i->old_name, funcs);
-        }
-    }
-
-    void get_callers(Module* module, string& alloc, std::set<Function*>& funcs) {
-        Function* alloc_f = module->get_function(alloc);
-
-        if (!alloc_f) {
-            return;
-        }
-
-        std::set<Function*> old_set;
-        old_set.insert(alloc_f);
-
-        while (nlevel--) {
-            std::set<Function*> new_set;
-            for (auto f: old_set) {
-                for (auto ci: f->caller_list()) {
-                    new_set.insert(ci->function());
+        CallGraph& cg = analyses().get<CallGraph>(module);
+        for (auto alloc_f: analyses().get<MemoryFunctions>(module).allocs()) {
+            std::vector<CallGraph::Node> nodes;
+            cg.callers_within(cg.node(alloc_f), nlevel, nodes);
+            for (auto n: nodes) {
+                if (cg.function(n) != alloc_f) {
+                    funcs.insert(cg.function(n));
                 }
-                if (f != alloc_f)
-                    funcs.insert(f);
             }
-
-            old_set = new_set;
-        }
-
-        for (auto i: old_set) {
-            funcs.insert(i);
         }
     }
 
     void instrument_entry(Function* func) {
         Function* f = module->get_function("f90_ben_ptr_alloc04");
-        for (auto ci: f->caller_list()) {
+        for (auto ci: f->callers()) {
             string nelem = ci->get_nth_arg_by_split(1);
             zps(nelem)
         }
@@ -13,7 +13,7 @@ public:
 
     void print_nelem(Module* module) {
         Function* f = module->get_function("f90_ben_ptr_alloc04");
-        for (auto ci: f->caller_list()) {
+        for (auto ci: f->callers()) {
             string nelem = ci->get_nth_arg_by_split(1);
             zps(nelem)
         }
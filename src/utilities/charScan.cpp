@@ -0,0 +1,223 @@
+#include <cstring>
+#include "charScan.h"
+#include "flags.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CHARSCAN_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+size_t find_first_of_scalar(const char* s, size_t n, const char* delims, size_t ndelims) {
+    for (size_t i = 0; i < n; ++i) {
+        if (memchr(delims, s[i], ndelims)) {
+            return i;
+        }
+    }
+    return n;
+}
+
+inline bool is_ws(char c) {
+    return c == ' ' || c == '\t' || c == '\n';
+}
+
+size_t skip_whitespace_scalar(const char* s, size_t n) {
+    size_t i = 0;
+    while (i < n && is_ws(s[i])) {
+        i++;
+    }
+    return i;
+}
+
+#ifdef CHARSCAN_X86
+
+/* Only whole vectors inside [s, s+n) are loaded, the tail is done by the scalar code */
+
+template <int N>
+size_t find_first_of_sse2_n(const char* s, size_t n, const char* delims) {
+    __m128i d[N];
+    for (int k = 0; k < N; ++k) {
+        d[k] = _mm_set1_epi8(delims[k]);
+    }
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i eq = _mm_cmpeq_epi8(v, d[0]);
+        for (int k = 1; k < N; ++k) {
+            eq = _mm_or_si128(eq, _mm_cmpeq_epi8(v, d[k]));
+        }
+        unsigned mask = (unsigned)_mm_movemask_epi8(eq);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + find_first_of_scalar(s + i, n - i, delims, N);
+}
+
+size_t find_first_of_sse2(const char* s, size_t n, const char* delims, size_t ndelims) {
+    switch (ndelims) {
+        case 2: return find_first_of_sse2_n<2>(s, n, delims);
+        case 3: return find_first_of_sse2_n<3>(s, n, delims);
+        default: return find_first_of_sse2_n<4>(s, n, delims);
+    }
+}
+
+size_t skip_whitespace_sse2(const char* s, size_t n) {
+    const __m128i sp = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i nl = _mm_set1_epi8('\n');
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, sp),
+                                  _mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, nl)));
+        unsigned mask = ~(unsigned)_mm_movemask_epi8(ws) & 0xffffu;
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + skip_whitespace_scalar(s + i, n - i);
+}
+
+template <int N>
+__attribute__((target("avx2")))
+size_t find_first_of_avx2_n(const char* s, size_t n, const char* delims) {
+    __m256i d[N];
+    for (int k = 0; k < N; ++k) {
+        d[k] = _mm256_set1_epi8(delims[k]);
+    }
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i eq = _mm256_cmpeq_epi8(v, d[0]);
+        for (int k = 1; k < N; ++k) {
+            eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(v, d[k]));
+        }
+        unsigned mask = (unsigned)_mm256_movemask_epi8(eq);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + find_first_of_sse2_n<N>(s + i, n - i, delims);
+}
+
+size_t find_first_of_avx2(const char* s, size_t n, const char* delims, size_t ndelims) {
+    switch (ndelims) {
+        case 2: return find_first_of_avx2_n<2>(s, n, delims);
+        case 3: return find_first_of_avx2_n<3>(s, n, delims);
+        default: return find_first_of_avx2_n<4>(s, n, delims);
+    }
+}
+
+__attribute__((target("avx2")))
+size_t skip_whitespace_avx2(const char* s, size_t n) {
+    const __m256i sp = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i nl = _mm256_set1_epi8('\n');
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+        __m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(v, sp),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(v, tab), _mm256_cmpeq_epi8(v, nl)));
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(ws);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + skip_whitespace_sse2(s + i, n - i);
+}
+
+#endif
+
+struct Kernels {
+    CharScan::Level level;
+    size_t (*find_first_of)(const char*, size_t, const char*, size_t);
+    size_t (*skip_whitespace)(const char*, size_t);
+
+    Kernels() {
+        level = CharScan::Scalar;
+        find_first_of = find_first_of_scalar;
+        skip_whitespace = skip_whitespace_scalar;
+#ifdef CHARSCAN_X86
+        if (!UseSIMDScan) {
+            return;
+        }
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            level = CharScan::AVX2;
+            find_first_of = find_first_of_avx2;
+            skip_whitespace = skip_whitespace_avx2;
+        }
+        else if (__builtin_cpu_supports("sse2")) {
+            level = CharScan::SSE2;
+            find_first_of = find_first_of_sse2;
+            skip_whitespace = skip_whitespace_sse2;
+        }
+#endif
+    }
+};
+
+/* Picked on first use, after the command line flags are set */
+const Kernels& kernels() {
+    static Kernels k;
+    return k;
+}
+
+}
+
+size_t CharScan::find_first_of(const char* s, size_t n, const char* delims, size_t ndelims) {
+    if (ndelims == 1) {
+        const char* p = (const char*)memchr(s, delims[0], n);
+        return p ? p - s : n;
+    }
+    if (ndelims == 0 || ndelims > MAX_DELIMS) {
+        return find_first_of_scalar(s, n, delims, ndelims);
+    }
+    return kernels().find_first_of(s, n, delims, ndelims);
+}
+
+size_t CharScan::skip_whitespace(const char* s, size_t n) {
+    /* most calls stop at the first byte, don't pay for the vector setup then */
+    if (n == 0 || !is_ws(s[0])) {
+        return 0;
+    }
+    return kernels().skip_whitespace(s, n);
+}
+
+size_t CharScan::find_scope_end(const char* s, size_t n, char left, char right) {
+    const char marks[3] = { left, right, '"' };
+    int depth = 1;
+    size_t i = 1;
+    while (i < n) {
+        i += find_first_of(s + i, n - i, marks, 3);
+        if (i >= n) {
+            break;
+        }
+
+        char c = s[i];
+        if (c == '"') {
+            const char* q = (const char*)memchr(s + i + 1, '"', n - i - 1);
+            if (!q) {
+                return n;
+            }
+            i = q - s;
+        }
+        else if (c == left) {
+            depth++;
+        }
+        else if (--depth == 0) {
+            return i;
+        }
+        i++;
+    }
+    return n;
+}
+
+CharScan::Level CharScan::level() {
+    return kernels().level;
+}
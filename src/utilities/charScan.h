@@ -0,0 +1,36 @@
+#ifndef LLPARSER_CHARSCAN_H
+#define LLPARSER_CHARSCAN_H
+
+#include <cstddef>
+
+/**@brief Vectorized character scans used by the tokenizer
+ *
+ * Each scan has an SSE2 and an AVX2 kernel and a scalar fallback. The kernel is picked
+ * once, on first use, from what the CPU supports; -XX:-UseSIMDScan forces the scalar
+ * code. All scans look at [s, s+n) only and return a position relative to s, or n if
+ * nothing is found.
+ */
+class CharScan {
+public:
+    enum Level {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    static const int MAX_DELIMS = 4;
+
+    /**@brief Position of the first byte of s that is one of the @param ndelims bytes in delims */
+    static size_t find_first_of(const char* s, size_t n, const char* delims, size_t ndelims);
+    /**@brief Position of the first byte of s that is not ' ', '\\t' or '\\n' */
+    static size_t skip_whitespace(const char* s, size_t n);
+    /**@brief Position of the @param right that closes the @param left at s[0]
+     *
+     * Nested scopes are counted, and brackets between double quotes are ignored.
+     */
+    static size_t find_scope_end(const char* s, size_t n, char left, char right);
+
+    static Level level();
+};
+
+#endif //LLPARSER_CHARSCAN_H
@@ -25,13 +25,51 @@
   develop(bool, ArgParsingVerbose, 0,                                                     \
          "")                                                                              \
   develop(bool, LazyParsing, 1,                                                           \
-         "")                                                                              \
+         "Parse a function body on first access, needs UseMmapInput")                     \
   develop(bool, UseLabelComments, 1,                                                      \
          "")                                                                              \
+  develop(bool, UseMmapInput, 1,                                                          \
+         "Read regular input files through mmap instead of std::ifstream")                \
   develop(bool, ParallelModule, 0,                                                        \
          "Parse all inputs in parallel")                                                  \
+  develop(bool, ParallelFunctionParsing, 0,                                               \
+         "Parse the function bodies and metadata of each input on a pool of threads")     \
+  develop(bool, ParallelResolution, 1,                                                    \
+         "Resolve the calls of large modules on a pool of threads")                       \
+  develop(int, ParsingThreads, 0,                                                         \
+         "Threads used by ParallelFunctionParsing and ParallelResolution, 0 means one "   \
+         "per online CPU")                                                                \
+  develop(bool, ParallelPasses, 0,                                                        \
+         "Run thread-safe function and basic block passes on a pool of threads")          \
+  develop(int, PassThreads, 0,                                                            \
+         "Threads used by ParallelPasses, 0 means one per online CPU")                    \
+  develop(bool, StreamFunctions, 0,                                                       \
+         "Parse, transform and print one function at a time when only function and "      \
+         "basic block passes are loaded and -o is given")                                 \
+  develop(bool, UseSnapshots, 0,                                                          \
+         "Load a parsed input from its snapshot in SnapshotDir if it matches, or write "  \
+         "the snapshot")                                                                  \
+  develop(std::string, SnapshotDir, "",                                                   \
+         "Where UseSnapshots keeps the snapshots, by default $XDG_CACHE_HOME/sopt or "    \
+         "~/.cache/sopt")                                                                 \
+  develop(bool, UseSIMDScan, 1,                                                           \
+         "Use SSE2/AVX2 kernels for character scans in the tokenizer if the CPU has them")\
+  develop(bool, ResolveAfterParse, 1,                                                     \
+         "Resolve the calls and debug info of each input once it is parsed; turn it "     \
+         "off only to time the parser alone")                                             \
+  develop(bool, ReleaseModules, 0,                                                        \
+         "Destroy each module after its passes have run, unless global passes are loaded")\
   develop(bool, UseSplitModule, 0,                                                        \
          "Load sliced sub-modules and merge all inputs into one module.")                 \
+  develop(bool, ProfilePhases, 0,                                                         \
+         "Print the wall time, CPU time and allocated bytes of each parse phase and "     \
+         "pass at exit")                                                                  \
+  develop(bool, ProfileCounters, 0,                                                       \
+         "Count cycles, instructions, cache and branch misses of each profiled phase")    \
+  develop(std::string, ProfileFile, "",                                                   \
+         "Also write the ProfilePhases report to this file as JSON")                      \
+  develop(std::string, TraceFile, "",                                                     \
+         "Write a Chrome trace of the phases each thread ran to this file at exit")       \
   develop(bool, ParallelInstruction, 0,                                                   \
          "")                                                                              \
   develop(bool, PrintParsedLine, 0,                                                       \
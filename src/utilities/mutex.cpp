@@ -5,17 +5,17 @@
 #include "mutex.h"
 
 Mutex* Locks::module_list_lock = NULL;
-Mutex* Locks::thread_table_lock = NULL;
 Mutex* Locks::pass_manager_lock = NULL;
 Mutex* Locks::inst_stack_lock = NULL;
 Mutex* Locks::llparser_done_lock = NULL;
+Mutex* Locks::raw_field_lock = NULL;
 
 void Locks::init() {
     module_list_lock = new Mutex();
-    thread_table_lock = new Mutex();
     pass_manager_lock = new Mutex();
     inst_stack_lock = new Mutex();
     llparser_done_lock = new Mutex();
+    raw_field_lock = new Mutex();
 }
 
 void Locks::destroy() {
@@ -23,10 +23,6 @@ void Locks::destroy() {
         delete module_list_lock;
     }
 
-    if (thread_table_lock) {
-        delete thread_table_lock;
-    }
-
     if (pass_manager_lock) {
         delete pass_manager_lock;
     }
@@ -35,5 +31,9 @@ void Locks::destroy() {
         delete inst_stack_lock;
     }
 
+    if (raw_field_lock) {
+        delete raw_field_lock;
+    }
+
     // todo
 }
\ No newline at end of file
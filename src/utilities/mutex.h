@@ -14,8 +14,8 @@ class Monitor {
     pthread_mutex_t _mutex;
     pthread_cond_t _cond;
 public:
-    Monitor()  { int ret = pthread_mutex_init(&_mutex, NULL); guarantee(ret == 0, "Mutex initialize failed"); }
-    ~Monitor()  { pthread_mutex_destroy(&_mutex); }
+    Monitor()  { int ret = pthread_mutex_init(&_mutex, NULL); guarantee(ret == 0, "Mutex initialize failed"); pthread_cond_init(&_cond, NULL); }
+    ~Monitor()  { pthread_cond_destroy(&_cond); pthread_mutex_destroy(&_mutex); }
     pthread_mutex_t* mutex()  { return &_mutex; }
     pthread_cond_t* cond()  { return &_cond; }
     void lock()  { pthread_mutex_lock(&_mutex); }
@@ -35,6 +35,7 @@ public:
         ~sem_destroy(&_sem);
     }
     void lock() { sem_wait(&_sem); }
+    bool try_lock() { return sem_trywait(&_sem) == 0; }
     void unlock() { sem_post(&_sem); }
 };
 
@@ -45,10 +46,10 @@ public:
     static void destroy();
 
     static Mutex* module_list_lock;
-    static Mutex* thread_table_lock;
     static Mutex* pass_manager_lock;
     static Mutex* inst_stack_lock;
     static Mutex* llparser_done_lock;
+    static Mutex* raw_field_lock;
 };
 
 #endif //LLPARSER_MUTEX_H
@@ -0,0 +1,123 @@
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "perfCounters.h"
+
+thread_local PerfCounters::Group PerfCounters::_group;
+std::atomic<bool> PerfCounters::_warned(false);
+
+static const uint64_t configs[PerfCounters::NumCounters] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+const char* PerfCounters::name(int counter) {
+    static const char* names[NumCounters] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+    return names[counter];
+}
+
+PerfCounters::Group::Group(): state(0), leader(-1), size(0) {
+    for (int i = 0; i < NumCounters; ++i) {
+        fds[i] = -1;
+        slots[i] = -1;
+    }
+}
+
+/* the counters are closed with their thread, each parse thread opens its own */
+PerfCounters::Group::~Group() {
+    for (int i = 0; i < NumCounters; ++i) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+}
+
+static int open_counter(uint64_t config, int group_fd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = group_fd == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    /* the calling thread, on any cpu */
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+bool PerfCounters::open(Group& g) {
+    g.state = -1;
+    g.leader = open_counter(configs[0], -1);
+    if (g.leader < 0) {
+        if (!_warned.exchange(true)) {
+            fprintf(stderr, "WARNING: hardware counters are unavailable (perf_event_open: %s), "
+                            "phases are profiled without them\n", strerror(errno));
+        }
+        return false;
+    }
+
+    g.fds[0] = g.leader;
+    g.slots[0] = 0;
+    g.size = 1;
+    for (int i = 1; i < NumCounters; ++i) {
+        g.fds[i] = open_counter(configs[i], g.leader);
+        g.slots[i] = g.fds[i] < 0 ? -1 : g.size++;
+    }
+
+    ioctl(g.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(g.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    g.state = 1;
+    return true;
+}
+
+/**@brief Whether @param counter is counted on the calling thread */
+bool PerfCounters::is_counted(int counter) {
+    return _group.state == 1 && _group.slots[counter] >= 0;
+}
+
+/**@brief Read the counters of the calling thread into @param values, false if it has none
+ *
+ * A counter that is not open reads as 0, is_counted() tells it from a real 0.
+ */
+bool PerfCounters::read(Values& values) {
+    Group& g = _group;
+    if (g.state == 0) {
+        open(g);
+    }
+    if (g.state != 1) {
+        return false;
+    }
+
+    /* nr, time enabled, time running, then a value per counter of the group */
+    uint64_t buf[3 + NumCounters];
+    ssize_t size = ::read(g.leader, buf, sizeof(buf));
+    if (size < (ssize_t)((3 + g.size) * sizeof(uint64_t))) {
+        return false;
+    }
+
+    values.enabled = buf[1];
+    values.running = buf[2];
+    for (int i = 0; i < NumCounters; ++i) {
+        values.counts[i] = g.slots[i] < 0 ? 0 : buf[3 + g.slots[i]];
+    }
+    return true;
+}
+
+/**@brief The counts from @param begin to @param end, scaled up by how long the group was
+ * scheduled out in between
+ */
+void PerfCounters::difference(const Values& begin, const Values& end, uint64_t* counts) {
+    uint64_t enabled = end.enabled - begin.enabled;
+    uint64_t running = end.running - begin.running;
+    double scale = running && running < enabled ? (double)enabled / running : 1.0;
+    for (int i = 0; i < NumCounters; ++i) {
+        counts[i] = (uint64_t)((end.counts[i] - begin.counts[i]) * scale);
+    }
+}
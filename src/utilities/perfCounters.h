@@ -0,0 +1,52 @@
+#ifndef LLPARSER_PERFCOUNTERS_H
+#define LLPARSER_PERFCOUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+
+/**@brief Hardware counters of the calling thread, read with perf_event_open
+ *
+ * Each thread opens its own counter group the first time it reads it. A counter the
+ * kernel or the machine doesn't provide is left out; if none can be opened, read()
+ * returns false and the caller goes on without counters. When the kernel multiplexes
+ * the group, differences of two reads are scaled by the time it was counting.
+ */
+class PerfCounters {
+public:
+    enum Counter {
+        Cycles,
+        Instructions,
+        CacheMisses,
+        BranchMisses,
+        NumCounters
+    };
+
+    struct Values {
+        uint64_t counts[NumCounters];
+        uint64_t enabled;
+        uint64_t running;
+    };
+private:
+    struct Group {
+        int state;                  // 0: not opened yet, 1: open, -1: unavailable
+        int leader;
+        int fds[NumCounters];
+        int slots[NumCounters];     // position in the group read, or -1 if not open
+        int size;
+
+        Group();
+        ~Group();
+    };
+
+    static thread_local Group _group;
+    static std::atomic<bool> _warned;
+
+    static bool open(Group& g);
+public:
+    static const char* name(int counter);
+    static bool read(Values& values);
+    static bool is_counted(int counter);
+    static void difference(const Values& begin, const Values& end, uint64_t* counts);
+};
+
+#endif //LLPARSER_PERFCOUNTERS_H
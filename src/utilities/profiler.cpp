@@ -0,0 +1,227 @@
+#include <cstdlib>
+#include <ctime>
+#include <new>
+#include <algorithm>
+#include "profiler.h"
+#include "strings.h"
+#include "perfCounters.h"
+
+std::vector<Profiler::Phase> Profiler::_phases;
+std::map<std::string, int> Profiler::_index;
+Mutex Profiler::_lock;
+bool Profiler::_counting = false;
+thread_local uint64_t Profiler::_allocated = 0;
+thread_local uint64_t Profiler::_allocations = 0;
+
+/* Count what each thread allocates, for the allocated bytes of the phases
+ *
+ * This replaces the allocator of the whole process. Unless counting is on, the only cost
+ * over malloc is the test of Profiler::_counting.
+ */
+void* operator new(size_t size) {
+    Profiler::count_allocation(size);
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+/**@brief The id of the phase called @param name, which is added if it is new */
+int Profiler::phase(const std::string& name) {
+    _lock.lock();
+    auto it = _index.find(name);
+    int id;
+    if (it != _index.end()) {
+        id = it->second;
+    }
+    else {
+        id = (int)_phases.size();
+        _phases.push_back(Phase{name, 0, 0, 0, 0, {0}, {0}});
+        _index[name] = id;
+    }
+    _lock.unlock();
+    return id;
+}
+
+/**@brief Add a run of @param phase, with the hardware @param counts of the run if they
+ * were read. Bit i of @param counted is set if counter i was.
+ */
+void Profiler::record(int phase, double wall, double cpu, uint64_t bytes, const uint64_t* counts,
+                      unsigned counted) {
+    _lock.lock();
+    Phase& p = _phases[phase];
+    p.calls++;
+    p.wall += wall;
+    p.cpu += cpu;
+    p.bytes += bytes;
+    if (counts) {
+        for (int i = 0; i < PerfCounters::NumCounters; ++i) {
+            if (counted & (1u << i)) {
+                p.counted[i]++;
+                p.counts[i] += counts[i];
+            }
+        }
+    }
+    _lock.unlock();
+}
+
+static double seconds_of(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**@brief The time on the clock of the Tracer, so its events and the phases agree */
+double Profiler::wall_seconds() {
+    return Tracer::now();
+}
+
+/**@brief The CPU time of the calling thread */
+double Profiler::cpu_seconds() {
+    return seconds_of(CLOCK_THREAD_CPUTIME_ID);
+}
+
+/**@brief Whether any hardware counter was read for @param p */
+bool Profiler::is_counted(const Phase& p) {
+    for (int i = 0; i < PerfCounters::NumCounters; ++i) {
+        if (p.counted[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* @param counter of @param p into @param buf, or n/a if it was never read */
+void Profiler::format_count(char* buf, size_t size, const Phase& p, int counter) {
+    if (p.counted[counter]) {
+        snprintf(buf, size, "%llu", (unsigned long long)p.counts[counter]);
+    }
+    else {
+        snprintf(buf, size, "n/a");
+    }
+}
+
+/* @param num per @param per of @param den of @param p into @param buf as @param format,
+ * or n/a if either was never read
+ */
+void Profiler::format_ratio(char* buf, size_t size, const char* format, const Phase& p, int num, int den,
+                            double per) {
+    if (p.counted[num] && p.counted[den]) {
+        double d = p.counts[den] / per;
+        snprintf(buf, size, format, d ? p.counts[num] / d : 0.0);
+    }
+    else {
+        snprintf(buf, size, "n/a");
+    }
+}
+
+void Profiler::report(FILE* fp) {
+    _lock.lock();
+    fprintf(fp, "=================== Phase Profile ===================\n");
+    fprintf(fp, "%10s %10s %14s %8s  %s\n", "wall (s)", "cpu (s)", "allocated (B)", "calls", "phase");
+    for (auto& p: _phases) {
+        fprintf(fp, "%10.3f %10.3f %14llu %8llu  %s\n", p.wall, p.cpu,
+                (unsigned long long)p.bytes, (unsigned long long)p.calls, p.name.c_str());
+    }
+
+    bool counted = false;
+    for (auto& p: _phases) {
+        counted |= is_counted(p);
+    }
+    if (counted) {
+        /* misses are per thousand instructions, columns that couldn't be read are n/a */
+        fprintf(fp, "-----------------------------------------------------\n");
+        fprintf(fp, "%16s %16s %6s %10s %10s  %s\n", "cycles", "instructions", "IPC",
+                "cache MPKI", "branch MPKI", "phase");
+        for (auto& p: _phases) {
+            if (!is_counted(p)) {
+                continue;
+            }
+            char cycles[24], insts[24], ipc[16], cache[16], branch[16];
+            format_count(cycles, sizeof(cycles), p, PerfCounters::Cycles);
+            format_count(insts, sizeof(insts), p, PerfCounters::Instructions);
+            format_ratio(ipc, sizeof(ipc), "%.2f", p, PerfCounters::Instructions, PerfCounters::Cycles, 1);
+            format_ratio(cache, sizeof(cache), "%.3f", p, PerfCounters::CacheMisses, PerfCounters::Instructions, 1000);
+            format_ratio(branch, sizeof(branch), "%.3f", p, PerfCounters::BranchMisses, PerfCounters::Instructions, 1000);
+            fprintf(fp, "%16s %16s %6s %10s %10s  %s\n", cycles, insts, ipc, cache, branch, p.name.c_str());
+        }
+    }
+    fprintf(fp, "=====================================================\n");
+    _lock.unlock();
+}
+
+/**@brief Write the phases to @param file as {"phases": [{"name": ..., ...}, ...]} */
+bool Profiler::write_json(const std::string& file) {
+    FILE* fp = fopen(file.c_str(), "w");
+    if (!fp) {
+        return false;
+    }
+
+    _lock.lock();
+    fprintf(fp, "{\"phases\": [");
+    for (size_t i = 0; i < _phases.size(); ++i) {
+        Phase& p = _phases[i];
+        fprintf(fp, "%s\n  {\"name\": %s, \"calls\": %llu, \"wall_seconds\": %.6f, "
+                    "\"cpu_seconds\": %.6f, \"allocated_bytes\": %llu",
+                i ? "," : "", Strings::json_quote(p.name).c_str(), (unsigned long long)p.calls,
+                p.wall, p.cpu, (unsigned long long)p.bytes);
+        if (is_counted(p)) {
+            for (int c = 0; c < PerfCounters::NumCounters; ++c) {
+                if (p.counted[c]) {
+                    fprintf(fp, ", \"%s\": %llu", PerfCounters::name(c), (unsigned long long)p.counts[c]);
+                }
+                else {
+                    fprintf(fp, ", \"%s\": null", PerfCounters::name(c));
+                }
+            }
+        }
+        fprintf(fp, "}");
+    }
+    fprintf(fp, "\n]}\n");
+    _lock.unlock();
+
+    return fclose(fp) == 0;
+}
+
+void ScopedPhase::begin(const std::string& name) {
+    if (ProfilePhases) {
+        _phase = Profiler::phase(name);
+        _bytes = Profiler::allocated();
+        _cpu = Profiler::cpu_seconds();
+        /* last, so that the counters see as little of the profiler as possible */
+        _counting = ProfileCounters && PerfCounters::read(_counters);
+    }
+    _traced = Tracer::is_on();
+    if (_traced) {
+        _name = name;
+    }
+    _wall = Profiler::wall_seconds();
+}
+
+void ScopedPhase::end() {
+    PerfCounters::Values counters;
+    bool counted = _counting && PerfCounters::read(counters);
+    double now = Profiler::wall_seconds();
+    if (_phase >= 0) {
+        double cpu = Profiler::cpu_seconds() - _cpu;
+        uint64_t counts[PerfCounters::NumCounters];
+        unsigned mask = 0;
+        if (counted) {
+            PerfCounters::difference(_counters, counters, counts);
+            for (int i = 0; i < PerfCounters::NumCounters; ++i) {
+                if (PerfCounters::is_counted(i)) {
+                    mask |= 1u << i;
+                }
+            }
+        }
+        Profiler::record(_phase, now - _wall, cpu, Profiler::allocated() - _bytes, counted ? counts : NULL, mask);
+    }
+    if (_traced) {
+        Tracer::complete(_name, _detail, _wall, now);
+    }
+}
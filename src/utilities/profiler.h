@@ -0,0 +1,116 @@
+#ifndef LLPARSER_PROFILER_H
+#define LLPARSER_PROFILER_H
+
+#include <cstdio>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "flags.h"
+#include "mutex.h"
+#include "tracer.h"
+#include "perfCounters.h"
+
+/**@brief Wall time, CPU time and allocated bytes of the named phases of a run
+ *
+ * Phases are recorded by ScopedPhase. Each phase is reported as the sum over all the
+ * times it ran, on any thread, including the phases nested in it. CPU time is the
+ * time of the thread that ran the phase, allocated bytes are what that thread got
+ * from operator new and from TextArena while the phase ran. With ProfileCounters, the
+ * hardware counters of that thread are summed as well, each over the runs that could read
+ * it. A counter no run could read is reported as n/a, or null in the json.
+ */
+class Profiler {
+public:
+    struct Phase {
+        std::string name;
+        uint64_t calls;
+        double wall;
+        double cpu;
+        uint64_t bytes;
+        uint64_t counted[PerfCounters::NumCounters];  // runs in which each counter was read
+        uint64_t counts[PerfCounters::NumCounters];
+    };
+private:
+    static std::vector<Phase> _phases;  // in the order they first ran
+    static std::map<std::string, int> _index;
+    static Mutex _lock;
+    static bool _counting;
+    static thread_local uint64_t _allocated;
+    static thread_local uint64_t _allocations;
+
+    static bool is_counted(const Phase& p);
+    static void format_count(char* buf, size_t size, const Phase& p, int counter);
+    static void format_ratio(char* buf, size_t size, const char* format, const Phase& p, int num, int den,
+                             double per);
+public:
+    static int phase(const std::string& name);
+    static void record(int phase, double wall, double cpu, uint64_t bytes, const uint64_t* counts,
+                       unsigned counted);
+
+    /// Allocations are only counted after set_counting(true), main() turns it on with ProfilePhases
+    static void set_counting(bool on)                       { _counting = on; }
+    static void count_allocation(size_t size) {
+        if (_counting) {
+            _allocated += size;
+            _allocations++;
+        }
+    }
+    static uint64_t allocated()                             { return _allocated; }
+    static uint64_t allocations()                           { return _allocations; }
+    static double wall_seconds();
+    static double cpu_seconds();
+
+    static void report(FILE* fp);
+    static bool write_json(const std::string& file);
+};
+
+/**@brief Records the time and allocations from its construction to its destruction as
+ * a phase of the Profiler if ProfilePhases is on, and as an event of the Tracer if it
+ * is on
+ *
+ * Otherwise it costs two flag tests, so it can wrap each run of a pass on a block.
+ * @param detail, e.g. the module or function the phase ran on, only goes to the trace
+ * and must live until the end of the scope.
+ */
+class ScopedPhase {
+    int _phase;
+    bool _traced;
+    double _wall;
+    double _cpu;
+    uint64_t _bytes;
+    bool _counting;
+    PerfCounters::Values _counters;
+    std::string _name;
+    const char* _detail;
+
+    static bool is_on()                                     { return ProfilePhases || Tracer::is_on(); }
+    void begin(const std::string& name);
+    void end();
+public:
+    explicit ScopedPhase(const char* name, const char* detail=NULL):
+        _phase(-1), _traced(false), _counting(false), _detail(detail) {
+        if (is_on()) {
+            begin(name);
+        }
+    }
+
+    /// The phase "owner::what", e.g. a method of a pass; the name is only built if recording
+    ScopedPhase(const std::string& owner, const char* what, const char* detail=NULL):
+        _phase(-1), _traced(false), _counting(false), _detail(detail) {
+        if (is_on()) {
+            begin(owner + "::" + what);
+        }
+    }
+
+    ~ScopedPhase() {
+        if (_phase >= 0 || _traced) {
+            end();
+        }
+    }
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+};
+
+#endif //LLPARSER_PROFILER_H
@@ -0,0 +1,60 @@
+#ifndef LLPARSER_STRINGREF_H
+#define LLPARSER_STRINGREF_H
+
+#include <cstring>
+#include <ostream>
+#include "macros.h"
+
+/**@brief A non-owning view of a run of characters.
+ *
+ * The referenced bytes are not necessarily NUL-terminated, e.g. when the view
+ * points into a mapped input file. Whoever hands out a StringRef is responsible
+ * for keeping the bytes alive, which in practice means a TextArena.
+ */
+class StringRef {
+    const char* _data;
+    size_t _size;
+public:
+    StringRef(): _data(NULL), _size(0) {}
+    StringRef(const char* data, size_t size): _data(data), _size(size) {}
+    explicit StringRef(const string& s): _data(s.data()), _size(s.size()) {}
+
+    const char* data() const                              { return _data; }
+    size_t size() const                                   { return _size; }
+    bool empty() const                                    { return _size == 0; }
+    bool is_null() const                                  { return _data == NULL; }
+    char operator[](size_t i) const                       { return _data[i]; }
+    const char* begin() const                             { return _data; }
+    const char* end() const                               { return _data + _size; }
+
+    string str() const                                    { return _data ? string(_data, _size) : string(); }
+    void print_to(FILE* fp) const                         { fwrite(_data, 1, _size, fp); }
+
+    size_t find(const char* s, size_t pos=0) const        { return find(s, strlen(s), pos); }
+
+    size_t find(const char* s, size_t n, size_t pos) const {
+        if (pos > _size || n > _size - pos) {
+            return string::npos;
+        }
+        for (size_t i = pos; i + n <= _size; ++i) {
+            if (memcmp(_data + i, s, n) == 0) {
+                return i;
+            }
+        }
+        return string::npos;
+    }
+
+    size_t find(const string& s, size_t pos=0) const      { return find(s.data(), s.size(), pos); }
+    size_t find(StringRef s, size_t pos=0) const          { return find(s.data(), s.size(), pos); }
+    bool contains(const char* s) const                    { return find(s) != string::npos; }
+
+    bool equals(const char* s, size_t n) const            { return n == _size && (n == 0 || memcmp(_data, s, n) == 0); }
+    bool operator==(const StringRef& o) const             { return equals(o._data, o._size); }
+    bool operator!=(const StringRef& o) const             { return !(*this == o); }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const StringRef& s) {
+    return os.write(s.data(), s.size());
+}
+
+#endif //LLPARSER_STRINGREF_H
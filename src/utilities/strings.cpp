@@ -2,6 +2,7 @@
 // Created by GentlyGuitar on 6/6/2017.
 //
 
+#include <cstdio>
 #include <sstream>
 #include "strings.h"
 
@@ -148,3 +149,23 @@ char* Strings::strip(char *str, const char *chars) {
 
     return str+beg;
 }
+
+/**@brief @param s as a JSON string literal, quotes included */
+std::string Strings::json_quote(const std::string& s) {
+    std::string out = "\"";
+    for (char c: s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        }
+        else if ((unsigned char)c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        }
+        else {
+            out += c;
+        }
+    }
+    return out + '"';
+}
@@ -32,6 +32,7 @@ public:
     static std::string replace(const std::string& s, const char* oldsub, const char* newsub);
     static char* strip(char* str, const char* chars=" \t\n");
     static bool strip(std::string& str, const char* chars=" \t\n");
+    static std::string json_quote(const std::string& s);
 };
 
 
@@ -2,52 +2,124 @@
 // Created by GentlyGuitar on 6/6/2017.
 //
 
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
 #include "symbol.h"
+#include "stringRef.h"
+#include "mutex.h"
+#include "macros.h"
 
 
+namespace {
 
-Symbol::Symbol() {
+struct RefHash {
+    size_t operator()(const StringRef& s) const {
+        /* FNV-1a */
+        uint64_t h = 14695981039346656037ull;
+        for (size_t i = 0; i < s.size(); ++i) {
+            h = (h ^ (unsigned char)s[i]) * 1099511628211ull;
+        }
+        return (size_t)h;
+    }
+};
 
-}
+/**@brief The interned strings, and an index from string to id
+ *
+ * The index is split into shards, each with its own lock, so that threads parsing
+ * different modules rarely wait on each other. The strings are kept in fixed-size
+ * chunks that are never moved, so reading the string of a Symbol takes no lock.
+ */
+class SymbolTable {
+    static const int SHARD_BITS = 6;
+    static const int SHARDS = 1 << SHARD_BITS;
+    static const int CHUNK_BITS = 16;
+    static const size_t CHUNK_SIZE = (size_t)1 << CHUNK_BITS;
+    static const size_t MAX_CHUNKS = 4096;
 
-Symbol::Symbol(std::string s) {
-    _str = s;
-}
+    struct Shard {
+        Mutex lock;
+        std::unordered_map<StringRef, uint32_t, RefHash> index;
+    };
 
-Symbol::Symbol(const char * name) {
-    _str = name;
-}
+    Shard _shards[SHARDS];
+    std::atomic<const std::string**> _chunks[MAX_CHUNKS];
+    Mutex _alloc_lock;
+    std::atomic<uint32_t> _count;
 
-Symbol& Symbol::operator=(std::string s) {
-    _str = s;
-}
+    uint32_t add(const char* s, size_t n) {
+        _alloc_lock.lock();
+        uint32_t id = _count.load(std::memory_order_relaxed);
+        size_t c = id >> CHUNK_BITS;
+        guarantee(c < MAX_CHUNKS, "symbol table is full");
+        const std::string** chunk = _chunks[c].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new const std::string*[CHUNK_SIZE];
+            _chunks[c].store(chunk, std::memory_order_release);
+        }
+        chunk[id & (CHUNK_SIZE-1)] = new std::string(s, n);
+        _count.store(id + 1, std::memory_order_release);
+        _alloc_lock.unlock();
+        return id;
+    }
+public:
+    SymbolTable(): _count(0) {
+        for (size_t i = 0; i < MAX_CHUNKS; ++i) {
+            _chunks[i].store(NULL, std::memory_order_relaxed);
+        }
+        uint32_t empty = add("", 0);
+        guarantee(empty == 0, " ");
+    }
 
-Symbol& Symbol::operator=(const char *s) {
-    _str = s;
-}
+    uint32_t intern(const char* s, size_t n, bool insert) {
+        if (n == 0) {
+            return 0;
+        }
+
+        StringRef key(s, n);
+        size_t h = RefHash()(key);
+        Shard& shard = _shards[h >> (sizeof(size_t)*8 - SHARD_BITS)];
+        shard.lock.lock();
+        auto it = shard.index.find(key);
+        uint32_t id = 0;
+        if (it != shard.index.end()) {
+            id = it->second;
+        }
+        else if (insert) {
+            id = add(s, n);
+            shard.index[StringRef(str(id))] = id;
+        }
+        shard.lock.unlock();
+        return id;
+    }
+
+    const std::string& str(uint32_t id) const {
+        const std::string** chunk = _chunks[id >> CHUNK_BITS].load(std::memory_order_acquire);
+        return *chunk[id & (CHUNK_SIZE-1)];
+    }
+
+    size_t count() const                                    { return _count.load(std::memory_order_acquire); }
+};
 
-Symbol& Symbol::prepend(std::string pre) {
-    _str = pre + _str;
-    return *this;
+SymbolTable& table() {
+    static SymbolTable* t = new SymbolTable();  // never destroyed, Symbols may outlive static destruction
+    return *t;
 }
 
-Symbol& Symbol::operator+(std::string s) {
-    return append(s);
 }
 
-Symbol& Symbol::append(std::string ap) {
-    _str += ap;
-    return *this;
+Symbol::Symbol(const char* s) {
+    _id = s ? intern(s, strlen(s), true) : 0;
 }
 
-Symbol& operator+(std::string str, Symbol & symbol) {
-    return symbol.prepend(str);
+uint32_t Symbol::intern(const char* s, size_t n, bool insert) {
+    return table().intern(s, n, insert);
 }
 
-const char* Symbol::c_str() {
-    return _str.c_str();
+const std::string& Symbol::str() const {
+    return table().str(_id);
 }
 
-std::string Symbol::str() {
-    return _str;
+size_t Symbol::count() {
+    return table().count();
 }
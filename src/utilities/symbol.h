@@ -5,31 +5,55 @@
 #ifndef LLPARSER_SYMBOL_H
 #define LLPARSER_SYMBOL_H
 
+#include <cstdint>
+#include <functional>
 #include <string>
-#include <sstream>
-#include <vector>
-#include "strings.h"
-
 
 
+/**@brief An interned string
+ *
+ * Every distinct string is stored once in a process-wide table and a Symbol is just
+ * its index in that table, so copying and comparing Symbols is O(1) no matter how long
+ * the string is. The table is shared by all modules and threads and never shrinks;
+ * the string a Symbol refers to stays valid for the rest of the run.
+ *
+ * The empty Symbol (id 0) is the empty string.
+ */
 class Symbol {
 private:
-    std::string _str;
+    uint32_t _id;
+
+    explicit Symbol(uint32_t id): _id(id) {}
+    static uint32_t intern(const char* s, size_t n, bool insert);
+
+    template <typename T> friend class SymbolMap;
 public:
-    Symbol();
-    Symbol(std::string);
-    Symbol(const char*);
-    Symbol& operator=(std::string s);
-    Symbol& operator=(const char* s);
-
-    std::string str();
-    const char* c_str();
-
-    Symbol& prepend(std::string);
-    Symbol& append(std::string);
-    Symbol& operator+(std::string);
-    friend Symbol& operator+(std::string, Symbol&);
+    Symbol(): _id(0) {}
+    Symbol(const std::string& s): _id(intern(s.data(), s.size(), true)) {}
+    Symbol(const char* s);
+    Symbol(const char* s, size_t n): _id(intern(s, n, true)) {}
+
+    uint32_t id() const                                     { return _id; }
+    bool empty() const                                      { return _id == 0; }
+    const std::string& str() const;
+    const char* c_str() const                               { return str().c_str(); }
+
+    /* order by id, not alphabetically */
+    bool operator==(const Symbol& o) const                  { return _id == o._id; }
+    bool operator!=(const Symbol& o) const                  { return _id != o._id; }
+    bool operator<(const Symbol& o) const                   { return _id < o._id; }
+
+    /// The Symbol of @param s if it has been interned, the empty Symbol otherwise
+    static Symbol find(const std::string& s)                { return Symbol(intern(s.data(), s.size(), false)); }
+    /// Number of distinct strings interned so far
+    static size_t count();
+};
+
+namespace std {
+template<> struct hash<Symbol> {
+    size_t operator()(const Symbol& s) const                { return s.id(); }
 };
+}
 
 
 #endif //LLPARSER_SYMBOL_H
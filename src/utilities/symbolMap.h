@@ -0,0 +1,188 @@
+#ifndef LLPARSER_SYMBOLMAP_H
+#define LLPARSER_SYMBOLMAP_H
+
+#include <vector>
+#include "macros.h"
+#include "symbol.h"
+
+/**@brief An open-addressing hash map from Symbol to @param T
+ *
+ * Slots are probed linearly from a Fibonacci hash of the symbol id, and the table
+ * is kept at most half full, so a lookup is usually one or two slot reads and never
+ * compares strings. Lookups by string go through Symbol::find(), which does not
+ * intern: a string that was never interned can't be a key.
+ *
+ * The iteration order is unspecified.
+ */
+template <typename T>
+class SymbolMap {
+    static const uint32_t EMPTY = 0;            // the empty symbol is never a key
+    static const uint32_t DELETED = UINT32_MAX;
+
+    struct Slot {
+        uint32_t key;
+        T value;
+    };
+
+    std::vector<Slot> _slots;
+    size_t _size;
+    size_t _used;  // live and deleted slots
+    int _shift;
+
+    size_t home(uint32_t key) const {
+        return (size_t)((key * 0x9E3779B97F4A7C15ull) >> _shift);
+    }
+
+    /// The slot of @param key, or the empty slot where it would go
+    size_t probe(uint32_t key) const {
+        size_t mask = _slots.size() - 1;
+        size_t i = home(key);
+        size_t first_deleted = _slots.size();
+        while (_slots[i].key != EMPTY) {
+            if (_slots[i].key == key) {
+                return i;
+            }
+            if (_slots[i].key == DELETED && first_deleted == _slots.size()) {
+                first_deleted = i;
+            }
+            i = (i + 1) & mask;
+        }
+        return first_deleted != _slots.size() ? first_deleted : i;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old;
+        old.swap(_slots);
+        _slots.assign(capacity, Slot{EMPTY, T()});
+        _shift = 64;
+        for (size_t c = capacity; c > 1; c >>= 1) {
+            _shift--;
+        }
+        _size = 0;
+        _used = 0;
+        for (auto& s: old) {
+            if (s.key != EMPTY && s.key != DELETED) {
+                insert_new(s.key, s.value);
+            }
+        }
+    }
+
+    void insert_new(uint32_t key, const T& value) {
+        size_t i = probe(key);
+        if (_slots[i].key == EMPTY) {
+            _used++;
+        }
+        _slots[i].key = key;
+        _slots[i].value = value;
+        _size++;
+    }
+
+    void grow_for(size_t n) {
+        if ((_used + n) * 2 > _slots.size()) {
+            size_t capacity = 16;
+            while (capacity < (_size + n) * 2) {
+                capacity <<= 1;
+            }
+            rehash(capacity);
+        }
+    }
+public:
+    class const_iterator {
+        const SymbolMap* _map;
+        size_t _i;
+
+        void skip() {
+            while (_i < _map->_slots.size() && (_map->_slots[_i].key == EMPTY || _map->_slots[_i].key == DELETED)) {
+                _i++;
+            }
+        }
+    public:
+        const_iterator(const SymbolMap* map, size_t i): _map(map), _i(i)    { skip(); }
+        Symbol key() const                                  { return Symbol(_map->_slots[_i].key); }
+        const T& value() const                              { return _map->_slots[_i].value; }
+        const_iterator& operator++()                        { _i++; skip(); return *this; }
+        bool operator!=(const const_iterator& o) const      { return _i != o._i; }
+        const const_iterator& operator*() const             { return *this; }
+    };
+
+    SymbolMap(): _size(0), _used(0), _shift(64) {}
+
+    size_t size() const                                     { return _size; }
+    bool empty() const                                      { return _size == 0; }
+    const_iterator begin() const                            { return const_iterator(this, 0); }
+    const_iterator end() const                              { return const_iterator(this, _slots.size()); }
+
+    const T* find(Symbol key) const {
+        if (key.empty() || _size == 0) {
+            return NULL;
+        }
+        const Slot& s = _slots[probe(key.id())];
+        return s.key == key.id() ? &s.value : NULL;
+    }
+
+    const T* find(const std::string& key) const             { return _size ? find(Symbol::find(key)) : NULL; }
+    bool contains(Symbol key) const                         { return find(key) != NULL; }
+    bool contains(const std::string& key) const             { return find(key) != NULL; }
+
+    /// The value of @param key, or T() if there is none
+    T get(Symbol key) const                                 { const T* v = find(key); return v ? *v : T(); }
+    T get(const std::string& key) const                     { const T* v = find(key); return v ? *v : T(); }
+
+    /// Add @param key if it is not in the map yet, returns whether it was added
+    bool insert(Symbol key, const T& value) {
+        guarantee(!key.empty(), "SymbolMap: the empty symbol can't be a key");
+        if (contains(key)) {
+            return false;
+        }
+        grow_for(1);
+        insert_new(key.id(), value);
+        return true;
+    }
+
+    /// Add or replace
+    void set(Symbol key, const T& value) {
+        guarantee(!key.empty(), "SymbolMap: the empty symbol can't be a key");
+        if (_size > 0) {
+            Slot& s = _slots[probe(key.id())];
+            if (s.key == key.id()) {
+                s.value = value;
+                return;
+            }
+        }
+        grow_for(1);
+        insert_new(key.id(), value);
+    }
+
+    bool erase(Symbol key) {
+        if (key.empty() || _size == 0) {
+            return false;
+        }
+        Slot& s = _slots[probe(key.id())];
+        if (s.key != key.id()) {
+            return false;
+        }
+        s.key = DELETED;
+        s.value = T();
+        _size--;
+        return true;
+    }
+
+    /// Add all entries of @param other whose keys are not in this map yet
+    void merge(const SymbolMap& other) {
+        grow_for(other.size());
+        for (auto& s: other._slots) {
+            if (s.key != EMPTY && s.key != DELETED && _slots[probe(s.key)].key != s.key) {
+                insert_new(s.key, s.value);
+            }
+        }
+    }
+
+    void clear() {
+        _slots.clear();
+        _size = 0;
+        _used = 0;
+        _shift = 64;
+    }
+};
+
+#endif //LLPARSER_SYMBOLMAP_H
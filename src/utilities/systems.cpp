@@ -6,6 +6,10 @@
 #include <fstream>
 #include <array>
 #include <memory>
+#include <atomic>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "systems.h"
 
 
@@ -24,4 +28,35 @@ std::string Systems::exec(std::string cmd) {
       result += buffer.data();
   }
   return result;
-}
\ No newline at end of file
+}
+/**@brief Where to write the output meant for @param file
+ *
+ * A regular file is not written in place: the parser may still be reading the input
+ * through a mapping, and the input may be @param file itself. The output goes to a
+ * temporary file next to it, which commit_output() renames over @param file. The
+ * mapping keeps the old file alive. Devices and fifos are written directly.
+ */
+std::string Systems::output_path_for(const std::string& file) {
+  static std::atomic<unsigned> count(0);
+  struct stat st;
+  if (stat(file.c_str(), &st) == 0 && !S_ISREG(st.st_mode)) {
+    return file;
+  }
+  return file + ".tmp" + std::to_string(getpid()) + "." + std::to_string(count++);
+}
+
+/**@brief Put the complete output at @param path in place of @param file
+ *
+ * @param path is what output_path_for(@param file) returned. Returns false, and removes
+ * @param path, if it can't be renamed.
+ */
+bool Systems::commit_output(const std::string& path, const std::string& file) {
+  if (path == file) {
+    return true;
+  }
+  if (rename(path.c_str(), file.c_str()) != 0) {
+    unlink(path.c_str());
+    return false;
+  }
+  return true;
+}
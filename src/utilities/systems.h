@@ -11,6 +11,8 @@ class Systems {
 public:
   static bool is_file_exist(std::string filename);
   static std::string exec(std::string cmd);
+  static std::string output_path_for(const std::string& file);
+  static bool commit_output(const std::string& path, const std::string& file);
 };
 
 #endif //LLPARSER_SYSTEM_H
@@ -0,0 +1,168 @@
+#include <cstdint>
+#include <cstdlib>
+#include <peripheral/mappedFile.h>
+#include "mutex.h"
+#include "profiler.h"
+#include "textArena.h"
+
+thread_local TextArena* TextArena::_current = NULL;
+thread_local TextArena* TextArena::_objects = NULL;
+
+TextArena::TextArena(bool locked) {
+    _cur = NULL;
+    _left = 0;
+    _bytes = 0;
+    _lock = locked ? new Mutex() : NULL;
+}
+
+TextArena::~TextArena() {
+    for (auto c: _chunks) {
+        free(c);
+    }
+    for (auto f: _files) {
+        delete f;
+    }
+    delete _lock;
+
+    if (_current == this) {
+        _current = NULL;
+    }
+    if (_objects == this) {
+        _objects = NULL;
+    }
+}
+
+char* TextArena::allocate(size_t size) {
+    /* big strings get a chunk of their own so that the current chunk isn't wasted */
+    if (size > CHUNK_SIZE / 4) {
+        char* p = (char*)malloc(size);
+        guarantee(p, "TextArena: out of memory");
+        Profiler::count_allocation(size);
+        _chunks.push_back(p);
+        return p;
+    }
+
+    if (size > _left) {
+        _cur = (char*)malloc(CHUNK_SIZE);
+        guarantee(_cur, "TextArena: out of memory");
+        Profiler::count_allocation(CHUNK_SIZE);
+        _left = CHUNK_SIZE;
+        _chunks.push_back(_cur);
+    }
+
+    char* p = _cur;
+    _cur += size;
+    _left -= size;
+    return p;
+}
+
+/**@brief Copy @param n bytes from @param s into the arena
+ *
+ * The copy is NUL-terminated, but the terminator is not part of the returned StringRef.
+ */
+StringRef TextArena::copy(const char* s, size_t n) {
+    if (n == 0) {
+        return StringRef("", 0);
+    }
+
+    if (_lock) {
+        _lock->lock();
+    }
+
+    char* p = allocate(n + 1);
+    memcpy(p, s, n);
+    p[n] = '\0';
+    _bytes += n + 1;
+
+    if (_lock) {
+        _lock->unlock();
+    }
+    return StringRef(p, n);
+}
+
+/**@brief Allocate @param size bytes for an object, aligned for any type
+ *
+ * The memory is only released with the arena.
+ */
+void* TextArena::allocate_object(size_t size) {
+    if (_lock) {
+        _lock->lock();
+    }
+
+    size_t pad = (OBJECT_ALIGNMENT - (uintptr_t)_cur % OBJECT_ALIGNMENT) % OBJECT_ALIGNMENT;
+    if (pad + size <= _left) {
+        _cur += pad;
+        _left -= pad;
+    }
+    else {
+        /* the aligned object doesn't fit, a new chunk is taken, which malloc() aligns */
+        _left = 0;
+    }
+    void* p = allocate(size);
+    _bytes += size;
+
+    if (_lock) {
+        _lock->unlock();
+    }
+    return p;
+}
+
+/**@brief Take the ownership of a mapped file
+ *
+ * StringRefs that point into the mapping stay valid for the lifetime of the arena.
+ */
+void TextArena::adopt_file(MappedFile* file) {
+    _files.push_back(file);
+}
+
+/**@brief Move all storage of @param other into this arena
+ *
+ * Used when modules are merged, StringRefs handed out by @param other
+ * stay valid after @param other is destroyed.
+ */
+void TextArena::adopt(TextArena* other) {
+    if (other == this) {
+        return;
+    }
+
+    _chunks.insert(_chunks.end(), other->_chunks.begin(), other->_chunks.end());
+    _files.insert(_files.end(), other->_files.begin(), other->_files.end());
+    _bytes += other->_bytes;
+
+    other->_chunks.clear();
+    other->_files.clear();
+    other->_cur = NULL;
+    other->_left = 0;
+    other->_bytes = 0;
+}
+
+/**@brief Free all copied text and objects, StringRefs handed out by copy() become invalid
+ *
+ * The adopted files are kept.
+ */
+void TextArena::reset() {
+    for (auto c: _chunks) {
+        free(c);
+    }
+    _chunks.clear();
+    _cur = NULL;
+    _left = 0;
+    _bytes = 0;
+}
+
+/**@brief The arena that raw text created on this thread goes to
+ *
+ * This is the arena of the module that the thread is parsing, or the shared arena
+ * if the thread hasn't started parsing any module.
+ */
+TextArena* TextArena::current() {
+    if (_current) {
+        return _current;
+    }
+    return shared();
+}
+
+TextArena* TextArena::shared() {
+    static TextArena* arena = new TextArena(true);
+    return arena;
+}
@@ -0,0 +1,79 @@
+#ifndef LLPARSER_TEXTARENA_H
+#define LLPARSER_TEXTARENA_H
+
+#include <vector>
+#include "stringRef.h"
+
+class MappedFile;
+class Mutex;
+
+/**@brief Bump-pointer storage for the raw text of a module.
+ *
+ * Raw text and raw field values of every Shadow in a module are stored here as
+ * StringRefs instead of as individual heap strings. Strings are packed into
+ * large chunks and released all at once with the arena. The arena can also own
+ * the mapping of the input file, so that raw text can refer to the mapped lines
+ * directly without being copied at all.
+ *
+ * The IR objects of the module (every Shadow, see Shadow::operator new) are
+ * allocated here too. Deleting an object runs its destructor but leaves its
+ * memory to the arena, which gives it back when the module is destroyed.
+ *
+ * A module's arena is only written by the thread that parses the module. Text
+ * created on threads that have no current arena goes to the shared arena, which
+ * is locked.
+ */
+class TextArena {
+    std::vector<char*> _chunks;
+    char* _cur;
+    size_t _left;
+    size_t _bytes;
+    std::vector<MappedFile*> _files;
+    Mutex* _lock;
+
+    static const size_t CHUNK_SIZE = 64 * 1024;
+    static const size_t OBJECT_ALIGNMENT = 16;
+    static thread_local TextArena* _current;
+    static thread_local TextArena* _objects;
+
+    char* allocate(size_t size);
+public:
+    TextArena(bool locked=false);
+    TextArena(const TextArena&) = delete;
+    TextArena& operator=(const TextArena&) = delete;
+    ~TextArena();
+
+    StringRef copy(const char* s, size_t n);
+    StringRef copy(const string& s)                         { return copy(s.data(), s.size()); }
+    void* allocate_object(size_t size);
+
+    void adopt_file(MappedFile* file);
+    void adopt(TextArena* other);
+    void reset();
+
+    /// Number of bytes handed out, not counting the mapped files
+    size_t bytes() const                                    { return _bytes; }
+    size_t chunk_count() const                              { return _chunks.size(); }
+
+    static TextArena* current();
+    static void set_current(TextArena* arena)               { _current = arena; }
+    static TextArena* shared();
+
+    /// The arena the parser places IR objects in on this thread, or NULL, see Shadow::operator new
+    static TextArena* objects()                             { return _objects; }
+
+    /**@brief Places the IR objects created on this thread in an arena chosen by the parser
+     *
+     * In the scope of a NULL arena, objects go to the arena of their module again.
+     */
+    class ObjectScope {
+        TextArena* _previous;
+    public:
+        explicit ObjectScope(TextArena* arena): _previous(_objects) { _objects = arena; }
+        ObjectScope(const ObjectScope&) = delete;
+        ObjectScope& operator=(const ObjectScope&) = delete;
+        ~ObjectScope()                                      { _objects = _previous; }
+    };
+};
+
+#endif //LLPARSER_TEXTARENA_H
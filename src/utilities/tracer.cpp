@@ -0,0 +1,106 @@
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "tracer.h"
+#include "strings.h"
+
+std::atomic<bool> Tracer::_on(false);
+double Tracer::_start = 0;
+std::string Tracer::_file;
+Mutex Tracer::_lock;
+std::vector<Tracer::Buffer*> Tracer::_buffers;
+thread_local Tracer::Buffer* Tracer::_buffer = NULL;
+
+static void dump_at_exit() {
+    Tracer::dump();
+}
+
+/**@brief Record from now on, and write the trace to @param file when the process exits */
+void Tracer::start(const std::string& file) {
+    _file = file;
+    _start = now();
+    _on = true;
+    set_thread_name("main");
+    atexit(dump_at_exit);
+}
+
+double Tracer::now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+Tracer::Buffer* Tracer::buffer() {
+    if (!_buffer) {
+        _buffer = new Buffer();
+        _buffer->tid = syscall(SYS_gettid);
+        _lock.lock();
+        _buffers.push_back(_buffer);
+        _lock.unlock();
+    }
+    return _buffer;
+}
+
+void Tracer::set_thread_name(const std::string& name) {
+    if (_on) {
+        buffer()->thread_name = name;
+    }
+}
+
+/**@brief Record that the calling thread ran @param name from @param begin to @param end,
+ * as given by now()
+ */
+void Tracer::complete(const std::string& name, const char* detail, double begin, double end) {
+    buffer()->events.push_back(Event{name, detail ? detail : "", begin, end});
+}
+
+void Tracer::lock_and_record_wait(Mutex* m, const char* name) {
+    if (m->try_lock()) {
+        return;
+    }
+    double begin = now();
+    m->lock();
+    complete(std::string("wait ") + name, NULL, begin, now());
+}
+
+/**@brief Write what all the threads recorded so far, once */
+void Tracer::dump() {
+    if (!_on.exchange(false)) {
+        return;
+    }
+
+    FILE* fp = fopen(_file.c_str(), "w");
+    if (!fp) {
+        fprintf(stderr, "cannot write the trace to %s\n", _file.c_str());
+        return;
+    }
+
+    long pid = getpid();
+    bool first = true;
+    fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    _lock.lock();
+    for (auto b: _buffers) {
+        if (!b->thread_name.empty()) {
+            fprintf(fp, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %ld, \"tid\": %ld, "
+                        "\"args\": {\"name\": %s}}",
+                    first ? "" : ",", pid, b->tid, Strings::json_quote(b->thread_name).c_str());
+            first = false;
+        }
+        for (auto& e: b->events) {
+            fprintf(fp, "%s\n{\"name\": %s, \"cat\": \"sopt\", \"ph\": \"X\", \"pid\": %ld, \"tid\": %ld, "
+                        "\"ts\": %.3f, \"dur\": %.3f",
+                    first ? "" : ",", Strings::json_quote(e.name).c_str(), pid, b->tid,
+                    (e.begin - _start) * 1e6, (e.end - e.begin) * 1e6);
+            if (!e.detail.empty()) {
+                fprintf(fp, ", \"args\": {\"detail\": %s}", Strings::json_quote(e.detail).c_str());
+            }
+            fprintf(fp, "}");
+            first = false;
+        }
+    }
+    _lock.unlock();
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+}
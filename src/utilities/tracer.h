@@ -0,0 +1,60 @@
+#ifndef LLPARSER_TRACER_H
+#define LLPARSER_TRACER_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "mutex.h"
+
+/**@brief A timeline of the phases each thread ran, written as Chrome trace JSON at exit
+ *
+ * Each thread appends the phases it finishes to a buffer of its own, so recording takes
+ * no lock. The buffers are kept after their threads exit and are written when the
+ * process exits, as complete ("X") events that chrome://tracing and Perfetto can load.
+ * Waits for the locks passed to Tracer::lock() show up as "wait <lock>" events.
+ */
+class Tracer {
+    struct Event {
+        std::string name;
+        std::string detail;
+        double begin;
+        double end;
+    };
+
+    struct Buffer {
+        long tid;
+        std::string thread_name;
+        std::vector<Event> events;
+    };
+
+    static std::atomic<bool> _on;  // cleared by dump() while other threads may still test it
+    static double _start;
+    static std::string _file;
+    static Mutex _lock;
+    static std::vector<Buffer*> _buffers;
+    static thread_local Buffer* _buffer;
+
+    static Buffer* buffer();
+    static void lock_and_record_wait(Mutex* m, const char* name);
+public:
+    static void start(const std::string& file);
+    static bool is_on()                                      { return _on; }
+    static double now();
+
+    static void set_thread_name(const std::string& name);
+    static void complete(const std::string& name, const char* detail, double begin, double end);
+
+    /// Lock @param m, recording the wait if it is held by another thread
+    static void lock(Mutex* m, const char* name) {
+        if (_on) {
+            lock_and_record_wait(m, name);
+        }
+        else {
+            m->lock();
+        }
+    }
+
+    static void dump();
+};
+
+#endif //LLPARSER_TRACER_H
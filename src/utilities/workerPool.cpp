@@ -0,0 +1,157 @@
+#include <unistd.h>
+#include <atomic>
+#include <algorithm>
+#include "workerPool.h"
+#include "tracer.h"
+
+/**@brief Start @param nthreads threads, or one per online CPU if @param nthreads is not positive
+ *
+ */
+WorkerPool::WorkerPool(int nthreads) {
+    _running = 0;
+    _stopping = false;
+    pthread_cond_init(&_idle, NULL);
+
+    if (nthreads <= 0) {
+        nthreads = online_cpus();
+    }
+    _threads.resize(nthreads);
+    for (int i = 0; i < nthreads; ++i) {
+        int ret = pthread_create(&_threads[i], NULL, thread_main, this);
+        guarantee(ret == 0, "WorkerPool: failed to create thread %d", i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    _monitor.lock();
+    _stopping = true;
+    _monitor.signal_all();
+    _monitor.unlock();
+
+    for (auto t: _threads) {
+        pthread_join(t, NULL);
+    }
+    pthread_cond_destroy(&_idle);
+}
+
+void WorkerPool::submit(const Task& task) {
+    _monitor.lock();
+    _tasks.push_back(task);
+    _monitor.signal();
+    _monitor.unlock();
+}
+
+void WorkerPool::wait() {
+    _monitor.lock();
+    while (!_tasks.empty() || _running > 0) {
+        pthread_cond_wait(&_idle, _monitor.mutex());
+    }
+    _monitor.unlock();
+}
+
+/**@brief Run @param body on every index in [0, @param n) on the pool and the calling
+ * thread, and return when all of them are done
+ *
+ * The indices are split into one range per thread. A thread takes indices from the
+ * front of its own range and, once that is empty, steals from the ranges of the
+ * others, so a few expensive indices don't leave the rest of the threads idle.
+ * @param enter and @param leave, if set, run on each pool thread around its share
+ * of the work, but not on the calling thread. Calling this from a task of the same
+ * pool can deadlock.
+ */
+void WorkerPool::parallel_for(size_t n, const std::function<void(size_t)>& body,
+                              const Task& enter, const Task& leave) {
+    struct Range {
+        std::atomic<size_t> next;
+        size_t end;
+    };
+
+    size_t nranges = std::min(n, (size_t)size() + 1);
+    if (nranges <= 1) {
+        for (size_t i = 0; i < n; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    std::vector<Range> ranges(nranges);
+    for (size_t r = 0; r < nranges; ++r) {
+        ranges[r].next = n * r / nranges;
+        ranges[r].end = n * (r+1) / nranges;
+    }
+
+    auto run = [&](size_t self) {
+        for (size_t k = 0; k < nranges; ++k) {
+            Range& r = ranges[(self + k) % nranges];
+            for (size_t i = r.next++; i < r.end; i = r.next++) {
+                body(i);
+            }
+        }
+    };
+
+    Monitor done;
+    size_t helping = nranges - 1;
+    for (size_t r = 1; r < nranges; ++r) {
+        submit([&, r] {
+            if (enter) {
+                enter();
+            }
+            run(r);
+            if (leave) {
+                leave();
+            }
+
+            done.lock();
+            if (--helping == 0) {
+                done.signal();
+            }
+            done.unlock();
+        });
+    }
+
+    run(0);
+
+    /* the helpers use the ranges on this stack until they are finished */
+    done.lock();
+    while (helping > 0) {
+        done.wait();
+    }
+    done.unlock();
+}
+
+void* WorkerPool::thread_main(void* pool) {
+    Tracer::set_thread_name("worker");
+    ((WorkerPool*)pool)->work();
+    return NULL;
+}
+
+void WorkerPool::work() {
+    _monitor.lock();
+    while (true) {
+        while (_tasks.empty() && !_stopping) {
+            _monitor.wait();
+        }
+        if (_tasks.empty()) {
+            break;
+        }
+
+        Task task = _tasks.front();
+        _tasks.pop_front();
+        _running++;
+        _monitor.unlock();
+
+        task();
+
+        _monitor.lock();
+        _running--;
+        if (_tasks.empty() && _running == 0) {
+            pthread_cond_broadcast(&_idle);
+        }
+    }
+    _monitor.unlock();
+}
+
+int WorkerPool::online_cpus() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
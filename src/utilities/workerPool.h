@@ -0,0 +1,41 @@
+#ifndef LLPARSER_WORKERPOOL_H
+#define LLPARSER_WORKERPOOL_H
+
+#include <deque>
+#include <functional>
+#include "mutex.h"
+
+/**@brief A fixed set of threads that run submitted tasks in FIFO order.
+ *
+ * Tasks must not throw. wait() blocks until every task submitted so far
+ * has finished; the threads are joined when the pool is destroyed.
+ * parallel_for() only waits for its own work, so several threads can use
+ * one pool at the same time.
+ */
+class WorkerPool {
+public:
+    typedef std::function<void()> Task;
+private:
+    std::vector<pthread_t> _threads;
+    std::deque<Task> _tasks;
+    Monitor _monitor;
+    pthread_cond_t _idle;
+    int _running;
+    bool _stopping;
+
+    static void* thread_main(void* pool);
+    void work();
+public:
+    WorkerPool(int nthreads=0);
+    ~WorkerPool();
+
+    int size() const                                        { return (int)_threads.size(); }
+    void submit(const Task& task);
+    void wait();
+    void parallel_for(size_t n, const std::function<void(size_t)>& body,
+                      const Task& enter=Task(), const Task& leave=Task());
+
+    static int online_cpus();
+};
+
+#endif //LLPARSER_WORKERPOOL_H
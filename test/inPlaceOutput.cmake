@@ -0,0 +1,25 @@
+# Writes a module back to the file it was parsed from, which the parser maps.
+# The result must be what the same run writes to another file, in each parse mode.
+#   cmake -DSOPT=<sopt> -DPASS=<libAtrace.so> -DINPUT=<.ll> -DWORK=<dir> -P inPlaceOutput.cmake
+
+file(MAKE_DIRECTORY ${WORK})
+configure_file(${INPUT} ${WORK}/reference.ll COPYONLY)
+execute_process(COMMAND ${SOPT} -load ${PASS} ${WORK}/reference.ll -o ${WORK}/expected.ll
+                RESULT_VARIABLE rc OUTPUT_QUIET ERROR_QUIET)
+if (NOT rc EQUAL 0)
+    message(FATAL_ERROR "sopt failed on ${WORK}/reference.ll: ${rc}")
+endif()
+
+foreach(mode "-XX:+LazyParsing" "-XX:-LazyParsing" "-XX:+StreamFunctions")
+    configure_file(${INPUT} ${WORK}/in_place.ll COPYONLY)
+    execute_process(COMMAND ${SOPT} ${mode} -load ${PASS} ${WORK}/in_place.ll -o ${WORK}/in_place.ll
+                    RESULT_VARIABLE rc OUTPUT_QUIET ERROR_QUIET)
+    if (NOT rc EQUAL 0)
+        message(FATAL_ERROR "sopt ${mode} failed writing to its input: ${rc}")
+    endif()
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORK}/expected.ll ${WORK}/in_place.ll
+                    RESULT_VARIABLE rc)
+    if (NOT rc EQUAL 0)
+        message(FATAL_ERROR "sopt ${mode} wrote a different module to its input")
+    endif()
+endforeach()